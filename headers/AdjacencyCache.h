@@ -0,0 +1,116 @@
+#ifndef ADJACENCYCACHE_H
+#define ADJACENCYCACHE_H
+
+#include "SlotBitset.h"
+
+#include <vector>
+
+namespace SimplexMesh {
+
+   //A derived adjacency relation (eg. vertex-to-tet) in compressed sparse row form, built in one pass and then kept
+   //up to date row by row. Edits mark the rows they affect stale; a stale row is regathered the next time it is read
+   //and stored in an overflow area, and once too much of the relation has gone stale the owner rebuilds it all.
+   //Rows that were added after the last rebuild count as stale.
+   class AdjacencyCache {
+   public:
+      AdjacencyCache() : m_built(false), m_staleRows(0) {}
+
+      bool built() const { return m_built; }
+
+      //Replace the contents, eg. after a full rebuild: row r is entries[rowStart[r] .. rowStart[r+1]).
+      void assign(std::vector<unsigned int>& rowStart, std::vector<int>& entries) {
+         clear();
+         m_rowStart.swap(rowStart);
+         m_entries.swap(entries);
+         m_stale.resize(rows());
+         m_built = true;
+      }
+
+      //Drop everything (and the memory); the next reader rebuilds.
+      void clear() {
+         std::vector<unsigned int>().swap(m_rowStart);
+         std::vector<int>().swap(m_entries);
+         SlotBitset().swap(m_stale);
+         std::vector<Span>().swap(m_patches);
+         std::vector<int>().swap(m_patchOf);
+         std::vector<int>().swap(m_patchEntries);
+         m_staleRows = 0;
+         m_built = false;
+      }
+
+      void markStale(unsigned int row) {
+         if(!m_built)
+            return;
+         if(row < rows() && !m_stale.test(row)) {
+            m_stale.set(row);
+            ++m_staleRows;
+         }
+         if(row < m_patchOf.size())
+            m_patchOf[row] = -1;
+      }
+
+      bool isStale(unsigned int row) const {
+         bool patched = row < m_patchOf.size() && m_patchOf[row] >= 0;
+         return !patched && (row >= rows() || m_stale.test(row));
+      }
+
+      //Worth a rebuild rather than patching: over an eighth of the rows stale, or overflow entries past a quarter of the base.
+      bool needsRebuild(unsigned int slots) const {
+         unsigned int newRows = slots > rows() ? slots - rows() : 0;
+         return !m_built || 8*(size_t)(m_staleRows + newRows) > slots || 4*m_patchEntries.size() > m_entries.size() + 64;
+      }
+
+      //Store the regathered contents of a stale row.
+      void patch(unsigned int row, const int* entries, unsigned int count) {
+         if(row >= m_patchOf.size())
+            m_patchOf.resize(row+1, -1);
+         m_patchOf[row] = (int)m_patches.size();
+         m_patches.push_back(Span((unsigned int)m_patchEntries.size(), count));
+         m_patchEntries.insert(m_patchEntries.end(), entries, entries + count);
+      }
+
+      //The entries of a row that isn't stale.
+      const int* row(unsigned int r, unsigned int& count) const {
+         if(r < m_patchOf.size() && m_patchOf[r] >= 0) {
+            const Span& span = m_patches[m_patchOf[r]];
+            count = span.count;
+            return count > 0 ? &m_patchEntries[span.first] : 0;
+         }
+         count = m_rowStart[r+1] - m_rowStart[r];
+         return count > 0 ? &m_entries[m_rowStart[r]] : 0;
+      }
+
+      size_t memoryUsed() const {
+         return m_rowStart.size()*sizeof(unsigned int) + m_entries.size()*sizeof(int) + m_stale.memoryUsed() +
+                m_patches.size()*sizeof(Span) + m_patchOf.size()*sizeof(int) + m_patchEntries.size()*sizeof(int);
+      }
+      size_t memoryUsage() const {
+         return m_rowStart.capacity()*sizeof(unsigned int) + m_entries.capacity()*sizeof(int) + m_stale.memoryUsage() +
+                m_patches.capacity()*sizeof(Span) + m_patchOf.capacity()*sizeof(int) + m_patchEntries.capacity()*sizeof(int);
+      }
+
+   private:
+      struct Span {
+         unsigned int first, count;
+         Span(unsigned int f, unsigned int c) : first(f), count(c) {}
+      };
+
+      unsigned int rows() const { return m_rowStart.empty() ? 0 : (unsigned int)m_rowStart.size() - 1; }
+
+      bool m_built;
+
+      //the relation as of the last rebuild
+      std::vector<unsigned int> m_rowStart;
+      std::vector<int> m_entries;
+      SlotBitset m_stale;
+      unsigned int m_staleRows;
+
+      //rows regathered since, by row (-1 if none)
+      std::vector<Span> m_patches;
+      std::vector<int> m_patchOf;
+      std::vector<int> m_patchEntries;
+   };
+
+} // namespace SimplexMesh
+
+#endif // ADJACENCYCACHE_H
@@ -0,0 +1,272 @@
+#ifndef COMPACTCOMPLEX_H
+#define COMPACTCOMPLEX_H
+
+#include "SimplicialComplex.h"
+#include "SimplexHandles.h"
+#include "SmallIndexList.h"
+
+#include <vector>
+
+namespace SimplexMesh {
+
+   //An immutable, read-only snapshot of a SimplicialComplex, for traversal-heavy phases between edits.
+   //
+   //All six incidence relations are packed into classic compressed sparse row arrays (row pointers, columns, signs),
+   //containing live simplices only, densely renumbered from 0. The mapping between dense indices and the
+   //handles of the original complex is O(1) in both directions, and the iterators hand back original handles,
+   //so existing properties can be used directly. The snapshot is not updated by edits to the complex;
+   //call build() (or SimplicialComplex::freeze) again afterwards, which reuses the existing buffers.
+   class CompactComplex
+   {
+   public:
+
+      CompactComplex();
+      explicit CompactComplex(const SimplicialComplex& obj);
+
+      //(Re)build the snapshot from the current state of the given complex.
+      void build(const SimplicialComplex& obj);
+
+      int numVerts() const { return (int)m_vertHandles.size(); }
+      int numEdges() const { return (int)m_edgeHandles.size(); }
+      int numFaces() const { return (int)m_faceHandles.size(); }
+      int numTets() const { return (int)m_tetHandles.size(); }
+
+      //Dense index -> handle in the original complex
+      VertexHandle vertexHandle(int index) const { return VertexHandle(m_vertHandles[index]); }
+      EdgeHandle edgeHandle(int index) const { return EdgeHandle(m_edgeHandles[index]); }
+      FaceHandle faceHandle(int index) const { return FaceHandle(m_faceHandles[index]); }
+      TetHandle tetHandle(int index) const { return TetHandle(m_tetHandles[index]); }
+
+      //Handle in the original complex -> dense index (-1 if the simplex was not live when the snapshot was built)
+      int vertexIndex(const VertexHandle& vh) const { return lookup(m_vertIndices, vh.idx()); }
+      int edgeIndex(const EdgeHandle& eh) const { return lookup(m_edgeIndices, eh.idx()); }
+      int faceIndex(const FaceHandle& fh) const { return lookup(m_faceIndices, fh.idx()); }
+      int tetIndex(const TetHandle& th) const { return lookup(m_tetIndices, th.idx()); }
+
+      //Iterators, following the same advance()/done()/current() protocol as those in SimplexIterators.h.
+      //Each also offers index(), the dense index of the current simplex, and the adjacency iterators
+      //can be started from a dense index, so chains of queries can skip the handle mapping entirely.
+      //////////////////////////////////////////////////////////////////////////
+
+      class VertexIterator {
+      public:
+         VertexIterator(const CompactComplex& obj) : m_obj(obj), m_idx(0) {}
+         void advance() { ++m_idx; }
+         bool done() const { return m_idx >= m_obj.numVerts(); }
+         VertexHandle current() const { return done() ? VertexHandle::invalid() : m_obj.vertexHandle(m_idx); }
+         int index() const { return m_idx; }
+      private:
+         const CompactComplex& m_obj;
+         int m_idx;
+      };
+
+      class EdgeIterator {
+      public:
+         EdgeIterator(const CompactComplex& obj) : m_obj(obj), m_idx(0) {}
+         void advance() { ++m_idx; }
+         bool done() const { return m_idx >= m_obj.numEdges(); }
+         EdgeHandle current() const { return done() ? EdgeHandle::invalid() : m_obj.edgeHandle(m_idx); }
+         int index() const { return m_idx; }
+      private:
+         const CompactComplex& m_obj;
+         int m_idx;
+      };
+
+      class FaceIterator {
+      public:
+         FaceIterator(const CompactComplex& obj) : m_obj(obj), m_idx(0) {}
+         void advance() { ++m_idx; }
+         bool done() const { return m_idx >= m_obj.numFaces(); }
+         FaceHandle current() const { return done() ? FaceHandle::invalid() : m_obj.faceHandle(m_idx); }
+         int index() const { return m_idx; }
+      private:
+         const CompactComplex& m_obj;
+         int m_idx;
+      };
+
+      class TetIterator {
+      public:
+         TetIterator(const CompactComplex& obj) : m_obj(obj), m_idx(0) {}
+         void advance() { ++m_idx; }
+         bool done() const { return m_idx >= m_obj.numTets(); }
+         TetHandle current() const { return done() ? TetHandle::invalid() : m_obj.tetHandle(m_idx); }
+         int index() const { return m_idx; }
+      private:
+         const CompactComplex& m_obj;
+         int m_idx;
+      };
+
+   private:
+
+      //One packed relation: row i occupies [rowPtr[i], rowPtr[i+1]) of col/sign.
+      struct Relation {
+         std::vector<int> rowPtr;
+         std::vector<int> col;
+         std::vector<signed char> sign;
+      };
+
+      //Walks a single row of a packed relation; the adjacency iterators below just add the handle type.
+      class RowIterator {
+      public:
+         void advance() { ++m_pos; }
+         bool done() const { return m_pos >= m_end; }
+         int index() const { return done() ? -1 : m_rel->col[m_pos]; }
+         int orientation() const { return done() ? 0 : m_rel->sign[m_pos]; }
+      protected:
+         RowIterator(const CompactComplex& obj, const Relation& rel, int row) : m_obj(obj), m_rel(&rel),
+            m_pos(row < 0 ? 0 : rel.rowPtr[row]), m_end(row < 0 ? 0 : rel.rowPtr[row+1]) {}
+         const CompactComplex& m_obj;
+         const Relation* m_rel;
+         int m_pos, m_end;
+      };
+
+      //Walks the dense indices gathered from several rows (see the gather functions below), in increasing order.
+      class GatheredIterator {
+      public:
+         void advance() { ++m_pos; }
+         bool done() const { return m_pos >= m_list.size(); }
+         int index() const { return done() ? -1 : m_list[m_pos]; }
+      protected:
+         GatheredIterator(const CompactComplex& obj) : m_obj(obj), m_pos(0) {}
+         const CompactComplex& m_obj;
+         SmallIndexList m_list;
+         unsigned int m_pos;
+      };
+
+   public:
+
+      class VertexEdgeIterator : public RowIterator {
+      public:
+         VertexEdgeIterator(const CompactComplex& obj, const VertexHandle& vh) : RowIterator(obj, obj.m_VE, obj.vertexIndex(vh)) {}
+         VertexEdgeIterator(const CompactComplex& obj, int vertIndex) : RowIterator(obj, obj.m_VE, vertIndex) {}
+         EdgeHandle current() const { return done() ? EdgeHandle::invalid() : m_obj.edgeHandle(index()); }
+      };
+
+      class EdgeVertexIterator : public RowIterator {
+      public:
+         //rows are stored in (from, to) order, so the ordered flag is accepted only for interface compatibility
+         EdgeVertexIterator(const CompactComplex& obj, const EdgeHandle& eh, bool /*ordered*/ = false) : RowIterator(obj, obj.m_EV, obj.edgeIndex(eh)) {}
+         EdgeVertexIterator(const CompactComplex& obj, int edgeIndex) : RowIterator(obj, obj.m_EV, edgeIndex) {}
+         VertexHandle current() const { return done() ? VertexHandle::invalid() : m_obj.vertexHandle(index()); }
+      };
+
+      class VertexVertexIterator : public RowIterator {
+      public:
+         VertexVertexIterator(const CompactComplex& obj, const VertexHandle& vh) : RowIterator(obj, obj.m_VE, obj.vertexIndex(vh)), m_vert(obj.vertexIndex(vh)) {}
+         VertexVertexIterator(const CompactComplex& obj, int vertIndex) : RowIterator(obj, obj.m_VE, vertIndex), m_vert(vertIndex) {}
+         VertexHandle current() const { return done() ? VertexHandle::invalid() : m_obj.vertexHandle(vertexIndex()); }
+         int vertexIndex() const { //dense index of the neighbouring vertex
+            const int* ev = &m_obj.m_EV.col[m_obj.m_EV.rowPtr[index()]];
+            return ev[0] == m_vert ? ev[1] : ev[0];
+         }
+      private:
+         int m_vert;
+      };
+
+      class EdgeFaceIterator : public RowIterator {
+      public:
+         EdgeFaceIterator(const CompactComplex& obj, const EdgeHandle& eh) : RowIterator(obj, obj.m_EF, obj.edgeIndex(eh)) {}
+         EdgeFaceIterator(const CompactComplex& obj, int edgeIndex) : RowIterator(obj, obj.m_EF, edgeIndex) {}
+         FaceHandle current() const { return done() ? FaceHandle::invalid() : m_obj.faceHandle(index()); }
+      };
+
+      class FaceEdgeIterator : public RowIterator {
+      public:
+         //rows are stored in cyclic order, so the ordered flag is accepted only for interface compatibility
+         FaceEdgeIterator(const CompactComplex& obj, const FaceHandle& fh, bool /*ordered*/ = false) : RowIterator(obj, obj.m_FE, obj.faceIndex(fh)) {}
+         FaceEdgeIterator(const CompactComplex& obj, int faceIndex) : RowIterator(obj, obj.m_FE, faceIndex) {}
+         EdgeHandle current() const { return done() ? EdgeHandle::invalid() : m_obj.edgeHandle(index()); }
+      };
+
+      class FaceTetIterator : public RowIterator {
+      public:
+         FaceTetIterator(const CompactComplex& obj, const FaceHandle& fh) : RowIterator(obj, obj.m_FT, obj.faceIndex(fh)) {}
+         FaceTetIterator(const CompactComplex& obj, int faceIndex) : RowIterator(obj, obj.m_FT, faceIndex) {}
+         TetHandle current() const { return done() ? TetHandle::invalid() : m_obj.tetHandle(index()); }
+      };
+
+      class TetFaceIterator : public RowIterator {
+      public:
+         TetFaceIterator(const CompactComplex& obj, const TetHandle& th) : RowIterator(obj, obj.m_TF, obj.tetIndex(th)) {}
+         TetFaceIterator(const CompactComplex& obj, int tetIndex) : RowIterator(obj, obj.m_TF, tetIndex) {}
+         FaceHandle current() const { return done() ? FaceHandle::invalid() : m_obj.faceHandle(index()); }
+      };
+
+      //Vertices of a face, in the face's orientation order.
+      class FaceVertexIterator : public RowIterator {
+      public:
+         FaceVertexIterator(const CompactComplex& obj, const FaceHandle& fh, bool /*ordered*/ = false) : RowIterator(obj, obj.m_FE, obj.faceIndex(fh)) {}
+         FaceVertexIterator(const CompactComplex& obj, int faceIndex) : RowIterator(obj, obj.m_FE, faceIndex) {}
+         VertexHandle current() const { return done() ? VertexHandle::invalid() : m_obj.vertexHandle(vertexIndex()); }
+         int vertexIndex() const { //tail of the current edge, as seen by the face
+            int ev = m_obj.m_EV.rowPtr[index()];
+            return m_obj.m_EV.col[orientation() > 0 ? ev : ev+1];
+         }
+      };
+
+      //The relations spanning two or more levels, gathered from the packed rows.
+
+      class VertexFaceIterator : public GatheredIterator {
+      public:
+         VertexFaceIterator(const CompactComplex& obj, const VertexHandle& vh) : GatheredIterator(obj) { obj.gatherVertexFaces(obj.vertexIndex(vh), m_list); }
+         VertexFaceIterator(const CompactComplex& obj, int vertIndex) : GatheredIterator(obj) { obj.gatherVertexFaces(vertIndex, m_list); }
+         FaceHandle current() const { return done() ? FaceHandle::invalid() : m_obj.faceHandle(index()); }
+      };
+
+      class VertexTetIterator : public GatheredIterator {
+      public:
+         VertexTetIterator(const CompactComplex& obj, const VertexHandle& vh) : GatheredIterator(obj) { obj.gatherVertexTets(obj.vertexIndex(vh), m_list); }
+         VertexTetIterator(const CompactComplex& obj, int vertIndex) : GatheredIterator(obj) { obj.gatherVertexTets(vertIndex, m_list); }
+         TetHandle current() const { return done() ? TetHandle::invalid() : m_obj.tetHandle(index()); }
+      };
+
+      class EdgeTetIterator : public GatheredIterator {
+      public:
+         EdgeTetIterator(const CompactComplex& obj, const EdgeHandle& eh) : GatheredIterator(obj) { obj.gatherEdgeTets(obj.edgeIndex(eh), m_list); }
+         EdgeTetIterator(const CompactComplex& obj, int edgeIndex) : GatheredIterator(obj) { obj.gatherEdgeTets(edgeIndex, m_list); }
+         TetHandle current() const { return done() ? TetHandle::invalid() : m_obj.tetHandle(index()); }
+      };
+
+      class TetVertexIterator : public GatheredIterator {
+      public:
+         TetVertexIterator(const CompactComplex& obj, const TetHandle& th) : GatheredIterator(obj) { obj.gatherTetVerts(obj.tetIndex(th), m_list); }
+         TetVertexIterator(const CompactComplex& obj, int tetIndex) : GatheredIterator(obj) { obj.gatherTetVerts(tetIndex, m_list); }
+         VertexHandle current() const { return done() ? VertexHandle::invalid() : m_obj.vertexHandle(index()); }
+      };
+
+      class TetEdgeIterator : public GatheredIterator {
+      public:
+         TetEdgeIterator(const CompactComplex& obj, const TetHandle& th) : GatheredIterator(obj) { obj.gatherTetEdges(obj.tetIndex(th), m_list); }
+         TetEdgeIterator(const CompactComplex& obj, int tetIndex) : GatheredIterator(obj) { obj.gatherTetEdges(tetIndex, m_list); }
+         EdgeHandle current() const { return done() ? EdgeHandle::invalid() : m_obj.edgeHandle(index()); }
+      };
+
+   private:
+
+      //Append the columns of row (if valid) of a packed relation; and the sorted, unique dense indices
+      //of the simplices around a vertex, edge or tet, for the gathered iterators.
+      static void appendRow(const Relation& rel, int row, SmallIndexList& out);
+      void gatherVertexFaces(int vert, SmallIndexList& out) const;
+      void gatherVertexTets(int vert, SmallIndexList& out) const;
+      void gatherEdgeTets(int edge, SmallIndexList& out) const;
+      void gatherTetVerts(int tet, SmallIndexList& out) const;
+      void gatherTetEdges(int tet, SmallIndexList& out) const;
+
+      static int lookup(const std::vector<int>& indices, int slot) {
+         return (slot >= 0 && slot < (int)indices.size()) ? indices[slot] : -1;
+      }
+
+      //Dense index -> slot in the original complex
+      std::vector<int> m_vertHandles, m_edgeHandles, m_faceHandles, m_tetHandles;
+
+      //Slot in the original complex -> dense index, or -1
+      std::vector<int> m_vertIndices, m_edgeIndices, m_faceIndices, m_tetIndices;
+
+      //The packed relations, in dense numbering
+      Relation m_EV, m_FE, m_TF; ///< downward, in the same (oriented) order as the original rows
+      Relation m_VE, m_EF, m_FT; ///< upward
+   };
+
+} // namespace SimplexMesh
+
+#endif // COMPACTCOMPLEX_H
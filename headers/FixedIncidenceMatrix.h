@@ -0,0 +1,165 @@
+#ifndef FIXEDINCIDENCEMATRIX_H
+#define FIXEDINCIDENCEMATRIX_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace SimplexMesh {
+
+  //An incidence matrix whose live rows always hold exactly N entries, as is the case for the
+  //downward (boundary) relations: 2 vertices per edge, 3 edges per face, 4 faces per tet.
+  //All rows are packed back to back in one flat array, N ints per row, so looking up an entry
+  //is a single indexed load with no per-row indirection.
+  //
+  //Entries use the same encoding as IncidenceMatrix (column shifted up by 1, sign gives the +1/-1 value),
+  //which leaves 0 free to mark unused slots. A row's entries are always packed at its front, so a dead
+  //row is simply all zeros. Rows may be transiently partially filled while being edited (remove + set).
+  template <unsigned int N>
+  class FixedIncidenceMatrix {
+
+  private:
+
+    //Matrix dimensions
+    unsigned int n_rows, n_cols;
+
+    //N entries per row, back to back.
+    std::vector<int> m_entries;
+
+    int* rowData(unsigned int i) { return &m_entries[i*N]; }
+    const int* rowData(unsigned int i) const { return &m_entries[i*N]; }
+
+  public:
+    FixedIncidenceMatrix() : n_rows(0), n_cols(0) {}
+    FixedIncidenceMatrix(unsigned int rows, unsigned int cols) : n_rows(rows), n_cols(cols), m_entries(rows*N, 0) {}
+
+    //Matrix dimensions
+    unsigned int getNumRows() const {return n_rows;}
+    unsigned int getNumCols() const {return n_cols;}
+    void addRows(unsigned int rows) { n_rows += rows; m_entries.resize(n_rows*N, 0); }
+    void addCols(unsigned int cols) { n_cols += cols; }
+    void reserveRows(unsigned int rows) { m_entries.reserve(rows*N); }
+
+    //Regular accessors
+    void set(unsigned int i, unsigned int j, int new_val) {
+      assert(i < n_rows && j < n_cols);
+      if(new_val == 0) {
+        remove(i,j);
+        return;
+      }
+      assert(new_val == 1 || new_val == -1);
+
+      int colShift = j+1;
+      int* row = rowData(i);
+      for(unsigned int k = 0; k < N; ++k) {
+        if(row[k] == 0 || std::abs(row[k]) == colShift) {
+          row[k] = new_val*colShift;
+          return;
+        }
+      }
+      assert(!"FixedIncidenceMatrix row is already full");
+    }
+
+    int get(unsigned int i, unsigned int j) const {
+      assert(i < n_rows && j < n_cols);
+      int colShift = j+1;
+      const int* row = rowData(i);
+      for(unsigned int k = 0; k < N; ++k)
+        if(std::abs(row[k]) == colShift)
+          return row[k] > 0 ? 1 : -1;
+      return 0;
+    }
+
+    bool exists(unsigned int i, unsigned int j) const { return get(i,j) != 0; }
+
+    void remove(unsigned int i, unsigned int j) {
+      assert(i < n_rows && j < n_cols);
+      int colShift = j+1;
+      int* row = rowData(i);
+      for(unsigned int k = 0; k < N; ++k) {
+        if(std::abs(row[k]) == colShift) {
+          for(; k < N-1; ++k)
+            row[k] = row[k+1];
+          row[N-1] = 0;
+          return;
+        }
+      }
+    }
+
+    void zeroRow(unsigned int i) {
+      int* row = rowData(i);
+      for(unsigned int k = 0; k < N; ++k)
+        row[k] = 0;
+    }
+
+    void zeroAll() { m_entries.assign(m_entries.size(), 0); }
+
+    void cycleRow(unsigned int i) { //permute the row by shifting them all over by 1
+      int* row = rowData(i);
+      unsigned int len = getNumEntriesInRow(i);
+      int t = row[0];
+      for(unsigned int k = 0; k+1 < len; ++k)
+        row[k] = row[k+1];
+      row[len-1] = t;
+    }
+
+    //Constant-time access within the row, by row-index rather than column number
+    unsigned int getNumEntriesInRow(unsigned int i) const {
+      assert(i < n_rows);
+      const int* row = rowData(i);
+      if(row[N-1] != 0) //the common case: a complete, live row
+        return N;
+      unsigned int len = 0;
+      while(len < N && row[len] != 0)
+        ++len;
+      return len;
+    }
+
+    unsigned int getColByIndex(unsigned int i, unsigned int index_in_row) const {
+      assert(i < n_rows && index_in_row < N);
+      assert(m_entries[i*N + index_in_row] != 0);
+      return std::abs(m_entries[i*N + index_in_row]) - 1;
+    }
+
+    int getValueByIndex(unsigned int i, unsigned int index_in_row) const {
+      assert(i < n_rows && index_in_row < N);
+      assert(m_entries[i*N + index_in_row] != 0);
+      return m_entries[i*N + index_in_row] > 0 ? 1 : -1;
+    }
+
+    void setByIndex(unsigned int i, unsigned int index_in_row, unsigned int col, int val) {
+      assert(i < n_rows && index_in_row < N);
+      assert(val == 1 || val == -1);
+      m_entries[i*N + index_in_row] = (col+1)*val;
+    }
+
+    //Bytes allocated for the entries, and in use by the current rows
+    size_t memoryUsage() const { return m_entries.capacity()*sizeof(int); }
+    size_t memoryUsed() const { return m_entries.size()*sizeof(int); }
+
+    //Exchange contents with another matrix, without copying.
+    void swap(FixedIncidenceMatrix& other) {
+      std::swap(n_rows, other.n_rows);
+      std::swap(n_cols, other.n_cols);
+      m_entries.swap(other.m_entries);
+    }
+
+    //Debugging
+    void printMatrix() const {
+      printf("Dimensions (%d,%d):\n", n_rows, n_cols);
+      for(unsigned int i = 0; i < n_rows; ++i) {
+        printf("%d: ", i);
+        const int* row = rowData(i);
+        for(unsigned int k = 0; k < N && row[k] != 0; ++k)
+          printf("%c%d ", row[k] > 0?'+':'-', std::abs(row[k])-1);
+        printf("\n");
+      }
+    }
+  };
+
+} // namespace SimplexMesh
+
+
+#endif //FIXEDINCIDENCEMATRIX_H
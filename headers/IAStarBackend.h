@@ -0,0 +1,71 @@
+#ifndef IASTARBACKEND_H
+#define IASTARBACKEND_H
+
+#include "TopologyBackend.h"
+#include "IncidenceMatrix.h"
+
+#include <vector>
+
+namespace SimplexMesh {
+
+   //A compact adjacency-based backend in the spirit of IA* ("IA*: An Adjacency-Based Representation for
+   //Non-Manifold Simplicial Shapes in Arbitrary Dimensions", Canino, De Floriani and Weiss).
+   //
+   //Only the top simplices (those that are not a face of any other simplex) are stored, as vertex tuples,
+   //together with the relation from each vertex to the top simplices incident on it. All other simplices
+   //are implicit: a simplex exists if some top simplex contains all of its vertices, and boundary/coboundary
+   //relations are derived on the fly from the tops around a vertex. This trades some query work for a much
+   //smaller footprint, especially on pure-tet meshes where edges and faces are never stored.
+   class IAStarBackend : public TopologyBackend {
+   public:
+      IAStarBackend();
+
+      const char* name() const { return "IA*"; }
+
+      VertexHandle addVertex();
+      bool addSimplex(const Simplex& s);
+      bool deleteSimplex(const Simplex& s);
+      bool exists(const Simplex& s) const;
+      void boundary(const Simplex& s, std::vector<Simplex>& out) const;
+      void coboundary(const Simplex& s, std::vector<Simplex>& out) const;
+      size_t memoryUsage() const;
+
+      int numTopSimplices(int dim) const { return m_numTops[dim]; }
+
+   private:
+
+      //Top simplices are referred to by id*4 + dim
+      static int topRef(int id, int dim) { return id*4 + dim; }
+      static int topDim(int ref) { return ref & 3; }
+      static int topId(int ref) { return ref >> 2; }
+
+      const int* topVerts(int ref) const { return &m_tops[topDim(ref)][topId(ref)*(topDim(ref)+1)]; }
+      bool topContains(int ref, const Simplex& s) const;
+
+      //The top simplex with exactly the vertices of s, or -1
+      int findTop(const Simplex& s) const;
+
+      //A top simplex of dimension >= that of s containing s, or -1
+      int findCoveringTop(const Simplex& s) const;
+
+      void insertTop(const Simplex& s);
+      void eraseTop(int ref);
+
+      bool validVertices(const Simplex& s) const;
+
+      //Vertex existence
+      std::vector<bool> m_V;
+
+      //Top simplices of dimension 1-3, (dim+1) vertex indices each. Dead slots start with -1 and are
+      //recycled through the free lists.
+      std::vector<int> m_tops[4];
+      std::vector<int> m_freeTops[4];
+      int m_numTops[4];
+
+      //Vertex to incident top simplices (columns are top refs)
+      IncidenceMatrix m_VT;
+   };
+
+} // namespace SimplexMesh
+
+#endif // IASTARBACKEND_H
@@ -2,24 +2,74 @@
 #define INCIDENCEMATRIX_H
 
 #include <cassert>
+#include <cstdlib>
 #include <vector>
 
 namespace SimplexMesh {
 
-  //A simple std::vector-based sparse compressed row incidence matrix 
+  //A simple sparse compressed row incidence matrix
   //to store the topology of our simplex mesh structure.
   //It needs to be resize-able in order to add/delete simplices.
+  //
+  //Rather than giving every row its own heap block, all row data lives in one shared slab,
+  //and each row records its offset/length/capacity within it. A row that outgrows its capacity
+  //is moved to the end of the slab, and the holes left behind are reclaimed by compact().
+  //
+  //Optionally, each row can also have a few entries of inline storage (see setInlineWidth), laid out
+  //back to back in a separate flat array. Rows that fit stay inline, and only high-valence rows
+  //spill over into the slab, which then acts as a shared overflow pool.
+  //
+  //Rows can also be kept sorted by column (see setSortedRows), so that lookups by column use binary search
+  //rather than a linear scan. This is only appropriate where the order within a row carries no meaning,
+  //i.e. the upward (transpose) relations.
   class IncidenceMatrix {
 
   private:
 
+    //Location of a single row's entries within the slab. Rows with zero capacity live inline.
+    struct RowSpan {
+      unsigned int offset;
+      unsigned int length;
+      unsigned int capacity;
+    };
+
     //Matrix dimensions
     unsigned int n_rows, n_cols;
 
-    //For each row, a list of all column indices, in oriented order where appropriate. 
+    //For each row, a list of all column indices, in oriented order where appropriate.
     //The sign indicates whether the value is intended to be: +1 or -1.
     //NOTE: We shift all column indices up by 1, so the zero'th column is enabled to have a sign!
-    std::vector< std::vector<int> > m_indices; 
+    std::vector<int> m_slab;
+    std::vector<RowSpan> m_rows;
+
+    //Inline storage, m_inlineWidth entries per row.
+    unsigned int m_inlineWidth;
+    std::vector<int> m_inline;
+
+    //Number of slab entries no longer owned by any row (left behind by rows that were moved).
+    unsigned int m_wasted;
+
+    //Whether rows are kept sorted by column.
+    bool m_sorted;
+
+    int* rowData(unsigned int i) {
+      return m_rows[i].capacity == 0 ? m_inline.data() + i*m_inlineWidth : m_slab.data() + m_rows[i].offset;
+    }
+    const int* rowData(unsigned int i) const {
+      return m_rows[i].capacity == 0 ? m_inline.data() + i*m_inlineWidth : m_slab.data() + m_rows[i].offset;
+    }
+
+    //Make sure row i has room for at least the given number of entries, relocating it if necessary.
+    void reserveRow(unsigned int i, unsigned int entries);
+
+    //Give up a row's slab space, moving its entries back into its inline slot.
+    void moveRowInline(unsigned int i);
+
+    //Position of the given (shifted) column within row i, or the row length if it is absent.
+    unsigned int findInRow(unsigned int i, int colShift) const;
+
+    //assignRows fills its rows from several threads
+    friend struct AssignRowsBlock;
 
   public:
     IncidenceMatrix();
@@ -30,6 +80,7 @@ namespace SimplexMesh {
     unsigned int getNumCols() const {return n_cols;}
     void addRows(unsigned int rows);
     void addCols(unsigned int cols);
+    void reserveRows(unsigned int rows); //preallocate for rows added later (and their inline entries)
 
     //Regular accessors
     void set(unsigned int i, unsigned int j, int new_val);
@@ -39,13 +90,56 @@ namespace SimplexMesh {
     void zeroRow(unsigned int i);
     void zeroAll();
 
-    void cycleRow(unsigned int index); //permute the row by shifting them all over by 1
+    void cycleRow(unsigned int index); //permute the row by shifting them all over by 1 (not for sorted rows)
 
     //Constant-time access within the row, by row-index rather than column number
-    unsigned int getNumEntriesInRow(unsigned int row) const;
-    unsigned int getColByIndex(unsigned int i, unsigned int index_in_row) const;
-    int getValueByIndex(unsigned int i, unsigned int index_in_row) const;
-    void setByIndex(unsigned int i, unsigned int index_in_row, unsigned int col, int val);
+    unsigned int getNumEntriesInRow(unsigned int row) const {
+      assert(row < n_rows);
+      return m_rows[row].length;
+    }
+    unsigned int getColByIndex(unsigned int i, unsigned int index_in_row) const {
+      assert(i < n_rows);
+      assert(index_in_row < m_rows[i].length);
+      return std::abs(rowData(i)[index_in_row]) - 1;
+    }
+    int getValueByIndex(unsigned int i, unsigned int index_in_row) const {
+      assert(i < n_rows);
+      assert(index_in_row < m_rows[i].length);
+      return rowData(i)[index_in_row] >= 0 ? 1 : -1;
+    }
+    void setByIndex(unsigned int i, unsigned int index_in_row, unsigned int col, int val); //not for sorted rows
+
+    //Keep rows sorted by column, so get/exists/set/remove use binary search. Off by default.
+    //Turning it on sorts the existing rows; cycleRow/setByIndex must not be used while it is on.
+    bool getSortedRows() const { return m_sorted; }
+    void setSortedRows(bool sorted);
+
+    //Number of entries stored inline per row (0 by default). Rows longer than this spill into the slab.
+    //Can be changed at any time; existing rows are redistributed accordingly.
+    unsigned int getInlineWidth() const { return m_inlineWidth; }
+    void setInlineWidth(unsigned int width);
+
+    //Squeeze out the holes left in the slab by relocated rows. Rows keep their capacity.
+    //Called automatically once the wasted space dominates, but can also be invoked explicitly.
+    void compact();
+
+    //Total bytes currently allocated for this matrix's storage, and the part of it in use by the rows
+    //(excluding spare capacity and the holes left in the slab by relocated rows).
+    size_t memoryUsage() const;
+    size_t memoryUsed() const;
+
+    //counts[k] = number of rows with k entries (counts is resized to fit the longest row).
+    void rowLengthHistogram(std::vector<unsigned int>& counts) const;
+
+    //Replace the whole contents in one go, from compressed rows: row i holds entries[rowStart[i]..rowStart[i+1]),
+    //each made with encode(). Short rows go inline and the rest are packed back to back in the slab; rows are
+    //copied in parallel.
+    //Storage options are kept; with sorted rows on, each row must already be sorted by column.
+    void assignRows(unsigned int rows, unsigned int cols, const std::vector<unsigned int>& rowStart, const std::vector<int>& entries);
+    static int encode(unsigned int col, int val) { return (int)(col+1)*val; }
+
+    //Exchange contents (including storage options) with another matrix, without copying.
+    void swap(IncidenceMatrix& other);
 
     //Debugging
     void printMatrix() const;
@@ -54,4 +148,4 @@ namespace SimplexMesh {
 } // namespace SimplexMesh
 
 
-#endif //INCIDENCEMATRIX_H
\ No newline at end of file
+#endif //INCIDENCEMATRIX_H
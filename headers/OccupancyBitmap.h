@@ -0,0 +1,139 @@
+#ifndef OCCUPANCYBITMAP_H
+#define OCCUPANCYBITMAP_H
+
+#include "SlotBitset.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace SimplexMesh {
+
+   //Which slots of one simplex type are live, one bit each, with a running count of live slots. Traversals skip dead
+   //runs a word at a time (findNext), and rank/select map between slots and their position among the live slots:
+   //rank(i) is the number of live slots before slot i, in constant time, and select(k) is the slot of the k-th live
+   //one, found by a short search from every 512th (a binary search over at most the words between two samples).
+   //The tables behind them are rebuilt by the first query after an edit, in one pass over the words; since that
+   //happens inside a const query, make one query first if several threads are about to.
+   class OccupancyBitmap {
+   public:
+      typedef SlotBitset::Word Word;
+      static const size_t npos = SlotBitset::npos;
+
+      OccupancyBitmap() : m_count(0), m_ranksValid(false) {}
+
+      //n slots, all live or all dead.
+      void assign(size_t n, bool live) {
+         SlotBitset bits;
+         bits.resize(n);
+         if(live)
+            bits.setAll();
+         m_bits.swap(bits);
+         m_count = live ? n : 0;
+         m_ranksValid = false;
+      }
+      void push_back(bool live) {
+         size_t i = m_bits.size();
+         m_bits.resize(i+1);
+         m_ranksValid = false;
+         if(live)
+            set(i);
+      }
+      void reserve(size_t n) { m_bits.reserve(n); }
+
+      void set(size_t i) {
+         if(!m_bits.test(i)) {
+            m_bits.set(i);
+            ++m_count;
+            m_ranksValid = false;
+         }
+      }
+      void reset(size_t i) {
+         if(m_bits.test(i)) {
+            m_bits.reset(i);
+            --m_count;
+            m_ranksValid = false;
+         }
+      }
+      bool operator[](size_t i) const { return m_bits.test(i); }
+
+      size_t size() const { return m_bits.size(); }
+      size_t count() const { return m_count; }
+
+      //The first live slot at or after i, or npos.
+      size_t findNext(size_t i) const { return m_bits.findNext(i); }
+
+      //The number of live slots before slot i (i <= size()).
+      size_t rank(size_t i) const {
+         updateRanks();
+         size_t w = i >> 6;
+         size_t r = m_wordRanks[w];
+         if(i & 63)
+            r += SlotBitset::popCount(m_bits.word(w) & (((Word)1 << (i & 63)) - 1));
+         return r;
+      }
+
+      //The slot of the k-th live one (counting from 0), or npos if there are no more than k.
+      size_t select(size_t k) const {
+         if(k >= m_count)
+            return npos;
+         updateRanks();
+
+         //the word holding it lies between the words of the samples either side
+         size_t s = k / SampleRate;
+         size_t lo = m_samples[s], hi = s+1 < m_samples.size() ? m_samples[s+1] + 1 : m_bits.numWords();
+         size_t w = std::upper_bound(m_wordRanks.begin() + lo, m_wordRanks.begin() + hi, (unsigned int)k) - m_wordRanks.begin() - 1;
+
+         //then drop the lower set bits of that word
+         Word bits = m_bits.word(w);
+         for(size_t r = k - m_wordRanks[w]; r > 0; --r)
+            bits &= bits - 1;
+         return (w << 6) + SlotBitset::lowestBit(bits);
+      }
+
+      void swap(OccupancyBitmap& other) {
+         m_bits.swap(other.m_bits);
+         std::swap(m_count, other.m_count);
+         m_wordRanks.swap(other.m_wordRanks);
+         m_samples.swap(other.m_samples);
+         std::swap(m_ranksValid, other.m_ranksValid);
+      }
+
+      size_t memoryUsed() const {
+         return m_bits.memoryUsed() + (m_wordRanks.size() + m_samples.size())*sizeof(unsigned int);
+      }
+      size_t memoryUsage() const {
+         return m_bits.memoryUsage() + (m_wordRanks.capacity() + m_samples.capacity())*sizeof(unsigned int);
+      }
+
+   private:
+      enum { SampleRate = 512 };
+
+      void updateRanks() const {
+         if(m_ranksValid)
+            return;
+         size_t words = m_bits.numWords();
+         m_wordRanks.resize(words + 1);
+         m_samples.clear();
+         unsigned int total = 0, nextSample = 0;
+         for(size_t w = 0; w < words; ++w) {
+            m_wordRanks[w] = total;
+            total += SlotBitset::popCount(m_bits.word(w));
+            for(; nextSample < total; nextSample += SampleRate)
+               m_samples.push_back((unsigned int)w);
+         }
+         m_wordRanks[words] = total;
+         m_ranksValid = true;
+      }
+
+      SlotBitset m_bits;
+      size_t m_count;
+
+      //live slots before each word, and the word holding every SampleRate-th live slot
+      mutable std::vector<unsigned int> m_wordRanks;
+      mutable std::vector<unsigned int> m_samples;
+      mutable bool m_ranksValid;
+   };
+
+} // namespace SimplexMesh
+
+#endif // OCCUPANCYBITMAP_H
@@ -0,0 +1,46 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace SimplexMesh {
+
+   //Number of threads the parallel loops split their work across (the hardware concurrency, at least 1).
+   inline unsigned int workerCount() {
+      unsigned int n = std::thread::hardware_concurrency();
+      return n > 0 ? n : 1;
+   }
+
+   template<class Body>
+   struct ParallelBlock {
+      const Body& body;
+      size_t begin, end;
+      ParallelBlock(const Body& b, size_t first, size_t last) : body(b), begin(first), end(last) {}
+      void operator()() const { body(begin, end); }
+   };
+
+   //Call body(begin, end) on contiguous blocks covering [0, n), one block per worker, and wait for all of them.
+   //Ranges shorter than about two blocks of minBlock run on the calling thread.
+   template<class Body>
+   void parallelFor(size_t n, const Body& body, size_t minBlock = 4096) {
+      size_t blocks = std::min<size_t>(workerCount(), n / minBlock);
+      if(blocks <= 1) {
+         if(n > 0) body(0, n);
+         return;
+      }
+
+      size_t step = (n + blocks - 1) / blocks;
+      std::vector<std::thread> threads;
+      threads.reserve(blocks-1);
+      for(size_t b = 1; b < blocks; ++b)
+         threads.push_back(std::thread(ParallelBlock<Body>(body, b*step, std::min(n, (b+1)*step))));
+      body(0, step);
+      for(size_t i = 0; i < threads.size(); ++i)
+         threads[i].join();
+   }
+
+} // namespace SimplexMesh
+
+#endif // PARALLEL_H
@@ -0,0 +1,272 @@
+#ifndef PARALLELFOREACH_H
+#define PARALLELFOREACH_H
+
+#include "SimplicialComplex.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace SimplexMesh {
+
+   //Parallel loops over the live simplices of one type:
+   //   parallelForEachTet(mesh, fn);            //fn(th) for every live tet
+   //   PerThread<Scratch> scratch(4);
+   //   parallelForEachTet(mesh, fn, scratch);   //fn(th, scratch[w]) on 4 threads, w being the calling worker
+   //   double volume = parallelReduceTets(mesh, tetVolume, std::plus<double>(), 0.0);
+   //The live simplices are cut into chunks of grain live simplices each (by select on the occupancy bitmaps), so
+   //clustered dead slots don't unbalance the threads. Each worker starts on its own contiguous run of chunks, and once
+   //that is used up, steals the back half of another worker's run.
+   //fn may read the complex freely, but must not edit it. The adjacency caches refresh themselves on read, so call
+   //updateAdjacencyCaches() before using the cached iterators inside fn. Writing a property at the simplex being
+   //visited is safe, unless the property holds bools or tracks dirty slots (both pack neighbouring slots into shared
+   //words). A thread count of 0 means workerCount().
+
+   //One T per worker, for scratch space or per-thread partial results.
+   template<class T>
+   class PerThread {
+   public:
+      explicit PerThread(unsigned int threads = 0, const T& init = T()) : m_items(threads > 0 ? threads : workerCount(), init) {}
+
+      unsigned int size() const { return (unsigned int)m_items.size(); }
+      T& operator[](unsigned int worker) { return m_items[worker]; }
+      const T& operator[](unsigned int worker) const { return m_items[worker]; }
+
+      //Fold the items together in worker order. Which simplices each worker saw varies from run to run, so the result
+      //only repeats exactly for exact operations (integer sums, min, max...); see parallelReduce for the others.
+      template<class Combine>
+      T combine(T result, const Combine& op) const {
+         for(size_t i = 0; i < m_items.size(); ++i)
+            result = op(result, m_items[i]);
+         return result;
+      }
+
+   private:
+      std::vector<T> m_items;
+   };
+
+   //Hands out chunks [0, chunks) to workers: each owns a contiguous run, takes chunks from its front, and when it has
+   //none left, takes the back half of the first nonempty run after its own.
+   class ChunkScheduler {
+   public:
+      ChunkScheduler(size_t chunks, unsigned int workers) : m_runs(new Run[workers]), m_workers(workers) {
+         for(unsigned int w = 0; w < workers; ++w) {
+            m_runs[w].begin = chunks * w / workers;
+            m_runs[w].end = chunks * (w+1) / workers;
+         }
+      }
+      ~ChunkScheduler() { delete[] m_runs; }
+
+      //The next chunk for the worker, or false once there is nothing left to take.
+      bool next(unsigned int worker, size_t& chunk) {
+         if(pop(worker, chunk))
+            return true;
+         for(unsigned int i = 1; i < m_workers; ++i) {
+            Run& victim = m_runs[(worker + i) % m_workers];
+            size_t begin, end;
+            {
+               std::lock_guard<std::mutex> lock(victim.lock);
+               if(victim.begin == victim.end)
+                  continue;
+               end = victim.end;
+               begin = victim.end - (victim.end - victim.begin + 1) / 2;
+               victim.end = begin;
+            }
+            Run& own = m_runs[worker];
+            std::lock_guard<std::mutex> lock(own.lock);
+            own.begin = begin + 1;
+            own.end = end;
+            chunk = begin;
+            return true;
+         }
+         return false;
+      }
+
+   private:
+      struct Run {
+         std::mutex lock;
+         size_t begin, end;
+         char padding[64]; //keep workers' runs off each other's cache lines
+      };
+
+      bool pop(unsigned int worker, size_t& chunk) {
+         Run& own = m_runs[worker];
+         std::lock_guard<std::mutex> lock(own.lock);
+         if(own.begin == own.end)
+            return false;
+         chunk = own.begin++;
+         return true;
+      }
+
+      Run* m_runs;
+      unsigned int m_workers;
+
+      ChunkScheduler(const ChunkScheduler&);
+      ChunkScheduler& operator=(const ChunkScheduler&);
+   };
+
+   //The live simplices of one type, cut into chunks of equal live count: chunk c runs from slot start[c] (live) up to
+   //slot start[c+1].
+   template<class Handle>
+   class LiveChunks {
+   public:
+      LiveChunks(const SimplicialComplex& obj, size_t grain) : m_live(SimplexTraits<Handle>::live(obj)) {
+         size_t count = m_live.count();
+         size_t chunks = (count + grain - 1) / grain;
+         m_start.resize(chunks + 1);
+         for(size_t c = 0; c < chunks; ++c)
+            m_start[c] = m_live.select(c * grain);
+         m_start[chunks] = m_live.size();
+      }
+
+      size_t size() const { return m_start.size() - 1; }
+
+      //call(h) on each live simplex of the chunk
+      template<class Call>
+      void visit(size_t chunk, const Call& call) const {
+         for(size_t slot = m_start[chunk]; slot < m_start[chunk+1]; slot = m_live.findNext(slot+1))
+            call(SimplexTraits<Handle>::handle((int)slot));
+      }
+
+   private:
+      const OccupancyBitmap& m_live;
+      std::vector<size_t> m_start;
+   };
+
+   //Default chunk size, in live simplices.
+   const size_t ParallelGrain = 1024;
+
+   //Run task(chunk, worker) on every chunk across the given number of workers, the calling thread being worker 0.
+   template<class Task>
+   struct ChunkWorker {
+      const Task& task;
+      ChunkScheduler& scheduler;
+      unsigned int worker;
+      ChunkWorker(const Task& t, ChunkScheduler& s, unsigned int w) : task(t), scheduler(s), worker(w) {}
+      void operator()() const {
+         size_t chunk;
+         while(scheduler.next(worker, chunk))
+            task(chunk, worker);
+      }
+   };
+
+   template<class Task>
+   void runChunks(size_t chunks, unsigned int threads, const Task& task) {
+      threads = std::max(1u, (unsigned int)std::min<size_t>(threads > 0 ? threads : workerCount(), chunks));
+      ChunkScheduler scheduler(chunks, threads);
+      std::vector<std::thread> workers;
+      workers.reserve(threads-1);
+      for(unsigned int w = 1; w < threads; ++w)
+         workers.push_back(std::thread(ChunkWorker<Task>(task, scheduler, w)));
+      ChunkWorker<Task>(task, scheduler, 0)();
+      for(size_t i = 0; i < workers.size(); ++i)
+         workers[i].join();
+   }
+
+   //Chunk tasks behind the loops below
+   template<class Handle, class Fn>
+   struct ForEachTask {
+      struct Visit {
+         const Fn& fn;
+         Visit(const Fn& f) : fn(f) {}
+         void operator()(const Handle& h) const { fn(h); }
+      };
+      const LiveChunks<Handle>& chunks;
+      const Fn& fn;
+      ForEachTask(const LiveChunks<Handle>& c, const Fn& f) : chunks(c), fn(f) {}
+      void operator()(size_t chunk, unsigned int) const { chunks.visit(chunk, Visit(fn)); }
+   };
+
+   template<class Handle, class Fn, class T>
+   struct ForEachScratchTask {
+      struct Visit {
+         const Fn& fn;
+         T& scratch;
+         Visit(const Fn& f, T& s) : fn(f), scratch(s) {}
+         void operator()(const Handle& h) const { fn(h, scratch); }
+      };
+      const LiveChunks<Handle>& chunks;
+      const Fn& fn;
+      PerThread<T>& scratch;
+      ForEachScratchTask(const LiveChunks<Handle>& c, const Fn& f, PerThread<T>& s) : chunks(c), fn(f), scratch(s) {}
+      void operator()(size_t chunk, unsigned int worker) const { chunks.visit(chunk, Visit(fn, scratch[worker])); }
+   };
+
+   template<class Handle, class T, class Map, class Combine>
+   struct ReduceTask {
+      struct Visit {
+         const Map& map;
+         const Combine& combine;
+         T& partial;
+         mutable bool started;
+         Visit(const Map& m, const Combine& c, T& p) : map(m), combine(c), partial(p), started(false) {}
+         void operator()(const Handle& h) const {
+            if(started)
+               partial = combine(partial, map(h));
+            else
+               partial = map(h);
+            started = true;
+         }
+      };
+      const LiveChunks<Handle>& chunks;
+      const Map& map;
+      const Combine& combine;
+      std::vector<T>& partials;
+      ReduceTask(const LiveChunks<Handle>& c, const Map& m, const Combine& op, std::vector<T>& p) : chunks(c), map(m), combine(op), partials(p) {}
+      void operator()(size_t chunk, unsigned int) const { chunks.visit(chunk, Visit(map, combine, partials[chunk])); }
+   };
+
+   //Call fn(h) on every live simplex of the handle's type.
+   template<class Handle, class Fn>
+   void parallelForEach(const SimplicialComplex& obj, const Fn& fn, unsigned int threads = 0, size_t grain = ParallelGrain) {
+      LiveChunks<Handle> chunks(obj, grain);
+      runChunks(chunks.size(), threads, ForEachTask<Handle, Fn>(chunks, fn));
+   }
+
+   //Call fn(h, scratch[w]) on every live simplex, on scratch.size() threads, w being the worker making the call.
+   template<class Handle, class Fn, class T>
+   void parallelForEach(const SimplicialComplex& obj, const Fn& fn, PerThread<T>& scratch, size_t grain = ParallelGrain) {
+      LiveChunks<Handle> chunks(obj, grain);
+      runChunks(chunks.size(), scratch.size(), ForEachScratchTask<Handle, Fn, T>(chunks, fn, scratch));
+   }
+
+   //Fold combine(partial, map(h)) over the live simplices. Each chunk starts from the value of its first simplex (chunks
+   //are never empty), and the chunks' results are then folded in order onto init, so init counts exactly once and need
+   //not be an identity of combine (eg. an offset for a sum, or a bound for a min). The grouping depends only on the
+   //grain, not on the threads or how the work was shared out, so floating point results are the same from run to run
+   //and for any thread count.
+   template<class Handle, class T, class Map, class Combine>
+   T parallelReduce(const SimplicialComplex& obj, const Map& map, const Combine& combine, const T& init,
+      unsigned int threads = 0, size_t grain = ParallelGrain)
+   {
+      LiveChunks<Handle> chunks(obj, grain);
+      std::vector<T> partials(chunks.size(), init); //each overwritten by its chunk's first value
+      runChunks(chunks.size(), threads, ReduceTask<Handle, T, Map, Combine>(chunks, map, combine, partials));
+      T result = init;
+      for(size_t c = 0; c < partials.size(); ++c)
+         result = combine(result, partials[c]);
+      return result;
+   }
+
+   //Per-type shorthands
+   template<class Fn> void parallelForEachVertex(const SimplicialComplex& obj, const Fn& fn, unsigned int threads = 0) { parallelForEach<VertexHandle>(obj, fn, threads); }
+   template<class Fn> void parallelForEachEdge(const SimplicialComplex& obj, const Fn& fn, unsigned int threads = 0) { parallelForEach<EdgeHandle>(obj, fn, threads); }
+   template<class Fn> void parallelForEachFace(const SimplicialComplex& obj, const Fn& fn, unsigned int threads = 0) { parallelForEach<FaceHandle>(obj, fn, threads); }
+   template<class Fn> void parallelForEachTet(const SimplicialComplex& obj, const Fn& fn, unsigned int threads = 0) { parallelForEach<TetHandle>(obj, fn, threads); }
+
+   template<class Fn, class T> void parallelForEachVertex(const SimplicialComplex& obj, const Fn& fn, PerThread<T>& scratch) { parallelForEach<VertexHandle>(obj, fn, scratch); }
+   template<class Fn, class T> void parallelForEachEdge(const SimplicialComplex& obj, const Fn& fn, PerThread<T>& scratch) { parallelForEach<EdgeHandle>(obj, fn, scratch); }
+   template<class Fn, class T> void parallelForEachFace(const SimplicialComplex& obj, const Fn& fn, PerThread<T>& scratch) { parallelForEach<FaceHandle>(obj, fn, scratch); }
+   template<class Fn, class T> void parallelForEachTet(const SimplicialComplex& obj, const Fn& fn, PerThread<T>& scratch) { parallelForEach<TetHandle>(obj, fn, scratch); }
+
+   template<class T, class Map, class Combine> T parallelReduceVertices(const SimplicialComplex& obj, const Map& map, const Combine& combine, const T& init, unsigned int threads = 0) { return parallelReduce<VertexHandle>(obj, map, combine, init, threads); }
+   template<class T, class Map, class Combine> T parallelReduceEdges(const SimplicialComplex& obj, const Map& map, const Combine& combine, const T& init, unsigned int threads = 0) { return parallelReduce<EdgeHandle>(obj, map, combine, init, threads); }
+   template<class T, class Map, class Combine> T parallelReduceFaces(const SimplicialComplex& obj, const Map& map, const Combine& combine, const T& init, unsigned int threads = 0) { return parallelReduce<FaceHandle>(obj, map, combine, init, threads); }
+   template<class T, class Map, class Combine> T parallelReduceTets(const SimplicialComplex& obj, const Map& map, const Combine& combine, const T& init, unsigned int threads = 0) { return parallelReduce<TetHandle>(obj, map, combine, init, threads); }
+
+} // namespace SimplexMesh
+
+#endif // PARALLELFOREACH_H
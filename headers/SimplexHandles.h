@@ -25,10 +25,20 @@ public:
   
   friend class VertexIterator;
   friend class VertexEdgeIterator;friend class EdgeVertexIterator;
+  friend class TetVertexIterator;
+  friend class CachedVertexVertexIterator; friend class CachedVertexTetIterator;
 
   friend class SimplicialComplex;
+  friend class CompactComplex;
+  friend class SimplexRemap;
+  template<class Handle> friend struct SimplexTraits;
+  friend class IAStarBackend;
   
   template<class T> friend class VertexProperty;
+  template<class T, unsigned int N> friend class VertexPropertySoA;
+  template<class T, unsigned int N> friend class VertexPropertyBuffered;
+  template<class Codec, unsigned int N> friend class VertexPropertyCompressed;
+  template<class T> friend class VertexPropertySparse;
 
   bool operator== (const VertexHandle& rhs) const { return m_idx == rhs.m_idx; }
   bool operator!= (const VertexHandle& rhs) const { return m_idx != rhs.m_idx; }
@@ -61,10 +71,19 @@ public:
   friend class EdgeIterator;
    friend class VertexEdgeIterator; friend class EdgeVertexIterator;
    friend class EdgeFaceIterator; friend class FaceEdgeIterator;
+   friend class VertexFaceIterator; friend class TetEdgeIterator;
+   friend class CachedEdgeTetIterator;
 
   friend class SimplicialComplex;
+  friend class CompactComplex;
+  friend class SimplexRemap;
+  template<class Handle> friend struct SimplexTraits;
 
   template<class T> friend class EdgeProperty;
+  template<class T, unsigned int N> friend class EdgePropertySoA;
+  template<class T, unsigned int N> friend class EdgePropertyBuffered;
+  template<class Codec, unsigned int N> friend class EdgePropertyCompressed;
+  template<class T> friend class EdgePropertySparse;
 
   bool operator== (const EdgeHandle& rhs) const { return m_idx == rhs.m_idx; }
   bool operator!= (const EdgeHandle& rhs) const { return m_idx != rhs.m_idx; }
@@ -93,14 +112,22 @@ public:
   friend class FaceVertexIterator;
   friend class VertexFaceIterator;
   friend class SimplicialComplex;
+  friend class CompactComplex;
+  friend class SimplexRemap;
+  template<class Handle> friend struct SimplexTraits;
 
   friend class FaceIterator;
   friend class FaceEdgeIterator;
   friend class EdgeFaceIterator;
   friend class FaceTetIterator;
   friend class TetFaceIterator;
+  friend class VertexTetIterator;
 
   template<class T> friend class FaceProperty;
+  template<class T, unsigned int N> friend class FacePropertySoA;
+  template<class T, unsigned int N> friend class FacePropertyBuffered;
+  template<class Codec, unsigned int N> friend class FacePropertyCompressed;
+  template<class T> friend class FacePropertySparse;
 
   bool operator== (const FaceHandle& rhs) const { return m_idx == rhs.m_idx; }
   bool operator!= (const FaceHandle& rhs) const { return m_idx != rhs.m_idx; }
@@ -126,11 +153,21 @@ public:
 
   friend class TetIterator;
   friend class SimplicialComplex;
+  friend class CompactComplex;
+  friend class SimplexRemap;
+  template<class Handle> friend struct SimplexTraits;
   
   friend class TetIterator;
   friend class FaceTetIterator; friend class TetFaceIterator;
+  friend class VertexTetIterator; friend class EdgeTetIterator;
+  friend class TetVertexIterator; friend class TetEdgeIterator;
+  friend class CachedVertexTetIterator; friend class CachedEdgeTetIterator; friend class TetTetIterator;
   
   template<class T> friend class TetProperty;
+  template<class T, unsigned int N> friend class TetPropertySoA;
+  template<class T, unsigned int N> friend class TetPropertyBuffered;
+  template<class Codec, unsigned int N> friend class TetPropertyCompressed;
+  template<class T> friend class TetPropertySparse;
 
   bool operator== (const TetHandle& rhs) const { return m_idx == rhs.m_idx; }
   bool operator!= (const TetHandle& rhs) const { return m_idx != rhs.m_idx; }
@@ -0,0 +1,127 @@
+#ifndef SIMPLEXINDEX_H
+#define SIMPLEXINDEX_H
+
+#include <algorithm>
+#include <vector>
+
+namespace SimplexMesh {
+
+   //The sorted vertex indices of an edge, face or tet (unused slots are -1), so that every ordering
+   //and orientation of the same vertices gives the same key.
+   struct SimplexKey {
+      int v[4];
+
+      SimplexKey() { set(-1, -1, -1, -1); }
+      SimplexKey(int v0, int v1) { set(v0, v1, -1, -1); std::sort(v, v+2); }
+      SimplexKey(int v0, int v1, int v2) { set(v0, v1, v2, -1); std::sort(v, v+3); }
+      SimplexKey(int v0, int v1, int v2, int v3) { set(v0, v1, v2, v3); std::sort(v, v+4); }
+
+      bool operator==(const SimplexKey& rhs) const {
+         return v[0] == rhs.v[0] && v[1] == rhs.v[1] && v[2] == rhs.v[2] && v[3] == rhs.v[3];
+      }
+
+      unsigned int hash() const {
+         unsigned int h = 0;
+         for(int i = 0; i < 4; ++i)
+            h = (h ^ (unsigned int)v[i]) * 0x9E3779B1u;
+         return h ^ (h >> 15);
+      }
+
+   private:
+      void set(int v0, int v1, int v2, int v3) { v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3; }
+   };
+
+   //Hash index from vertex keys to the simplices (of one dimension) with those vertices, in a flat open-addressed
+   //table (linear probing, at most half full). Several simplices can share a key, since a complex built without
+   //safety checks may contain duplicates; they are visited with find/findNext:
+   //   for(unsigned int s = index.find(key); s != SimplexIndex::npos; s = index.findNext(key, s)) ... index.at(s) ...
+   class SimplexIndex {
+   public:
+      static const unsigned int npos = ~0u;
+
+      SimplexIndex() : m_count(0) {}
+
+      void insert(const SimplexKey& key, int simplex) {
+         if(2*(m_count+1) > m_slots.size())
+            rehash(std::max<size_t>(16, 2*m_slots.size()));
+         unsigned int s = key.hash() & mask();
+         while(m_slots[s].simplex >= 0)
+            s = (s+1) & mask();
+         m_slots[s].key = key;
+         m_slots[s].simplex = simplex;
+         ++m_count;
+      }
+
+      //Removes the given simplex from under key, if it is there.
+      void erase(const SimplexKey& key, int simplex) {
+         unsigned int s = find(key);
+         while(s != npos && m_slots[s].simplex != simplex)
+            s = findNext(key, s);
+         if(s == npos)
+            return;
+
+         //shift later entries of the probe run back into the hole, so lookups never need tombstones
+         unsigned int hole = s;
+         for(unsigned int next = (hole+1) & mask(); m_slots[next].simplex >= 0; next = (next+1) & mask()) {
+            unsigned int home = m_slots[next].key.hash() & mask();
+            if(((next - home) & mask()) >= ((next - hole) & mask())) {
+               m_slots[hole] = m_slots[next];
+               hole = next;
+            }
+         }
+         m_slots[hole].simplex = -1;
+         --m_count;
+      }
+
+      unsigned int find(const SimplexKey& key) const {
+         if(m_slots.empty())
+            return npos;
+         return scan(key, key.hash() & mask());
+      }
+      unsigned int findNext(const SimplexKey& key, unsigned int slot) const { return scan(key, (slot+1) & mask()); }
+      int at(unsigned int slot) const { return m_slots[slot].simplex; }
+
+      void clear() { std::vector<Slot>().swap(m_slots); m_count = 0; }
+      void reserve(size_t n) { if(2*n > m_slots.size()) rehash(roundUp(2*n)); }
+      size_t size() const { return m_count; }
+      size_t memoryUsage() const { return m_slots.capacity()*sizeof(Slot); }
+      size_t memoryUsed() const { return m_count*sizeof(Slot); }
+
+   private:
+      struct Slot {
+         SimplexKey key;
+         int simplex; //-1 when empty
+         Slot() : simplex(-1) {}
+      };
+
+      unsigned int mask() const { return (unsigned int)m_slots.size() - 1; }
+
+      unsigned int scan(const SimplexKey& key, unsigned int s) const {
+         for(; m_slots[s].simplex >= 0; s = (s+1) & mask())
+            if(m_slots[s].key == key)
+               return s;
+         return npos;
+      }
+
+      static size_t roundUp(size_t n) {
+         size_t size = 16;
+         while(size < n) size *= 2;
+         return size;
+      }
+
+      void rehash(size_t size) {
+         std::vector<Slot> old(size);
+         old.swap(m_slots);
+         m_count = 0;
+         for(size_t i = 0; i < old.size(); ++i)
+            if(old[i].simplex >= 0)
+               insert(old[i].key, old[i].simplex);
+      }
+
+      std::vector<Slot> m_slots;
+      size_t m_count;
+   };
+
+} // namespace SimplexMesh
+
+#endif // SIMPLEXINDEX_H
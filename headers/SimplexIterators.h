@@ -3,8 +3,10 @@
 
 #include "SimplicialComplex.h"
 #include "SimplexHandles.h"
+#include "SmallIndexList.h"
 
-#include <set>
+#include <algorithm>
+#include <vector>
 
 namespace SimplexMesh 
 {
@@ -185,8 +187,8 @@ public:
 private:
 
    const SimplicialComplex& m_obj;
-   std::set<FaceHandle> m_faces;
-   std::set<FaceHandle>::iterator m_fiter;
+   SmallIndexList m_faces;
+   unsigned int m_idx;
 
 };
 
@@ -214,8 +216,8 @@ public:
 private:
 
    const SimplicialComplex& m_obj;
-   std::set<TetHandle> m_tets;
-   std::set<TetHandle>::iterator m_titer;
+   SmallIndexList m_tets;
+   unsigned int m_idx;
 
 };
 
@@ -228,8 +230,8 @@ public:
 
 private:
    const SimplicialComplex& m_obj;
-   std::set<VertexHandle> m_verts;
-   std::set<VertexHandle>::iterator m_viter;
+   int m_verts[4]; //a tet has exactly 4 vertices, so they are kept in place
+   int m_count, m_idx;
 
 };
 
@@ -244,8 +246,8 @@ public:
 private:
 
    const SimplicialComplex& m_obj;
-   std::set<TetHandle> m_tets;
-   std::set<TetHandle>::iterator m_titer;
+   SmallIndexList m_tets;
+   unsigned int m_idx;
 
 };
 
@@ -258,12 +260,79 @@ public:
 
 private:
    const SimplicialComplex& m_obj;
-   std::set<EdgeHandle> m_edges;
-   std::set<EdgeHandle>::iterator m_eiter;
+   int m_edges[6]; //likewise its 6 edges
+   int m_count, m_idx;
 
 };
 
 
+
+//////////////////////////////////////////////////////////////////////////
+//Cached adjacency iterators
+
+//These walk the rows of the complex's adjacency caches (see SimplicialComplex::updateAdjacencyCaches), in increasing
+//handle order, at O(1) per step. Creating one may build or refresh the cache, so no edits while one is in use.
+
+class CachedVertexTetIterator {
+public:
+   CachedVertexTetIterator(const SimplicialComplex& obj, const VertexHandle& vh);
+   void advance();
+   bool done() const;
+   TetHandle current() const;
+
+private:
+   const AdjacencyCache& m_cache;
+   int m_row;
+   unsigned int m_count, m_idx;
+
+};
+
+class CachedEdgeTetIterator {
+public:
+   CachedEdgeTetIterator(const SimplicialComplex& obj, const EdgeHandle& eh);
+   void advance();
+   bool done() const;
+   TetHandle current() const;
+
+private:
+   const AdjacencyCache& m_cache;
+   int m_row;
+   unsigned int m_count, m_idx;
+
+};
+
+//The tets sharing a face with the given one.
+class TetTetIterator {
+public:
+   TetTetIterator(const SimplicialComplex& obj, const TetHandle& th);
+   void advance();
+   bool done() const;
+   TetHandle current() const;
+
+private:
+   const AdjacencyCache& m_cache;
+   int m_row;
+   unsigned int m_count, m_idx;
+
+};
+
+class CachedVertexVertexIterator {
+public:
+   CachedVertexVertexIterator(const SimplicialComplex& obj, const VertexHandle& vh);
+   void advance();
+   bool done() const;
+   VertexHandle current() const;
+
+private:
+   const AdjacencyCache& m_cache;
+   int m_row;
+   unsigned int m_count, m_idx;
+
+};
+
 }
 
+//Range adaptors over the iterators above
+#include "SimplexRanges.h"
+
 #endif
\ No newline at end of file
@@ -2,16 +2,20 @@
 #define SIMPLEXPROPERTY_H
 
 #include "SimplicialComplex.h"
+#include "SlotBitset.h"
 
 namespace SimplexMesh {
 
 //Base class, so TopologicalObject can store pointers to TopObjProperties of different types in a single list.
+//Each storage layout (SimplexProperty below, and the alternatives in the other SimplexProperty*.h headers) adds a
+//templated base class on top of it that is not used directly: the classes for each simplex type (VertexProperty,
+//EdgeProperty, ..., VertexPropertySoA, ...) are the ones that get registered with a complex and resized along with it.
 class SimplexPropertyBase {
 
 public:
 
-  SimplexPropertyBase(SimplicialComplex& obj) : m_obj(obj) {}
-  virtual ~SimplexPropertyBase() {}
+  SimplexPropertyBase(SimplicialComplex& obj) : m_obj(obj), m_listening(false) {}
+  virtual ~SimplexPropertyBase() { listenToSlots(false); }
 
 protected:
 
@@ -20,31 +24,189 @@ protected:
   virtual size_t size() const = 0;
   virtual void resize(size_t n) = 0;
 
+  //Reorder to match renumbered simplices: new slot i takes the value of old slot newToOld[i].
+  virtual void permute(const std::vector<int>& newToOld) = 0;
+
+  //Bytes holding values for the given number of slots, and bytes allocated.
+  virtual void memoryUsage(size_t slots, size_t& used, size_t& reserved) const = 0;
+
+  //The simplex in the given slot was deleted. Dense properties simply leave the stale value for the slot's next owner.
+  virtual void simplexDeleted(unsigned int /*slot*/) {}
+
+  //The simplices in slots first..last-1 were added, or their connectivity was changed in place (eg. by collapseEdge).
+  virtual void simplexChanged(unsigned int /*first*/, unsigned int /*last*/) {}
+
+  //Whether this property needs the two notifications above. The complex counts the properties that do, and while
+  //there are none it skips them altogether, so adding and deleting simplices never walks the property lists.
+  void listenToSlots(bool listen) {
+    if(listen == m_listening) return;
+    m_listening = listen;
+    if(listen) ++m_obj.m_slotListeners;
+    else --m_obj.m_slotListeners;
+  }
+
+  //Value updates inside splitEdge, collapseEdge and flipEdge, applied according to the property's PropertyUpdate.
+  virtual void deriveSlot(unsigned int /*child*/, unsigned int /*parent*/) {}
+  virtual void interpolateSlots(unsigned int /*target*/, unsigned int /*a*/, unsigned int /*b*/) {}
+  virtual void mergeSlots(unsigned int /*target*/, unsigned int /*other*/) {}
+
   //The simplex mesh this property is associated with.
   SimplicialComplex& m_obj;
+  bool m_listening;
 
   friend class SimplicialComplex;
 };
 
 
+//How the values of a property follow the local remeshing operations, so they need no second pass afterwards:
+// - derive: a new simplex replaces (part of) an old one of the same type (the halves of a split edge, the faces it splits
+//   into, the new diagonal of a flipped edge)
+// - interpolate: a new simplex lies between two old ones (the midpoint vertex of a split edge, the edges that cut its faces
+//   in two, each between the face's two other edges, and the new faces of a flip)
+// - merge: two simplices become one, target, which survives (the vertices of a collapsed edge, the edges it makes coincide)
+//Derive from this class for a custom update; CopyUpdate, MidpointUpdate and SumUpdate cover the common cases.
+template <class T>
+class PropertyUpdate {
+public:
+  virtual ~PropertyUpdate() {}
+  virtual PropertyUpdate* clone() const = 0;
+
+  virtual void derive(T& child, const T& parent) const = 0;
+  virtual void interpolate(T& target, const T& a, const T& b) const = 0;
+  virtual void merge(T& target, const T& other) const = 0;
+};
+
+//Labels, flags and materials: new simplices take the value of their parent (or the first of two); merges keep the target's.
+template <class T>
+class CopyUpdate : public PropertyUpdate<T> {
+public:
+  PropertyUpdate<T>* clone() const { return new CopyUpdate(*this); }
+  void derive(T& child, const T& parent) const { child = parent; }
+  void interpolate(T& target, const T& a, const T& /*b*/) const { target = a; }
+  void merge(T& /*target*/, const T& /*other*/) const {}
+};
+
+//Positions and other fields sampled on the mesh: interpolated and merged by averaging (T needs + and * double).
+template <class T>
+class MidpointUpdate : public PropertyUpdate<T> {
+public:
+  PropertyUpdate<T>* clone() const { return new MidpointUpdate(*this); }
+  void derive(T& child, const T& parent) const { child = parent; }
+  void interpolate(T& target, const T& a, const T& b) const { target = (a + b) * 0.5; }
+  void merge(T& target, const T& other) const { target = (target + other) * 0.5; }
+};
+
+//Accumulated quantities (weights, error quadrics): merges add up, otherwise as MidpointUpdate.
+template <class T>
+class SumUpdate : public PropertyUpdate<T> {
+public:
+  PropertyUpdate<T>* clone() const { return new SumUpdate(*this); }
+  void derive(T& child, const T& parent) const { child = parent; }
+  void interpolate(T& target, const T& a, const T& b) const { target = (a + b) * 0.5; }
+  void merge(T& target, const T& other) const { target = target + other; }
+};
+
+
 //The templated object property that stores the data. This is a base class that should not be used, since it doesn't get registered with
 //a particular simplex type (edge, face, etc.), and cannot be resized.
 template <class T>
 class SimplexProperty : public SimplexPropertyBase {
 
 public:
-  SimplexProperty(SimplicialComplex& obj, size_t n) : SimplexPropertyBase(obj), m_data(n) {}
+  SimplexProperty(SimplicialComplex& obj, size_t n) : SimplexPropertyBase(obj), m_data(n), m_trackDirty(false), m_update(0) {}
+
+  virtual ~SimplexProperty() { delete m_update; }
 
-  virtual ~SimplexProperty() {}
+  void assign(const T& data_value) { 
+    for(unsigned int i = 0; i < m_data.size(); ++i) m_data[i] = data_value; 
+    if(m_trackDirty) m_dirty.setAll();
+  }
 
-  void assign(const T& data_value) { for(unsigned int i = 0; i < m_data.size(); ++i) m_data[i] = data_value; }
+  //Optional dirty flags, so that derived quantities can be brought up to date in time proportional to what changed.
+  //While tracking, a slot is flagged when its value is written (non-const operator[], touch, assign), and when the
+  //complex adds, deletes or reconnects the simplex in it; the derived classes visit the flagged simplices with
+  //firstDirty/nextDirty. Note that operator[] on a non-const property flags the slot even if it is only read.
+  void trackDirty(bool enable) {
+    m_trackDirty = enable;
+    this->listenToSlots(enable);
+    if(enable) 
+      m_dirty.resize(m_data.size());
+    else
+      SlotBitset().swap(m_dirty);
+  }
+  bool tracksDirty() const { return m_trackDirty; }
+  void clearDirty() { m_dirty.clearAll(); }
+  size_t numDirty() const { return m_dirty.count(); }
+
+  //How values follow splitEdge, collapseEdge and flipEdge (a copy of the policy is kept). With no policy, the default, 
+  //values are left alone: new simplices get whatever their slot last held.
+  void setUpdatePolicy(const PropertyUpdate<T>& policy) { 
+    PropertyUpdate<T>* update = policy.clone();
+    delete m_update;
+    m_update = update;
+  }
+  void clearUpdatePolicy() { delete m_update; m_update = 0; }
+  const PropertyUpdate<T>* updatePolicy() const { return m_update; }
   
 protected: 
   
   size_t size() const { return m_data.size(); }
-  void resize(size_t n) { m_data.resize(n); }
+  void resize(size_t n) { 
+    m_data.resize(n); 
+    if(m_trackDirty) m_dirty.resize(n);
+  }
+
+  void permute(const std::vector<int>& newToOld) {
+    std::vector<T> permuted(newToOld.size());
+    for(unsigned int i = 0; i < newToOld.size(); ++i)
+      permuted[i] = m_data[newToOld[i]];
+    m_data.swap(permuted);
+    if(m_trackDirty) m_dirty.permute(newToOld);
+  }
+
+  void memoryUsage(size_t slots, size_t& used, size_t& reserved) const {
+    used = slots*sizeof(T) + (m_trackDirty ? (slots+7)/8 : 0);
+    reserved = m_data.capacity()*sizeof(T) + m_dirty.memoryUsage();
+  }
+
+  void simplexDeleted(unsigned int slot) { if(m_trackDirty) m_dirty.set(slot); }
+  void simplexChanged(unsigned int first, unsigned int last) { if(m_trackDirty) m_dirty.setRange(first, last); }
+
+  void deriveSlot(unsigned int child, unsigned int parent) {
+    if(m_update) m_update->derive(write(child), m_data[parent]);
+  }
+  void interpolateSlots(unsigned int target, unsigned int a, unsigned int b) {
+    if(m_update) m_update->interpolate(write(target), m_data[a], m_data[b]);
+  }
+  void mergeSlots(unsigned int target, unsigned int other) {
+    if(m_update) m_update->merge(write(target), m_data[other]);
+  }
+
+  //Copies of a property track dirty slots if the original does, starting with the same slots flagged.
+  void copyTracking(const SimplexProperty& other) {
+    trackDirty(other.m_trackDirty);
+    m_dirty = other.m_dirty;
+  }
+
+  //Entry for writing, flagged if tracking.
+  T& write(int idx) {
+    if(m_trackDirty) m_dirty.set(idx);
+    return m_data[idx];
+  }
+
+  //The first flagged slot at or after idx, or -1.
+  int nextDirtySlot(int idx) const {
+    size_t i = m_dirty.findNext(idx);
+    return i == SlotBitset::npos ? -1 : (int)i;
+  }
 
   std::vector<T> m_data;
+  bool m_trackDirty;
+  SlotBitset m_dirty;
+  PropertyUpdate<T>* m_update;
+
+private:
+  SimplexProperty(const SimplexProperty&);
   
 };
 
@@ -62,6 +224,8 @@ public:
   explicit VertexProperty(const VertexProperty& prop) : SimplexProperty<T>(prop.m_obj,prop.m_obj->numVertexSlots()) {
     this->m_obj.registerVertexProperty(this);
     this->m_data = prop.m_data;
+    if(prop.m_update) this->setUpdatePolicy(*prop.m_update);
+    this->copyTracking(prop);
   }
 
   ~VertexProperty() {
@@ -75,6 +239,8 @@ public:
 
         this->m_obj = other.m_obj;
         this->m_data = other.m_data;
+        if(other.m_update) this->setUpdatePolicy(*other.m_update); else this->clearUpdatePolicy();
+        this->copyTracking(other);
 
         this->m_obj.registerVertexProperty(this);
     }
@@ -84,7 +250,7 @@ public:
 
   T& operator[] (const VertexHandle& h) { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size());
-    return m_data[h.idx()]; 
+    return this->write(h.idx()); 
   }
 
   T const& operator[] (const VertexHandle& h) const { 
@@ -92,6 +258,14 @@ public:
     return m_data[h.idx()]; 
   }
 
+  //Dirty tracking (see SimplexProperty::trackDirty). Visit the flagged vertices with
+  //   for(VertexHandle h = prop.firstDirty(); h.isValid(); h = prop.nextDirty(h)) ...
+  //which may include deleted simplices and unused slots (check with vertexExists).
+  void touch(const VertexHandle& h) { this->write(h.idx()); }
+  bool isDirty(const VertexHandle& h) const { return this->m_trackDirty && this->m_dirty.test(h.idx()); }
+  VertexHandle firstDirty() const { return VertexHandle(this->nextDirtySlot(0)); }
+  VertexHandle nextDirty(const VertexHandle& h) const { return VertexHandle(this->nextDirtySlot(h.idx()+1)); }
+
 };
 
 
@@ -106,6 +280,8 @@ public:
   explicit EdgeProperty(const EdgeProperty& prop) : SimplexProperty<T>(prop.m_obj,prop.m_obj.numEdgeSlots()) {
     m_obj.registerEdgeProperty(this);
     m_data = prop.m_data;
+    if(prop.m_update) this->setUpdatePolicy(*prop.m_update);
+    this->copyTracking(prop);
   }
 
   ~EdgeProperty() {
@@ -119,6 +295,8 @@ public:
 
       this->m_obj = other.m_obj;
       this->m_data = other.m_data;
+      if(other.m_update) this->setUpdatePolicy(*other.m_update); else this->clearUpdatePolicy();
+      this->copyTracking(other);
 
       m_obj.registerEdgeProperty(this);
     }
@@ -129,13 +307,18 @@ public:
 
   T& operator[] (const EdgeHandle& h) { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size());
-    return m_data[h.idx()]; 
+    return this->write(h.idx()); 
   }
 
   T const& operator[] (const EdgeHandle& h) const { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size()); 
     return m_data[h.idx()]; 
   }
+
+  void touch(const EdgeHandle& h) { this->write(h.idx()); }
+  bool isDirty(const EdgeHandle& h) const { return this->m_trackDirty && this->m_dirty.test(h.idx()); }
+  EdgeHandle firstDirty() const { return EdgeHandle(this->nextDirtySlot(0)); }
+  EdgeHandle nextDirty(const EdgeHandle& h) const { return EdgeHandle(this->nextDirtySlot(h.idx()+1)); }
 };
 
 template <class T>
@@ -148,6 +331,8 @@ public:
   explicit FaceProperty(const FaceProperty& prop) : SimplexProperty<T>(prop.m_obj,prop.m_obj.numFaceSlots()) {
     m_obj.registerFaceProperty(this);
     m_data = prop.m_data;
+    if(prop.m_update) this->setUpdatePolicy(*prop.m_update);
+    this->copyTracking(prop);
   }
 
   ~FaceProperty() {
@@ -161,6 +346,8 @@ public:
 
       this->m_obj = other.m_obj;
       this->m_data = other.m_data;
+      if(other.m_update) this->setUpdatePolicy(*other.m_update); else this->clearUpdatePolicy();
+      this->copyTracking(other);
 
       m_obj.registerFaceProperty(this);
     }
@@ -170,7 +357,7 @@ public:
 
   T& operator[] (const FaceHandle& h) { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size());
-    return m_data[h.idx()]; 
+    return this->write(h.idx()); 
   }
 
   T const& operator[] (const FaceHandle& h) const { 
@@ -178,6 +365,11 @@ public:
     return m_data[h.idx()]; 
   }
 
+  void touch(const FaceHandle& h) { this->write(h.idx()); }
+  bool isDirty(const FaceHandle& h) const { return this->m_trackDirty && this->m_dirty.test(h.idx()); }
+  FaceHandle firstDirty() const { return FaceHandle(this->nextDirtySlot(0)); }
+  FaceHandle nextDirty(const FaceHandle& h) const { return FaceHandle(this->nextDirtySlot(h.idx()+1)); }
+
 };
 
 
@@ -191,6 +383,8 @@ public:
   explicit TetProperty(const TetProperty& prop) : SimplexProperty<T>(prop.m_obj,prop.m_obj.numTetSlots()) {
     m_obj->registerTetProperty(this);
     m_data = prop.m_data;
+    if(prop.m_update) this->setUpdatePolicy(*prop.m_update);
+    this->copyTracking(prop);
   }
 
   ~TetProperty() {
@@ -204,6 +398,8 @@ public:
 
       this->m_obj = other.m_obj;
       this->m_data = other.m_data;
+      if(other.m_update) this->setUpdatePolicy(*other.m_update); else this->clearUpdatePolicy();
+      this->copyTracking(other);
 
       m_obj.registerTetProperty(this);
     }
@@ -213,13 +409,18 @@ public:
 
   T& operator[] (const TetHandle& h) { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size());
-    return m_data[h.idx()]; 
+    return this->write(h.idx()); 
   }
 
   T const& operator[] (const TetHandle& h) const { 
     assert(h.idx() >= 0 && h.idx() < (int)m_data.size()); 
     return m_data[h.idx()]; 
   }
+
+  void touch(const TetHandle& h) { this->write(h.idx()); }
+  bool isDirty(const TetHandle& h) const { return this->m_trackDirty && this->m_dirty.test(h.idx()); }
+  TetHandle firstDirty() const { return TetHandle(this->nextDirtySlot(0)); }
+  TetHandle nextDirty(const TetHandle& h) const { return TetHandle(this->nextDirtySlot(h.idx()+1)); }
   
 };
 
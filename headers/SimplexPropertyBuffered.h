@@ -0,0 +1,222 @@
+#ifndef SIMPLEXPROPERTYBUFFERED_H
+#define SIMPLEXPROPERTYBUFFERED_H
+
+#include "SimplicialComplex.h"
+
+#include <cassert>
+#include <vector>
+
+namespace SimplexMesh {
+
+//A property holding N (2 or 3) copies of the per-simplex values, for time stepping: read the current state,
+//write the next one, then swapBuffers() to make it current in O(1), without copying any array. With N = 3 the
+//state before the current one stays available as previous (eg. for Verlet or BDF2 steps).
+//The buffers form a ring; all of them are resized and renumbered together with the complex.
+template <class T, unsigned int N>
+class SimplexPropertyBuffered : public SimplexPropertyBase {
+
+public:
+  SimplexPropertyBuffered(SimplicialComplex& obj, size_t n) : SimplexPropertyBase(obj), m_current(0) { resize(n); }
+
+  virtual ~SimplexPropertyBuffered() {}
+
+  enum { Buffers = N };
+
+  //Advance one step: next becomes current, current becomes previous, and the oldest buffer is reused as next.
+  void swapBuffers() { m_current = (m_current + 1) % N; }
+
+  //Buffer k of the ring (0 is current, 1 is next, N-1 is previous), indexed by simplex slot.
+  //Only valid until simplices are added or renumbered.
+  T* buffer(unsigned int k) { assert(k < N); return m_buffers[(m_current + k) % N].data(); }
+  const T* buffer(unsigned int k) const { assert(k < N); return m_buffers[(m_current + k) % N].data(); }
+
+  void assign(const T& data_value) {
+    for(unsigned int k = 0; k < N; ++k)
+      m_buffers[k].assign(m_buffers[k].size(), data_value);
+  }
+
+  //Copy the current values into the next buffer (when only some entries are written in a step).
+  void copyCurrentToNext() { ring(1) = ring(0); }
+
+protected:
+
+  size_t size() const { return m_buffers[0].size(); }
+  void resize(size_t n) {
+    for(unsigned int k = 0; k < N; ++k)
+      m_buffers[k].resize(n);
+  }
+
+  void permute(const std::vector<int>& newToOld) {
+    for(unsigned int k = 0; k < N; ++k) {
+      std::vector<T> permuted(newToOld.size());
+      for(unsigned int i = 0; i < newToOld.size(); ++i)
+        permuted[i] = m_buffers[k][newToOld[i]];
+      m_buffers[k].swap(permuted);
+    }
+  }
+
+  void memoryUsage(size_t slots, size_t& used, size_t& reserved) const {
+    used = N*slots*sizeof(T);
+    reserved = N*m_buffers[0].capacity()*sizeof(T);
+  }
+
+  std::vector<T>& ring(unsigned int k) { return m_buffers[(m_current + k) % N]; }
+  const std::vector<T>& ring(unsigned int k) const { return m_buffers[(m_current + k) % N]; }
+
+  T& at(int idx, unsigned int k) {
+    assert(idx >= 0 && idx < (int)size());
+    return ring(k)[idx];
+  }
+  const T& at(int idx, unsigned int k) const {
+    assert(idx >= 0 && idx < (int)size());
+    return ring(k)[idx];
+  }
+
+  std::vector<T> m_buffers[N];
+  unsigned int m_current;
+
+private:
+  SimplexPropertyBuffered& operator=(const SimplexPropertyBuffered&);
+};
+
+//Buffered properties for each simplex type, with two buffers unless N says otherwise. Entries are read and written
+//as current(h), next(h) and previous(h).
+template <class T, unsigned int N = 2>
+class VertexPropertyBuffered : public SimplexPropertyBuffered<T,N> {
+
+public:
+
+  VertexPropertyBuffered(SimplicialComplex& obj) : SimplexPropertyBuffered<T,N>(obj, obj.numVertexSlots()) {
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  explicit VertexPropertyBuffered(const VertexPropertyBuffered& prop) : SimplexPropertyBuffered<T,N>(prop.m_obj, 0) {
+    for(unsigned int k = 0; k < N; ++k)
+      this->m_buffers[k] = prop.m_buffers[k];
+    this->m_current = prop.m_current;
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  ~VertexPropertyBuffered() {
+    this->m_obj.removeVertexProperty(this);
+  }
+
+  //Number of vertex slots, i.e. the useful length of each buffer.
+  size_t slots() const { return this->m_obj.numVertexSlots(); }
+
+  T& current(const VertexHandle& h) { return this->at(h.idx(), 0); }
+  const T& current(const VertexHandle& h) const { return this->at(h.idx(), 0); }
+  T& next(const VertexHandle& h) { return this->at(h.idx(), 1); }
+  const T& next(const VertexHandle& h) const { return this->at(h.idx(), 1); }
+  T& previous(const VertexHandle& h) { return this->at(h.idx(), N-1); }
+  const T& previous(const VertexHandle& h) const { return this->at(h.idx(), N-1); }
+
+private:
+  VertexPropertyBuffered& operator=(const VertexPropertyBuffered&);
+};
+
+
+template <class T, unsigned int N = 2>
+class EdgePropertyBuffered : public SimplexPropertyBuffered<T,N> {
+
+public:
+
+  EdgePropertyBuffered(SimplicialComplex& obj) : SimplexPropertyBuffered<T,N>(obj, obj.numEdgeSlots()) {
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  explicit EdgePropertyBuffered(const EdgePropertyBuffered& prop) : SimplexPropertyBuffered<T,N>(prop.m_obj, 0) {
+    for(unsigned int k = 0; k < N; ++k)
+      this->m_buffers[k] = prop.m_buffers[k];
+    this->m_current = prop.m_current;
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  ~EdgePropertyBuffered() {
+    this->m_obj.removeEdgeProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numEdgeSlots(); }
+
+  T& current(const EdgeHandle& h) { return this->at(h.idx(), 0); }
+  const T& current(const EdgeHandle& h) const { return this->at(h.idx(), 0); }
+  T& next(const EdgeHandle& h) { return this->at(h.idx(), 1); }
+  const T& next(const EdgeHandle& h) const { return this->at(h.idx(), 1); }
+  T& previous(const EdgeHandle& h) { return this->at(h.idx(), N-1); }
+  const T& previous(const EdgeHandle& h) const { return this->at(h.idx(), N-1); }
+
+private:
+  EdgePropertyBuffered& operator=(const EdgePropertyBuffered&);
+};
+
+
+template <class T, unsigned int N = 2>
+class FacePropertyBuffered : public SimplexPropertyBuffered<T,N> {
+
+public:
+
+  FacePropertyBuffered(SimplicialComplex& obj) : SimplexPropertyBuffered<T,N>(obj, obj.numFaceSlots()) {
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  explicit FacePropertyBuffered(const FacePropertyBuffered& prop) : SimplexPropertyBuffered<T,N>(prop.m_obj, 0) {
+    for(unsigned int k = 0; k < N; ++k)
+      this->m_buffers[k] = prop.m_buffers[k];
+    this->m_current = prop.m_current;
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  ~FacePropertyBuffered() {
+    this->m_obj.removeFaceProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numFaceSlots(); }
+
+  T& current(const FaceHandle& h) { return this->at(h.idx(), 0); }
+  const T& current(const FaceHandle& h) const { return this->at(h.idx(), 0); }
+  T& next(const FaceHandle& h) { return this->at(h.idx(), 1); }
+  const T& next(const FaceHandle& h) const { return this->at(h.idx(), 1); }
+  T& previous(const FaceHandle& h) { return this->at(h.idx(), N-1); }
+  const T& previous(const FaceHandle& h) const { return this->at(h.idx(), N-1); }
+
+private:
+  FacePropertyBuffered& operator=(const FacePropertyBuffered&);
+};
+
+
+template <class T, unsigned int N = 2>
+class TetPropertyBuffered : public SimplexPropertyBuffered<T,N> {
+
+public:
+
+  TetPropertyBuffered(SimplicialComplex& obj) : SimplexPropertyBuffered<T,N>(obj, obj.numTetSlots()) {
+    this->m_obj.registerTetProperty(this);
+  }
+
+  explicit TetPropertyBuffered(const TetPropertyBuffered& prop) : SimplexPropertyBuffered<T,N>(prop.m_obj, 0) {
+    for(unsigned int k = 0; k < N; ++k)
+      this->m_buffers[k] = prop.m_buffers[k];
+    this->m_current = prop.m_current;
+    this->m_obj.registerTetProperty(this);
+  }
+
+  ~TetPropertyBuffered() {
+    this->m_obj.removeTetProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numTetSlots(); }
+
+  T& current(const TetHandle& h) { return this->at(h.idx(), 0); }
+  const T& current(const TetHandle& h) const { return this->at(h.idx(), 0); }
+  T& next(const TetHandle& h) { return this->at(h.idx(), 1); }
+  const T& next(const TetHandle& h) const { return this->at(h.idx(), 1); }
+  T& previous(const TetHandle& h) { return this->at(h.idx(), N-1); }
+  const T& previous(const TetHandle& h) const { return this->at(h.idx(), N-1); }
+
+private:
+  TetPropertyBuffered& operator=(const TetPropertyBuffered&);
+};
+
+}
+
+#endif
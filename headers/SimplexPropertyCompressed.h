@@ -0,0 +1,376 @@
+#ifndef SIMPLEXPROPERTYCOMPRESSED_H
+#define SIMPLEXPROPERTYCOMPRESSED_H
+
+#include "SimplicialComplex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <vector>
+
+namespace SimplexMesh {
+
+//Codes of a fixed width (1 to 32 bits) packed back to back into 64-bit words; a code may straddle two words.
+class PackedCodes {
+
+public:
+  typedef unsigned long long Word;
+
+  explicit PackedCodes(unsigned int width) : m_width(width), m_size(0) { assert(width >= 1 && width <= 32); }
+
+  //New codes are zero.
+  void resize(size_t n) {
+    size_t bits = n*m_width;
+    m_words.resize((bits + 63) / 64, 0);
+    if(n < m_size && bits % 64 != 0) //clear the dropped codes sharing the last word, for later growth
+      m_words.back() &= ((Word)1 << (bits % 64)) - 1;
+    m_size = n;
+  }
+  size_t size() const { return m_size; }
+
+  unsigned int get(size_t i) const {
+    size_t bit = i*m_width;
+    size_t w = bit >> 6;
+    unsigned int offset = bit & 63;
+    Word code = m_words[w] >> offset;
+    if(offset + m_width > 64)
+      code |= m_words[w+1] << (64 - offset);
+    return (unsigned int)(code & mask());
+  }
+
+  void set(size_t i, unsigned int code) {
+    size_t bit = i*m_width;
+    size_t w = bit >> 6;
+    unsigned int offset = bit & 63;
+    Word c = code & mask();
+    m_words[w] = (m_words[w] & ~(mask() << offset)) | (c << offset);
+    if(offset + m_width > 64) {
+      unsigned int spill = 64 - offset;
+      m_words[w+1] = (m_words[w+1] & ~(mask() >> spill)) | (c >> spill);
+    }
+  }
+
+  void swap(PackedCodes& other) {
+    m_words.swap(other.m_words);
+    std::swap(m_width, other.m_width);
+    std::swap(m_size, other.m_size);
+  }
+
+  unsigned int width() const { return m_width; }
+  size_t memoryUsed() const { return (m_size*m_width + 7) / 8; }
+  size_t memoryUsage() const { return m_words.capacity()*sizeof(Word); }
+
+private:
+  Word mask() const { return (~(Word)0) >> (64 - m_width); }
+
+  std::vector<Word> m_words;
+  unsigned int m_width;
+  size_t m_size;
+};
+
+
+//Codecs turning values into codes of Bits bits and back, for SimplexPropertyCompressed.
+
+//IEEE 754 half precision (binary16): about 3 significant digits over +-65504, rounded to nearest even.
+class HalfCodec {
+public:
+  typedef float Value;
+  enum { Bits = 16 };
+
+  unsigned int encode(float f) const {
+    unsigned int x;
+    std::memcpy(&x, &f, sizeof(x));
+    unsigned int sign = (x >> 16) & 0x8000;
+    unsigned int mantissa = x & 0x7fffff;
+    int exponent = (int)((x >> 23) & 0xff);
+    if(exponent == 255) //infinity or NaN
+      return sign | 0x7c00 | (mantissa ? 0x200 : 0);
+
+    int e = exponent - 127 + 15;
+    if(e >= 31) //too large: infinity
+      return sign | 0x7c00;
+    if(e <= 0) { //subnormal, or zero
+      if(e < -10)
+        return sign;
+      mantissa |= 0x800000;
+      unsigned int shift = 14 - e;
+      unsigned int half = mantissa >> shift;
+      unsigned int rest = mantissa & ((1u << shift) - 1), halfway = 1u << (shift - 1);
+      if(rest > halfway || (rest == halfway && (half & 1)))
+        ++half;
+      return sign | half;
+    }
+
+    //rounding may carry into the exponent, which is still correct (up to infinity)
+    unsigned int half = sign | (e << 10) | (mantissa >> 13);
+    unsigned int rest = mantissa & 0x1fff;
+    if(rest > 0x1000 || (rest == 0x1000 && (half & 1)))
+      ++half;
+    return half;
+  }
+
+  float decode(unsigned int h) const {
+    unsigned int sign = (h & 0x8000) << 16;
+    int exponent = (h >> 10) & 0x1f;
+    unsigned int mantissa = h & 0x3ff;
+    unsigned int x;
+    if(exponent == 0) {
+      if(mantissa == 0)
+        x = sign;
+      else { //subnormal: normalize
+        exponent = 1;
+        while(!(mantissa & 0x400)) {
+          mantissa <<= 1;
+          --exponent;
+        }
+        x = sign | ((exponent + 127 - 15) << 23) | ((mantissa & 0x3ff) << 13);
+      }
+    }
+    else if(exponent == 31)
+      x = sign | 0x7f800000 | (mantissa << 13);
+    else
+      x = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+    float f;
+    std::memcpy(&f, &x, sizeof(f));
+    return f;
+  }
+};
+
+//Fixed point over the property's bounds [lo, hi]: 2^Bits evenly spaced levels, values outside are clamped.
+//The error is at most half a step, (hi - lo) / (2^Bits - 1) / 2.
+template <unsigned int B>
+class QuantizedCodec {
+public:
+  typedef float Value;
+  enum { Bits = B };
+
+  QuantizedCodec(float lo = 0, float hi = 1) : m_lo(lo), m_hi(hi),
+    m_scale(float(maxCode()) / (hi - lo)), m_step((hi - lo) / float(maxCode())) { assert(hi > lo); }
+
+  unsigned int encode(float f) const {
+    if(!(f > m_lo)) return 0; //also catches NaN
+    if(f >= m_hi) return maxCode();
+    return (unsigned int)((f - m_lo)*m_scale + 0.5f);
+  }
+  float decode(unsigned int code) const { return m_lo + code*m_step; }
+
+  float lo() const { return m_lo; }
+  float hi() const { return m_hi; }
+
+private:
+  static unsigned int maxCode() { return (unsigned int)((1ull << B) - 1); }
+
+  float m_lo, m_hi, m_scale, m_step;
+};
+
+//Booleans, enums and small counts stored in Bits bits each (eg. BitCodec<bool,1>, BitCodec<Material,3>).
+template <class T, unsigned int B>
+class BitCodec {
+public:
+  typedef T Value;
+  enum { Bits = B };
+
+  unsigned int encode(const T& value) const { return (unsigned int)value; }
+  T decode(unsigned int code) const { return static_cast<T>(code); }
+};
+
+
+//A property stored in compressed form: each of its N components per simplex is kept as a Codec::Bits-bit code.
+//Values are read and written by copy (get/set), or in bulk as spans of Codec::Value (eg. float) for kernels.
+template <class Codec, unsigned int N>
+class SimplexPropertyCompressed : public SimplexPropertyBase {
+
+public:
+  typedef typename Codec::Value Value;
+  enum { Components = N };
+
+  SimplexPropertyCompressed(SimplicialComplex& obj, size_t n, const Codec& codec)
+    : SimplexPropertyBase(obj), m_codec(codec), m_codes(Codec::Bits) { resize(n); }
+
+  virtual ~SimplexPropertyCompressed() {}
+
+  const Codec& codec() const { return m_codec; }
+
+  //Decode the values of slots [first, first+count) into out, N per slot (interleaved), and the reverse.
+  void decode(size_t first, size_t count, Value* out) const {
+    for(size_t i = first*N, end = (first + count)*N; i < end; ++i)
+      *out++ = m_codec.decode(m_codes.get(i));
+  }
+  void encode(size_t first, size_t count, const Value* in) {
+    for(size_t i = first*N, end = (first + count)*N; i < end; ++i)
+      m_codes.set(i, m_codec.encode(*in++));
+  }
+
+  void assign(const Value& data_value) {
+    unsigned int code = m_codec.encode(data_value);
+    for(size_t i = 0; i < m_codes.size(); ++i)
+      m_codes.set(i, code);
+  }
+
+protected:
+
+  size_t size() const { return m_codes.size() / N; }
+  void resize(size_t n) { m_codes.resize(n*N); }
+
+  void permute(const std::vector<int>& newToOld) {
+    PackedCodes permuted(Codec::Bits);
+    permuted.resize(newToOld.size()*N);
+    for(size_t i = 0; i < newToOld.size(); ++i)
+      for(unsigned int c = 0; c < N; ++c)
+        permuted.set(i*N + c, m_codes.get(newToOld[i]*N + c));
+    m_codes.swap(permuted);
+  }
+
+  void memoryUsage(size_t slots, size_t& used, size_t& reserved) const {
+    used = (slots*N*Codec::Bits + 7) / 8;
+    reserved = m_codes.memoryUsage();
+  }
+
+  Value get(int idx, unsigned int c) const {
+    assert(idx >= 0 && idx < (int)size() && c < N);
+    return m_codec.decode(m_codes.get(idx*N + c));
+  }
+  void set(int idx, unsigned int c, const Value& value) {
+    assert(idx >= 0 && idx < (int)size() && c < N);
+    m_codes.set(idx*N + c, m_codec.encode(value));
+  }
+
+  Codec m_codec;
+  PackedCodes m_codes;
+
+private:
+  SimplexPropertyCompressed& operator=(const SimplexPropertyCompressed&);
+};
+
+//Compressed properties for each simplex type. get/set take the component as an optional middle argument.
+template <class Codec, unsigned int N = 1>
+class VertexPropertyCompressed : public SimplexPropertyCompressed<Codec,N> {
+
+public:
+  typedef typename Codec::Value Value;
+
+  VertexPropertyCompressed(SimplicialComplex& obj, const Codec& codec = Codec())
+    : SimplexPropertyCompressed<Codec,N>(obj, obj.numVertexSlots(), codec) {
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  explicit VertexPropertyCompressed(const VertexPropertyCompressed& prop)
+    : SimplexPropertyCompressed<Codec,N>(prop.m_obj, 0, prop.m_codec) {
+    this->m_codes = prop.m_codes;
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  ~VertexPropertyCompressed() {
+    this->m_obj.removeVertexProperty(this);
+  }
+
+  //Number of vertex slots, the span length (in slots) covered by decode/encode.
+  size_t slots() const { return this->m_obj.numVertexSlots(); }
+
+  Value get(const VertexHandle& h, unsigned int c = 0) const { return SimplexPropertyCompressed<Codec,N>::get(h.idx(), c); }
+  void set(const VertexHandle& h, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), 0, value); }
+  void set(const VertexHandle& h, unsigned int c, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), c, value); }
+
+private:
+  VertexPropertyCompressed& operator=(const VertexPropertyCompressed&);
+};
+
+
+template <class Codec, unsigned int N = 1>
+class EdgePropertyCompressed : public SimplexPropertyCompressed<Codec,N> {
+
+public:
+  typedef typename Codec::Value Value;
+
+  EdgePropertyCompressed(SimplicialComplex& obj, const Codec& codec = Codec())
+    : SimplexPropertyCompressed<Codec,N>(obj, obj.numEdgeSlots(), codec) {
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  explicit EdgePropertyCompressed(const EdgePropertyCompressed& prop)
+    : SimplexPropertyCompressed<Codec,N>(prop.m_obj, 0, prop.m_codec) {
+    this->m_codes = prop.m_codes;
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  ~EdgePropertyCompressed() {
+    this->m_obj.removeEdgeProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numEdgeSlots(); }
+
+  Value get(const EdgeHandle& h, unsigned int c = 0) const { return SimplexPropertyCompressed<Codec,N>::get(h.idx(), c); }
+  void set(const EdgeHandle& h, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), 0, value); }
+  void set(const EdgeHandle& h, unsigned int c, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), c, value); }
+
+private:
+  EdgePropertyCompressed& operator=(const EdgePropertyCompressed&);
+};
+
+
+template <class Codec, unsigned int N = 1>
+class FacePropertyCompressed : public SimplexPropertyCompressed<Codec,N> {
+
+public:
+  typedef typename Codec::Value Value;
+
+  FacePropertyCompressed(SimplicialComplex& obj, const Codec& codec = Codec())
+    : SimplexPropertyCompressed<Codec,N>(obj, obj.numFaceSlots(), codec) {
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  explicit FacePropertyCompressed(const FacePropertyCompressed& prop)
+    : SimplexPropertyCompressed<Codec,N>(prop.m_obj, 0, prop.m_codec) {
+    this->m_codes = prop.m_codes;
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  ~FacePropertyCompressed() {
+    this->m_obj.removeFaceProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numFaceSlots(); }
+
+  Value get(const FaceHandle& h, unsigned int c = 0) const { return SimplexPropertyCompressed<Codec,N>::get(h.idx(), c); }
+  void set(const FaceHandle& h, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), 0, value); }
+  void set(const FaceHandle& h, unsigned int c, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), c, value); }
+
+private:
+  FacePropertyCompressed& operator=(const FacePropertyCompressed&);
+};
+
+
+template <class Codec, unsigned int N = 1>
+class TetPropertyCompressed : public SimplexPropertyCompressed<Codec,N> {
+
+public:
+  typedef typename Codec::Value Value;
+
+  TetPropertyCompressed(SimplicialComplex& obj, const Codec& codec = Codec())
+    : SimplexPropertyCompressed<Codec,N>(obj, obj.numTetSlots(), codec) {
+    this->m_obj.registerTetProperty(this);
+  }
+
+  explicit TetPropertyCompressed(const TetPropertyCompressed& prop)
+    : SimplexPropertyCompressed<Codec,N>(prop.m_obj, 0, prop.m_codec) {
+    this->m_codes = prop.m_codes;
+    this->m_obj.registerTetProperty(this);
+  }
+
+  ~TetPropertyCompressed() {
+    this->m_obj.removeTetProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numTetSlots(); }
+
+  Value get(const TetHandle& h, unsigned int c = 0) const { return SimplexPropertyCompressed<Codec,N>::get(h.idx(), c); }
+  void set(const TetHandle& h, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), 0, value); }
+  void set(const TetHandle& h, unsigned int c, const Value& value) { SimplexPropertyCompressed<Codec,N>::set(h.idx(), c, value); }
+
+private:
+  TetPropertyCompressed& operator=(const TetPropertyCompressed&);
+};
+
+}
+
+#endif
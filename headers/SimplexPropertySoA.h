@@ -0,0 +1,249 @@
+#ifndef SIMPLEXPROPERTYSOA_H
+#define SIMPLEXPROPERTYSOA_H
+
+#include "SimplicialComplex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+
+namespace SimplexMesh {
+
+//A growable array of plain values whose storage starts on a 64-byte (cache line / widest SIMD register) boundary.
+template <class T>
+class AlignedArray {
+
+public:
+  enum { Alignment = 64 };
+
+  AlignedArray() : m_raw(0), m_data(0), m_size(0), m_capacity(0) {}
+  AlignedArray(const AlignedArray& other) : m_raw(0), m_data(0), m_size(0), m_capacity(0) {
+    resize(other.m_size);
+    std::copy(other.m_data, other.m_data + m_size, m_data);
+  }
+  ~AlignedArray() { delete[] m_raw; }
+
+  AlignedArray& operator=(const AlignedArray& other) {
+    AlignedArray copy(other);
+    swap(copy);
+    return *this;
+  }
+
+  //New entries are value-initialized; shrinking keeps the allocation.
+  void resize(size_t n) {
+    if(n > m_capacity) {
+      char* raw = new char[n*sizeof(T) + Alignment - 1];
+      T* data = reinterpret_cast<T*>((reinterpret_cast<size_t>(raw) + Alignment - 1) & ~(size_t)(Alignment - 1));
+      std::copy(m_data, m_data + m_size, data);
+      delete[] m_raw;
+      m_raw = raw;
+      m_data = data;
+      m_capacity = n;
+    }
+    std::fill(m_data + std::min(m_size, n), m_data + n, T());
+    m_size = n;
+  }
+
+  void swap(AlignedArray& other) {
+    std::swap(m_raw, other.m_raw);
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_capacity, other.m_capacity);
+  }
+
+  T* data() { return m_data; }
+  const T* data() const { return m_data; }
+  size_t size() const { return m_size; }
+  size_t capacity() const { return m_capacity; }
+
+  T& operator[](size_t i) { return m_data[i]; }
+  const T& operator[](size_t i) const { return m_data[i]; }
+
+private:
+  char* m_raw;
+  T* m_data;
+  size_t m_size, m_capacity;
+};
+
+
+//A property with N components of type T per simplex, stored structure-of-arrays: component c of every simplex lies
+//in its own contiguous, 64-byte aligned array. Loops over one component at a time (e.g. x += dt*vx for each axis)
+//then stream through memory and can be vectorized.
+template <class T, unsigned int N>
+class SimplexPropertySoA : public SimplexPropertyBase {
+
+public:
+  SimplexPropertySoA(SimplicialComplex& obj, size_t n) : SimplexPropertyBase(obj) { resize(n); }
+
+  virtual ~SimplexPropertySoA() {}
+
+  enum { Components = N };
+
+  //The array of component c, indexed by simplex slot (see the slots() of each derived class for its useful length).
+  //Aligned to AlignedArray<T>::Alignment. Only valid until simplices are added or renumbered.
+  T* component(unsigned int c) { assert(c < N); return m_components[c].data(); }
+  const T* component(unsigned int c) const { assert(c < N); return m_components[c].data(); }
+
+  void assign(const T& data_value) {
+    for(unsigned int c = 0; c < N; ++c)
+      std::fill(m_components[c].data(), m_components[c].data() + m_components[c].size(), data_value);
+  }
+
+protected:
+
+  size_t size() const { return m_components[0].size(); }
+  void resize(size_t n) {
+    for(unsigned int c = 0; c < N; ++c)
+      m_components[c].resize(n);
+  }
+
+  void permute(const std::vector<int>& newToOld) {
+    for(unsigned int c = 0; c < N; ++c) {
+      AlignedArray<T> permuted;
+      permuted.resize(newToOld.size());
+      for(unsigned int i = 0; i < newToOld.size(); ++i)
+        permuted[i] = m_components[c][newToOld[i]];
+      m_components[c].swap(permuted);
+    }
+  }
+
+  void memoryUsage(size_t slots, size_t& used, size_t& reserved) const {
+    used = N*slots*sizeof(T);
+    reserved = N*(m_components[0].capacity()*sizeof(T) + AlignedArray<T>::Alignment - 1);
+  }
+
+  T& at(int idx, unsigned int c) {
+    assert(idx >= 0 && idx < (int)size() && c < N);
+    return m_components[c][idx];
+  }
+  const T& at(int idx, unsigned int c) const {
+    assert(idx >= 0 && idx < (int)size() && c < N);
+    return m_components[c][idx];
+  }
+
+  AlignedArray<T> m_components[N];
+
+private:
+  SimplexPropertySoA& operator=(const SimplexPropertySoA&);
+};
+
+//Structure-of-arrays properties for each simplex type. Entries are addressed as prop(handle, component).
+template <class T, unsigned int N>
+class VertexPropertySoA : public SimplexPropertySoA<T,N> {
+
+public:
+
+  VertexPropertySoA(SimplicialComplex& obj) : SimplexPropertySoA<T,N>(obj, obj.numVertexSlots()) {
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  explicit VertexPropertySoA(const VertexPropertySoA& prop) : SimplexPropertySoA<T,N>(prop.m_obj, 0) {
+    for(unsigned int c = 0; c < N; ++c)
+      this->m_components[c] = prop.m_components[c];
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  ~VertexPropertySoA() {
+    this->m_obj.removeVertexProperty(this);
+  }
+
+  //Number of vertex slots, i.e. the useful length of each component array.
+  size_t slots() const { return this->m_obj.numVertexSlots(); }
+
+  T& operator() (const VertexHandle& h, unsigned int c) { return this->at(h.idx(), c); }
+  T const& operator() (const VertexHandle& h, unsigned int c) const { return this->at(h.idx(), c); }
+
+private:
+  VertexPropertySoA& operator=(const VertexPropertySoA&);
+};
+
+
+template <class T, unsigned int N>
+class EdgePropertySoA : public SimplexPropertySoA<T,N> {
+
+public:
+
+  EdgePropertySoA(SimplicialComplex& obj) : SimplexPropertySoA<T,N>(obj, obj.numEdgeSlots()) {
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  explicit EdgePropertySoA(const EdgePropertySoA& prop) : SimplexPropertySoA<T,N>(prop.m_obj, 0) {
+    for(unsigned int c = 0; c < N; ++c)
+      this->m_components[c] = prop.m_components[c];
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  ~EdgePropertySoA() {
+    this->m_obj.removeEdgeProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numEdgeSlots(); }
+
+  T& operator() (const EdgeHandle& h, unsigned int c) { return this->at(h.idx(), c); }
+  T const& operator() (const EdgeHandle& h, unsigned int c) const { return this->at(h.idx(), c); }
+
+private:
+  EdgePropertySoA& operator=(const EdgePropertySoA&);
+};
+
+
+template <class T, unsigned int N>
+class FacePropertySoA : public SimplexPropertySoA<T,N> {
+
+public:
+
+  FacePropertySoA(SimplicialComplex& obj) : SimplexPropertySoA<T,N>(obj, obj.numFaceSlots()) {
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  explicit FacePropertySoA(const FacePropertySoA& prop) : SimplexPropertySoA<T,N>(prop.m_obj, 0) {
+    for(unsigned int c = 0; c < N; ++c)
+      this->m_components[c] = prop.m_components[c];
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  ~FacePropertySoA() {
+    this->m_obj.removeFaceProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numFaceSlots(); }
+
+  T& operator() (const FaceHandle& h, unsigned int c) { return this->at(h.idx(), c); }
+  T const& operator() (const FaceHandle& h, unsigned int c) const { return this->at(h.idx(), c); }
+
+private:
+  FacePropertySoA& operator=(const FacePropertySoA&);
+};
+
+
+template <class T, unsigned int N>
+class TetPropertySoA : public SimplexPropertySoA<T,N> {
+
+public:
+
+  TetPropertySoA(SimplicialComplex& obj) : SimplexPropertySoA<T,N>(obj, obj.numTetSlots()) {
+    this->m_obj.registerTetProperty(this);
+  }
+
+  explicit TetPropertySoA(const TetPropertySoA& prop) : SimplexPropertySoA<T,N>(prop.m_obj, 0) {
+    for(unsigned int c = 0; c < N; ++c)
+      this->m_components[c] = prop.m_components[c];
+    this->m_obj.registerTetProperty(this);
+  }
+
+  ~TetPropertySoA() {
+    this->m_obj.removeTetProperty(this);
+  }
+
+  size_t slots() const { return this->m_obj.numTetSlots(); }
+
+  T& operator() (const TetHandle& h, unsigned int c) { return this->at(h.idx(), c); }
+  T const& operator() (const TetHandle& h, unsigned int c) const { return this->at(h.idx(), c); }
+
+private:
+  TetPropertySoA& operator=(const TetPropertySoA&);
+};
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef SIMPLEXPROPERTYSPARSE_H
+#define SIMPLEXPROPERTYSPARSE_H
+
+#include "SimplicialComplex.h"
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace SimplexMesh {
+
+//Values attached to some of the slots of a simplex type. Entries (slot and value) are packed back to back, in
+//insertion order with swap-removal, so iterating over them touches nothing else; an open-addressed table maps
+//slots to their position in the packed array.
+template <class T>
+class SparseSlotMap {
+
+public:
+  SparseSlotMap() {}
+
+  size_t size() const { return m_entries.size(); }
+  unsigned int slotAt(size_t k) const { return m_entries[k].slot; }
+  T& valueAt(size_t k) { return m_entries[k].value; }
+  const T& valueAt(size_t k) const { return m_entries[k].value; }
+
+  //Position of the slot's entry, or -1
+  int find(unsigned int slot) const {
+    if(m_table.empty())
+      return -1;
+    for(unsigned int b = bucket(slot); m_table[b] >= 0; b = (b+1) & mask())
+      if(m_entries[m_table[b]].slot == slot)
+        return m_table[b];
+    return -1;
+  }
+
+  //The slot's value, added (default constructed) if it isn't there yet
+  T& insert(unsigned int slot) {
+    int pos = find(slot);
+    if(pos >= 0)
+      return m_entries[pos].value;
+
+    if(2*(m_entries.size()+1) > m_table.size())
+      rehash(std::max<size_t>(16, 2*m_table.size()));
+    unsigned int b = bucket(slot);
+    while(m_table[b] >= 0)
+      b = (b+1) & mask();
+    m_table[b] = (int)m_entries.size();
+    m_entries.push_back(Entry(slot));
+    return m_entries.back().value;
+  }
+
+  bool erase(unsigned int slot) {
+    if(m_table.empty())
+      return false;
+    unsigned int b = bucket(slot);
+    for(; m_table[b] >= 0 && m_entries[m_table[b]].slot != slot; b = (b+1) & mask()) {}
+    if(m_table[b] < 0)
+      return false;
+    int pos = m_table[b];
+
+    //shift later entries of the probe run back into the hole
+    unsigned int hole = b;
+    for(unsigned int next = (hole+1) & mask(); m_table[next] >= 0; next = (next+1) & mask()) {
+      unsigned int home = bucket(m_entries[m_table[next]].slot);
+      if(((next - home) & mask()) >= ((next - hole) & mask())) {
+        m_table[hole] = m_table[next];
+        hole = next;
+      }
+    }
+    m_table[hole] = -1;
+
+    //move the last entry into the vacated position
+    int last = (int)m_entries.size() - 1;
+    if(pos != last) {
+      unsigned int lb = bucket(m_entries[last].slot);
+      while(m_table[lb] != last)
+        lb = (lb+1) & mask();
+      m_table[lb] = pos;
+      m_entries[pos] = m_entries[last];
+    }
+    m_entries.pop_back();
+    return true;
+  }
+
+  void clear() {
+    m_entries.clear();
+    std::vector<int>().swap(m_table);
+  }
+
+  //Renumber the slots: entries on slots mapped to -1 are dropped
+  void remap(const std::vector<int>& oldToNew) {
+    std::vector<Entry> entries;
+    entries.swap(m_entries);
+    clear();
+    for(size_t k = 0; k < entries.size(); ++k)
+      if(entries[k].slot < oldToNew.size() && oldToNew[entries[k].slot] >= 0)
+        insert(oldToNew[entries[k].slot]) = entries[k].value;
+  }
+
+  void swap(SparseSlotMap& other) {
+    m_entries.swap(other.m_entries);
+    m_table.swap(other.m_table);
+  }
+
+  size_t memoryUsed() const { return m_entries.size()*sizeof(Entry) + m_table.size()*sizeof(int); }
+  size_t memoryUsage() const { return m_entries.capacity()*sizeof(Entry) + m_table.capacity()*sizeof(int); }
+
+private:
+  struct Entry {
+    unsigned int slot;
+    T value;
+    explicit Entry(unsigned int s) : slot(s), value() {}
+  };
+
+  unsigned int mask() const { return (unsigned int)m_table.size() - 1; }
+  unsigned int bucket(unsigned int slot) const {
+    unsigned int h = slot * 2654435761u;
+    return (h ^ (h >> 16)) & mask();
+  }
+
+  void rehash(size_t size) {
+    m_table.assign(size, -1);
+    for(size_t k = 0; k < m_entries.size(); ++k) {
+      unsigned int b = bucket(m_entries[k].slot);
+      while(m_table[b] >= 0)
+        b = (b+1) & mask();
+      m_table[b] = (int)k;
+    }
+  }
+
+  std::vector<Entry> m_entries;
+  std::vector<int> m_table; //positions in m_entries, -1 when empty
+};
+
+
+//A property holding values for only some simplices, e.g. flags on the boundary faces. Storage is proportional to the
+//number of entries rather than to the mesh. Entries are dropped automatically when their simplex is deleted, and are
+//carried along when the complex is renumbered.
+template <class T>
+class SimplexPropertySparse : public SimplexPropertyBase {
+
+public:
+  SimplexPropertySparse(SimplicialComplex& obj) : SimplexPropertyBase(obj), m_size(0) { listenToSlots(true); }
+
+  virtual ~SimplexPropertySparse() {}
+
+  //Number of populated entries; entry k (in no particular order) is valueAt(k), on the simplex given by the
+  //derived class's handleAt(k). Adding or erasing entries reorders them.
+  size_t count() const { return m_map.size(); }
+  T& valueAt(size_t k) { return m_map.valueAt(k); }
+  const T& valueAt(size_t k) const { return m_map.valueAt(k); }
+
+  void clear() { m_map.clear(); }
+
+protected:
+
+  size_t size() const { return m_size; }
+  void resize(size_t n) {
+    //drop anything on slots that no longer exist
+    if(n < m_size) {
+      for(size_t k = m_map.size(); k-- > 0; )
+        if(m_map.slotAt(k) >= n) m_map.erase(m_map.slotAt(k));
+    }
+    m_size = n;
+  }
+
+  void permute(const std::vector<int>& newToOld) {
+    std::vector<int> oldToNew(m_size, -1);
+    for(unsigned int i = 0; i < newToOld.size(); ++i)
+      oldToNew[newToOld[i]] = i;
+    m_map.remap(oldToNew);
+    m_size = newToOld.size();
+  }
+
+  void simplexDeleted(unsigned int slot) { m_map.erase(slot); }
+
+  void memoryUsage(size_t /*slots*/, size_t& used, size_t& reserved) const {
+    used = m_map.memoryUsed();
+    reserved = m_map.memoryUsage();
+  }
+
+  SparseSlotMap<T> m_map;
+  size_t m_size; //slots of the simplex type (as for dense properties)
+
+private:
+  SimplexPropertySparse& operator=(const SimplexPropertySparse&);
+};
+
+//Sparse properties for each simplex type. operator[] adds an entry when there is none; find() and contains() look
+//without adding.
+template <class T>
+class VertexPropertySparse : public SimplexPropertySparse<T> {
+
+public:
+
+  VertexPropertySparse(SimplicialComplex& obj) : SimplexPropertySparse<T>(obj) {
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  explicit VertexPropertySparse(const VertexPropertySparse& prop) : SimplexPropertySparse<T>(prop.m_obj) {
+    this->m_map = prop.m_map;
+    this->m_obj.registerVertexProperty(this);
+  }
+
+  ~VertexPropertySparse() {
+    this->m_obj.removeVertexProperty(this);
+  }
+
+  T& operator[] (const VertexHandle& h) { assert(this->m_obj.vertexExists(h)); return this->m_map.insert(h.idx()); }
+  T* find(const VertexHandle& h) { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  const T* find(const VertexHandle& h) const { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  bool contains(const VertexHandle& h) const { return this->m_map.find(h.idx()) >= 0; }
+  bool erase(const VertexHandle& h) { return this->m_map.erase(h.idx()); }
+
+  VertexHandle handleAt(size_t k) const { return VertexHandle(this->m_map.slotAt(k)); }
+
+private:
+  VertexPropertySparse& operator=(const VertexPropertySparse&);
+};
+
+
+template <class T>
+class EdgePropertySparse : public SimplexPropertySparse<T> {
+
+public:
+
+  EdgePropertySparse(SimplicialComplex& obj) : SimplexPropertySparse<T>(obj) {
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  explicit EdgePropertySparse(const EdgePropertySparse& prop) : SimplexPropertySparse<T>(prop.m_obj) {
+    this->m_map = prop.m_map;
+    this->m_obj.registerEdgeProperty(this);
+  }
+
+  ~EdgePropertySparse() {
+    this->m_obj.removeEdgeProperty(this);
+  }
+
+  T& operator[] (const EdgeHandle& h) { assert(this->m_obj.edgeExists(h)); return this->m_map.insert(h.idx()); }
+  T* find(const EdgeHandle& h) { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  const T* find(const EdgeHandle& h) const { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  bool contains(const EdgeHandle& h) const { return this->m_map.find(h.idx()) >= 0; }
+  bool erase(const EdgeHandle& h) { return this->m_map.erase(h.idx()); }
+
+  EdgeHandle handleAt(size_t k) const { return EdgeHandle(this->m_map.slotAt(k)); }
+
+private:
+  EdgePropertySparse& operator=(const EdgePropertySparse&);
+};
+
+
+template <class T>
+class FacePropertySparse : public SimplexPropertySparse<T> {
+
+public:
+
+  FacePropertySparse(SimplicialComplex& obj) : SimplexPropertySparse<T>(obj) {
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  explicit FacePropertySparse(const FacePropertySparse& prop) : SimplexPropertySparse<T>(prop.m_obj) {
+    this->m_map = prop.m_map;
+    this->m_obj.registerFaceProperty(this);
+  }
+
+  ~FacePropertySparse() {
+    this->m_obj.removeFaceProperty(this);
+  }
+
+  T& operator[] (const FaceHandle& h) { assert(this->m_obj.faceExists(h)); return this->m_map.insert(h.idx()); }
+  T* find(const FaceHandle& h) { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  const T* find(const FaceHandle& h) const { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  bool contains(const FaceHandle& h) const { return this->m_map.find(h.idx()) >= 0; }
+  bool erase(const FaceHandle& h) { return this->m_map.erase(h.idx()); }
+
+  FaceHandle handleAt(size_t k) const { return FaceHandle(this->m_map.slotAt(k)); }
+
+private:
+  FacePropertySparse& operator=(const FacePropertySparse&);
+};
+
+
+template <class T>
+class TetPropertySparse : public SimplexPropertySparse<T> {
+
+public:
+
+  TetPropertySparse(SimplicialComplex& obj) : SimplexPropertySparse<T>(obj) {
+    this->m_obj.registerTetProperty(this);
+  }
+
+  explicit TetPropertySparse(const TetPropertySparse& prop) : SimplexPropertySparse<T>(prop.m_obj) {
+    this->m_map = prop.m_map;
+    this->m_obj.registerTetProperty(this);
+  }
+
+  ~TetPropertySparse() {
+    this->m_obj.removeTetProperty(this);
+  }
+
+  T& operator[] (const TetHandle& h) { assert(this->m_obj.tetExists(h)); return this->m_map.insert(h.idx()); }
+  T* find(const TetHandle& h) { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  const T* find(const TetHandle& h) const { int k = this->m_map.find(h.idx()); return k >= 0 ? &this->m_map.valueAt(k) : 0; }
+  bool contains(const TetHandle& h) const { return this->m_map.find(h.idx()) >= 0; }
+  bool erase(const TetHandle& h) { return this->m_map.erase(h.idx()); }
+
+  TetHandle handleAt(size_t k) const { return TetHandle(this->m_map.slotAt(k)); }
+
+private:
+  TetPropertySparse& operator=(const TetPropertySparse&);
+};
+
+}
+
+#endif
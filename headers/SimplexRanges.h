@@ -0,0 +1,298 @@
+#ifndef SIMPLEXRANGES_H
+#define SIMPLEXRANGES_H
+
+#include "SimplicialComplex.h"
+#include "SimplexIterators.h"
+
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+namespace SimplexMesh {
+
+//STL-style ranges over the same traversals as the iterators in SimplexIterators.h, for range-based for loops and the
+//standard algorithms:
+//   for(auto th : mesh.tets()) ...
+//   for(auto eh : mesh.vertexEdges(vh)) ...
+//Adjacency ranges are random access. The ones backed by a single incidence row (vertexEdges, vertexVertices, edgeVertices,
+//edgeFaces, faceEdges, faceTets, tetFaces) read it in place; the others gather their simplices when created, in the same
+//order as the corresponding iterator. Global ranges skip dead slots, so they are only forward ranges; handles() collects
+//them into a vector for algorithms that need random access, such as those taking a parallel execution policy:
+//   std::vector<TetHandle> tets = mesh.tets().handles();
+//   std::for_each(std::execution::par, tets.begin(), tets.end(), ...);
+//Ranges and their iterators only read the complex, so any number of threads can use them while it isn't being edited.
+//Iterators dereference to handles by value, and point into their range, which must outlive them.
+
+
+//Raw access to the storage of one simplex type, for the ranges below.
+template<class Handle> struct SimplexTraits;
+
+template<> struct SimplexTraits<VertexHandle> {
+   static VertexHandle handle(int idx) { return VertexHandle(idx); }
+   static int index(const VertexHandle& h) { return h.idx(); }
+   static unsigned int slots(const SimplicialComplex& obj) { return obj.numVertexSlots(); }
+   static const OccupancyBitmap& live(const SimplicialComplex& obj) { return obj.m_V; }
+   static const IncidenceMatrix& up(const SimplicialComplex& obj) { return obj.m_VE; }
+};
+
+template<> struct SimplexTraits<EdgeHandle> {
+   static EdgeHandle handle(int idx) { return EdgeHandle(idx); }
+   static int index(const EdgeHandle& h) { return h.idx(); }
+   static unsigned int slots(const SimplicialComplex& obj) { return obj.numEdgeSlots(); }
+   static const OccupancyBitmap& live(const SimplicialComplex& obj) { return obj.m_E; }
+   static const FixedIncidenceMatrix<2>& down(const SimplicialComplex& obj) { return obj.m_EV; }
+   static const IncidenceMatrix& up(const SimplicialComplex& obj) { return obj.m_EF; }
+};
+
+template<> struct SimplexTraits<FaceHandle> {
+   static FaceHandle handle(int idx) { return FaceHandle(idx); }
+   static int index(const FaceHandle& h) { return h.idx(); }
+   static unsigned int slots(const SimplicialComplex& obj) { return obj.numFaceSlots(); }
+   static const OccupancyBitmap& live(const SimplicialComplex& obj) { return obj.m_F; }
+   static const FixedIncidenceMatrix<3>& down(const SimplicialComplex& obj) { return obj.m_FE; }
+   static const IncidenceMatrix& up(const SimplicialComplex& obj) { return obj.m_FT; }
+};
+
+template<> struct SimplexTraits<TetHandle> {
+   static TetHandle handle(int idx) { return TetHandle(idx); }
+   static int index(const TetHandle& h) { return h.idx(); }
+   static unsigned int slots(const SimplicialComplex& obj) { return obj.numTetSlots(); }
+   static const OccupancyBitmap& live(const SimplicialComplex& obj) { return obj.m_T; }
+   static const FixedIncidenceMatrix<4>& down(const SimplicialComplex& obj) { return obj.m_TF; }
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+//Global ranges
+
+//The live simplices of one type, in slot order.
+template<class Handle>
+class SimplexRange {
+public:
+   typedef Handle value_type;
+
+   class const_iterator {
+   public:
+      typedef std::forward_iterator_tag iterator_category;
+      typedef Handle value_type;
+      typedef std::ptrdiff_t difference_type;
+      typedef const Handle* pointer;
+      typedef Handle reference;
+
+      const_iterator() : m_obj(0), m_idx(0), m_slots(0) {}
+      const_iterator(const SimplicialComplex& obj, unsigned int idx) : m_obj(&obj), m_idx(idx), m_slots(SimplexTraits<Handle>::slots(obj)) {
+         skipDead();
+      }
+
+      Handle operator*() const { return SimplexTraits<Handle>::handle(m_idx); }
+      const_iterator& operator++() { ++m_idx; skipDead(); return *this; }
+      const_iterator operator++(int) { const_iterator old(*this); ++*this; return old; }
+
+      bool operator==(const const_iterator& other) const { return m_idx == other.m_idx; }
+      bool operator!=(const const_iterator& other) const { return m_idx != other.m_idx; }
+
+   private:
+      void skipDead() {
+         if(m_idx >= m_slots)
+            return;
+         size_t next = SimplexTraits<Handle>::live(*m_obj).findNext(m_idx);
+         m_idx = next == OccupancyBitmap::npos ? m_slots : (unsigned int)next;
+      }
+
+      const SimplicialComplex* m_obj;
+      unsigned int m_idx, m_slots;
+   };
+   typedef const_iterator iterator;
+
+   explicit SimplexRange(const SimplicialComplex& obj) : m_obj(&obj) {}
+
+   const_iterator begin() const { return const_iterator(*m_obj, 0); }
+   const_iterator end() const { return const_iterator(*m_obj, SimplexTraits<Handle>::slots(*m_obj)); }
+
+   //The live handles, gathered for random access.
+   std::vector<Handle> handles() const {
+      std::vector<Handle> result;
+      for(const_iterator it = begin(), last = end(); it != last; ++it)
+         result.push_back(*it);
+      return result;
+   }
+
+private:
+   const SimplicialComplex* m_obj;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+//Adjacency ranges
+
+//Random access iterator over any range offering size() and operator[].
+template<class Range>
+class RangeIterator {
+public:
+   typedef std::random_access_iterator_tag iterator_category;
+   typedef typename Range::value_type value_type;
+   typedef std::ptrdiff_t difference_type;
+   typedef const value_type* pointer;
+   typedef value_type reference;
+
+   RangeIterator() : m_range(0), m_k(0) {}
+   RangeIterator(const Range* range, difference_type k) : m_range(range), m_k(k) {}
+
+   value_type operator*() const { return (*m_range)[(unsigned int)m_k]; }
+   value_type operator[](difference_type n) const { return (*m_range)[(unsigned int)(m_k + n)]; }
+
+   RangeIterator& operator++() { ++m_k; return *this; }
+   RangeIterator& operator--() { --m_k; return *this; }
+   RangeIterator operator++(int) { RangeIterator old(*this); ++m_k; return old; }
+   RangeIterator operator--(int) { RangeIterator old(*this); --m_k; return old; }
+   RangeIterator& operator+=(difference_type n) { m_k += n; return *this; }
+   RangeIterator& operator-=(difference_type n) { m_k -= n; return *this; }
+   RangeIterator operator+(difference_type n) const { return RangeIterator(m_range, m_k + n); }
+   RangeIterator operator-(difference_type n) const { return RangeIterator(m_range, m_k - n); }
+   difference_type operator-(const RangeIterator& other) const { return m_k - other.m_k; }
+
+   bool operator==(const RangeIterator& other) const { return m_k == other.m_k; }
+   bool operator!=(const RangeIterator& other) const { return m_k != other.m_k; }
+   bool operator<(const RangeIterator& other) const { return m_k < other.m_k; }
+   bool operator>(const RangeIterator& other) const { return m_k > other.m_k; }
+   bool operator<=(const RangeIterator& other) const { return m_k <= other.m_k; }
+   bool operator>=(const RangeIterator& other) const { return m_k >= other.m_k; }
+
+private:
+   const Range* m_range;
+   difference_type m_k;
+};
+
+template<class Range>
+RangeIterator<Range> operator+(typename RangeIterator<Range>::difference_type n, const RangeIterator<Range>& it) { return it + n; }
+
+
+//The incidence rows behind the row-backed adjacency ranges: the entries of row idx of the source's upward or downward matrix.
+template<class Source, class Target>
+struct UpwardRows {
+   typedef Source source_type;
+   typedef Target value_type;
+   static unsigned int count(const SimplicialComplex& obj, int idx) { return SimplexTraits<Source>::up(obj).getNumEntriesInRow(idx); }
+   static int at(const SimplicialComplex& obj, int idx, unsigned int k) { return SimplexTraits<Source>::up(obj).getColByIndex(idx, k); }
+};
+
+template<class Source, class Target>
+struct DownwardRows {
+   typedef Source source_type;
+   typedef Target value_type;
+   static unsigned int count(const SimplicialComplex& obj, int idx) { return SimplexTraits<Source>::down(obj).getNumEntriesInRow(idx); }
+   static int at(const SimplicialComplex& obj, int idx, unsigned int k) { return SimplexTraits<Source>::down(obj).getColByIndex(idx, k); }
+};
+
+struct VertexEdgeRows : UpwardRows<VertexHandle, EdgeHandle> {};
+struct EdgeFaceRows : UpwardRows<EdgeHandle, FaceHandle> {};
+struct FaceTetRows : UpwardRows<FaceHandle, TetHandle> {};
+struct EdgeVertexRows : DownwardRows<EdgeHandle, VertexHandle> {};
+struct FaceEdgeRows : DownwardRows<FaceHandle, EdgeHandle> {};
+struct TetFaceRows : DownwardRows<TetHandle, FaceHandle> {};
+
+//The far end of each edge at the vertex
+struct VertexVertexRows : VertexEdgeRows {
+   typedef VertexHandle value_type;
+   static int at(const SimplicialComplex& obj, int idx, unsigned int k) {
+      const FixedIncidenceMatrix<2>& EV = SimplexTraits<EdgeHandle>::down(obj);
+      int edge = VertexEdgeRows::at(obj, idx, k);
+      int vert = EV.getColByIndex(edge, 0);
+      return vert == idx ? (int)EV.getColByIndex(edge, 1) : vert;
+   }
+};
+
+//The simplices in one incidence row. The row is read in place, so the range is only good until the simplex is edited.
+template<class Rows>
+class AdjacencyRange {
+public:
+   typedef typename Rows::value_type value_type;
+   typedef RangeIterator<AdjacencyRange> const_iterator;
+   typedef const_iterator iterator;
+
+   AdjacencyRange(const SimplicialComplex& obj, const typename Rows::source_type& h) :
+      m_obj(&obj), m_idx(SimplexTraits<typename Rows::source_type>::index(h)), m_size(Rows::count(obj, m_idx)) {}
+
+   unsigned int size() const { return m_size; }
+   bool empty() const { return m_size == 0; }
+   value_type operator[](unsigned int k) const { return SimplexTraits<value_type>::handle(Rows::at(*m_obj, m_idx, k)); }
+
+   const_iterator begin() const { return const_iterator(this, 0); }
+   const_iterator end() const { return const_iterator(this, m_size); }
+
+private:
+   const SimplicialComplex* m_obj;
+   int m_idx;
+   unsigned int m_size;
+};
+
+//The simplices visited by one of the gathering iterators (VertexFaceIterator & co.), copied out when the range is created.
+template<class Handle>
+class GatheredRange {
+public:
+   typedef Handle value_type;
+   typedef RangeIterator<GatheredRange> const_iterator;
+   typedef const_iterator iterator;
+
+   template<class Traversal>
+   explicit GatheredRange(Traversal& it) {
+      for(; !it.done(); it.advance())
+         m_list.push_back(SimplexTraits<Handle>::index(it.current()));
+   }
+
+   unsigned int size() const { return m_list.size(); }
+   bool empty() const { return m_list.size() == 0; }
+   Handle operator[](unsigned int k) const { return SimplexTraits<Handle>::handle(m_list[k]); }
+
+   const_iterator begin() const { return const_iterator(this, 0); }
+   const_iterator end() const { return const_iterator(this, m_list.size()); }
+
+private:
+   SmallIndexList m_list;
+};
+
+
+//////////////////////////////////////////////////////////////////////////
+//SimplicialComplex range functions
+
+inline SimplexRange<VertexHandle> SimplicialComplex::vertices() const { return SimplexRange<VertexHandle>(*this); }
+inline SimplexRange<EdgeHandle> SimplicialComplex::edges() const { return SimplexRange<EdgeHandle>(*this); }
+inline SimplexRange<FaceHandle> SimplicialComplex::faces() const { return SimplexRange<FaceHandle>(*this); }
+inline SimplexRange<TetHandle> SimplicialComplex::tets() const { return SimplexRange<TetHandle>(*this); }
+
+inline AdjacencyRange<VertexEdgeRows> SimplicialComplex::vertexEdges(const VertexHandle& vh) const { return AdjacencyRange<VertexEdgeRows>(*this, vh); }
+inline AdjacencyRange<VertexVertexRows> SimplicialComplex::vertexVertices(const VertexHandle& vh) const { return AdjacencyRange<VertexVertexRows>(*this, vh); }
+inline AdjacencyRange<EdgeVertexRows> SimplicialComplex::edgeVertices(const EdgeHandle& eh) const { return AdjacencyRange<EdgeVertexRows>(*this, eh); }
+inline AdjacencyRange<EdgeFaceRows> SimplicialComplex::edgeFaces(const EdgeHandle& eh) const { return AdjacencyRange<EdgeFaceRows>(*this, eh); }
+inline AdjacencyRange<FaceEdgeRows> SimplicialComplex::faceEdges(const FaceHandle& fh) const { return AdjacencyRange<FaceEdgeRows>(*this, fh); }
+inline AdjacencyRange<FaceTetRows> SimplicialComplex::faceTets(const FaceHandle& fh) const { return AdjacencyRange<FaceTetRows>(*this, fh); }
+inline AdjacencyRange<TetFaceRows> SimplicialComplex::tetFaces(const TetHandle& th) const { return AdjacencyRange<TetFaceRows>(*this, th); }
+
+inline GatheredRange<FaceHandle> SimplicialComplex::vertexFaces(const VertexHandle& vh) const {
+   VertexFaceIterator it(*this, vh);
+   return GatheredRange<FaceHandle>(it);
+}
+inline GatheredRange<TetHandle> SimplicialComplex::vertexTets(const VertexHandle& vh) const {
+   VertexTetIterator it(*this, vh);
+   return GatheredRange<TetHandle>(it);
+}
+inline GatheredRange<TetHandle> SimplicialComplex::edgeTets(const EdgeHandle& eh) const {
+   EdgeTetIterator it(*this, eh);
+   return GatheredRange<TetHandle>(it);
+}
+inline GatheredRange<VertexHandle> SimplicialComplex::faceVertices(const FaceHandle& fh, bool ordered) const {
+   FaceVertexIterator it(*this, fh, ordered);
+   return GatheredRange<VertexHandle>(it);
+}
+inline GatheredRange<VertexHandle> SimplicialComplex::tetVertices(const TetHandle& th) const {
+   TetVertexIterator it(*this, th);
+   return GatheredRange<VertexHandle>(it);
+}
+inline GatheredRange<EdgeHandle> SimplicialComplex::tetEdges(const TetHandle& th) const {
+   TetEdgeIterator it(*this, th);
+   return GatheredRange<EdgeHandle>(it);
+}
+
+} // namespace SimplexMesh
+
+#endif // SIMPLEXRANGES_H
@@ -5,10 +5,68 @@
 
 #include "SimplexHandles.h"
 #include "IncidenceMatrix.h"
+#include "FixedIncidenceMatrix.h"
+#include "SimplexIndex.h"
+#include "OccupancyBitmap.h"
+#include "AdjacencyCache.h"
 
 namespace SimplexMesh {
 
    class SimplexPropertyBase;
+   class SmallIndexList;
+   class CompactComplex;
+   template<class T> class VertexProperty;
+
+   //Ranges for range-based for loops and STL algorithms (see SimplexRanges.h)
+   template<class Handle> class SimplexRange;
+   template<class Rows> class AdjacencyRange;
+   template<class Handle> class GatheredRange;
+   struct VertexEdgeRows; struct VertexVertexRows; struct EdgeVertexRows; struct EdgeFaceRows;
+   struct FaceEdgeRows; struct FaceTetRows; struct TetFaceRows;
+
+   //Old-to-new index tables, as produced by operations that renumber simplices (see SimplicialComplex::compact).
+   //Slots that no longer exist map to -1, so stale handles come back invalid.
+   class SimplexRemap {
+   public:
+      std::vector<int> verts, edges, faces, tets;
+
+      VertexHandle operator()(const VertexHandle& vh) const { return VertexHandle(lookup(verts, vh.idx())); }
+      EdgeHandle operator()(const EdgeHandle& eh) const { return EdgeHandle(lookup(edges, eh.idx())); }
+      FaceHandle operator()(const FaceHandle& fh) const { return FaceHandle(lookup(faces, fh.idx())); }
+      TetHandle operator()(const TetHandle& th) const { return TetHandle(lookup(tets, th.idx())); }
+
+   private:
+      static int lookup(const std::vector<int>& table, int idx) {
+         return (idx >= 0 && idx < (int)table.size()) ? table[idx] : -1;
+      }
+   };
+
+   //Storage statistics of a SimplicialComplex, as gathered by SimplicialComplex::memoryReport.
+   class MemoryReport {
+   public:
+      //Bytes in use and bytes allocated by one piece of storage
+      struct Block {
+         const char* name;
+         size_t used, reserved;
+      };
+
+      std::vector<Block> matrices;   //the six incidence matrices and the occupancy bitmaps
+      std::vector<Block> properties; //registered properties, named by simplex type, in registration order
+      std::vector<Block> deadPools;  //lists of dead slots awaiting reuse, per simplex type
+      std::vector<Block> indices;    //the lookup index (if enabled) and any adjacency caches built so far
+
+      //Live and dead slots per dimension (0 = vertices, ..., 3 = tets)
+      unsigned int liveSlots[4], deadSlots[4];
+
+      //Row-length histograms of the upward matrices VE, EF and FT: rowLengths[d][k] is the number of rows of
+      //dimension d with k entries. Only filled in on request, since it takes a pass over the rows.
+      std::vector<unsigned int> rowLengths[3];
+
+      size_t totalUsed() const;
+      size_t totalReserved() const;
+
+      void print() const;
+   };
 
    // An object that represents a collection of vertices, edges, faces and tets
    // with associated connectivity information.
@@ -21,11 +79,54 @@ namespace SimplexMesh {
       //Whether to perform potentially expensive safety checks (duplicates, validity) when constructing the mesh.
       void setSafeMode(bool safe) { m_safetyChecks = safe; }
 
+      //Whether to keep the upward (coboundary) relations sorted, so incidence lookups and removals on
+      //high-valence simplices use binary search. The order in which upward neighbours are visited changes accordingly.
+      void setSortedAdjacency(bool sorted) {
+         m_VE.setSortedRows(sorted);
+         m_EF.setSortedRows(sorted);
+         m_FT.setSortedRows(sorted);
+      }
+
+      //Whether to maintain a hash index from (sorted) vertex tuples to the edges, faces and tets that span them.
+      //It is updated by every addition, deletion and editing operation, and turns getEdge/getFace/getTet and the
+      //duplicate tests of safe mode into constant-time lookups rather than neighbourhood scans. Enabling it indexes
+      //the existing simplices; disabling it frees the index.
+      void setLookupIndex(bool enabled);
+      bool hasLookupIndex() const { return m_indexed; }
+
+      //Derived adjacency caches: the vertex-tet, edge-tet, tet-tet (across faces) and vertex-vertex relations stored as
+      //flat rows, read through CachedVertexTetIterator, CachedEdgeTetIterator, TetTetIterator and CachedVertexVertexIterator.
+      //Each is built the first time it is read, and from then on follows edits: the rows around added, deleted and
+      //collapsed simplices are regathered when next read, and the whole relation is rebuilt once much of it has changed.
+      //Since this happens inside const reads, call updateAdjacencyCaches() to bring all four up to date before
+      //reading from several threads at once. clearAdjacencyCaches() frees them.
+      void updateAdjacencyCaches() const;
+      void clearAdjacencyCaches();
+
       int numVerts() const;
       int numEdges() const;
       int numFaces() const;
       int numTets() const;
 
+      //The k-th live simplex of each type in slot order (k < numVerts() etc.), and the inverse: the number of live simplices
+      //of its type before a given one. For random sampling, and for cutting the live simplices into equal ranges. See
+      //OccupancyBitmap for the costs; as there, the first query after an edit rebuilds a table.
+      VertexHandle nthVertex(unsigned int k) const;
+      EdgeHandle nthEdge(unsigned int k) const;
+      FaceHandle nthFace(unsigned int k) const;
+      TetHandle nthTet(unsigned int k) const;
+      unsigned int rankOf(const VertexHandle& vh) const;
+      unsigned int rankOf(const EdgeHandle& eh) const;
+      unsigned int rankOf(const FaceHandle& fh) const;
+      unsigned int rankOf(const TetHandle& th) const;
+
+      //Preallocate room for a total of n simplices of each type, in the incidence matrices and in every
+      //registered property, ahead of bulk construction. Properties added later get the same capacity.
+      void reserveVertices(unsigned int n);
+      void reserveEdges(unsigned int n);
+      void reserveFaces(unsigned int n);
+      void reserveTets(unsigned int n);
+
       //Addition: note that the resulting orientation is (in most cases) dependent on the order of parameters
       VertexHandle addVertex();
       EdgeHandle addEdge(const VertexHandle& v0, const VertexHandle& v1); //ordered from v0 to v1
@@ -38,6 +139,17 @@ namespace SimplexMesh {
       FaceHandle addFace(const VertexHandle& v0, const VertexHandle& v1, const VertexHandle& v2);
       TetHandle addTet(const VertexHandle& v0, const VertexHandle& v1, const VertexHandle& v2, const VertexHandle& v3);
 
+      //Bulk construction from indexed simplex soups (4, 3 or 2 vertex indices per simplex), into an empty complex.
+      //Vertices 0..(largest index) are created first. Shared edges and faces are found by sorting on their vertices,
+      //and each matrix is filled in a single pass. The result, including numbering and orientations, is identical to
+      //adding the simplices one by one with the vertex-based addEdge/addFace/addTet, reusing any edge or face that
+      //already exists (segments, then triangles, then tets, for mixed input).
+      //Returns false, leaving the complex untouched, if it is not empty or a simplex has a negative or repeated vertex.
+      bool buildFromTets(const int* tv, size_t n);
+      bool buildFromTriangles(const int* fv, size_t n);
+      bool buildFromSegments(const int* ev, size_t n);
+      bool buildFromSimplices(const int* tv, size_t numTets, const int* fv, size_t numTris, const int* ev, size_t numSegs);
+
       //deletion: recurse=true will recursively delete its composing sub-simplices if they are not used in any other simplices
       bool deleteVertex(const VertexHandle& vertex);
       bool deleteEdge(const EdgeHandle& edge, bool recurse);
@@ -51,15 +163,41 @@ namespace SimplexMesh {
       bool tetExists(const TetHandle& tet) const;
     
       //Exploit fixed ordering to provide fast/easy access to sub-elements of a simplex
-      VertexHandle getVertex(const EdgeHandle& eh, int index) const;
-      EdgeHandle getEdge(const FaceHandle& fh, int index) const;
-      FaceHandle getFace(const TetHandle& th, int index) const; //Is there an important/inherent ordering here? should we unique-ify by sorting?
-
-      //Get functions - grab a simplex by its constitutive simplices - slower!
+      VertexHandle getVertex(const EdgeHandle& eh, int index) const {
+         assert(edgeExists(eh) && index >= 0 && index <= 1);
+         return VertexHandle(m_EV.getColByIndex(eh.idx(), index));
+      }
+      EdgeHandle getEdge(const FaceHandle& fh, int index) const {
+         assert(faceExists(fh) && index >= 0 && index <= 2);
+         return EdgeHandle(m_FE.getColByIndex(fh.idx(), index));
+      }
+      FaceHandle getFace(const TetHandle& th, int index) const { //Is there an important/inherent ordering here? should we unique-ify by sorting?
+         assert(tetExists(th) && index >= 0 && index <= 3);
+         return FaceHandle(m_TF.getColByIndex(th.idx(), index));
+      }
+
+      //Get functions - grab a simplex by its constitutive simplices - slower, unless the lookup index is enabled
       EdgeHandle getEdge(const VertexHandle& v0, const VertexHandle& v1) const;
       FaceHandle getFace(const EdgeHandle& e0, const EdgeHandle& e1, const EdgeHandle& e2) const;
       TetHandle getTet(const FaceHandle& f0, const FaceHandle& f1, const FaceHandle& f2, const FaceHandle& f3) const;
 
+      //Fixed-size gathers for per-element kernels, in canonical orders that follow the simplices' orientations:
+      // - face vertices: around the face's orientation (the cycle of its oriented edges), lowest-numbered vertex first;
+      //   a face made by addFace(v0,v1,v2) comes back as a rotation of v0,v1,v2
+      // - tet vertices: lowest-numbered vertex first, then the other three in the cyclic order that keeps the tet's
+      //   orientation (that of its first face), lowest-numbered first; a tet made by addTet(v0,v1,v2,v3) from new
+      //   faces comes back as an even permutation of v0,v1,v2,v3
+      // - tet edges: between tet vertices 01, 02, 03, 12, 13, 23 of the order above (each edge keeps its own direction)
+      void getFaceVertices(const FaceHandle& fh, VertexHandle out[3]) const;
+      void getTetVertices(const TetHandle& th, VertexHandle out[4]) const;
+      void getTetEdges(const TetHandle& th, EdgeHandle out[6]) const;
+
+      //Batched versions, filling flat index arrays (3, 4 or 6 entries per simplex, in the orders above) for count
+      //simplices, e.g. for all tets with mesh.tets().handles(). Large batches are split across threads.
+      void getFaceVertices(const FaceHandle* faces, size_t count, int* out) const;
+      void getTetVertices(const TetHandle* tets, size_t count, int* out) const;
+      void getTetEdges(const TetHandle* tets, size_t count, int* out) const;
+
       //determine relative orientation of simplices (+1 or -1)
       int getRelativeOrientation(const TetHandle& th, const FaceHandle& fh) const;
       int getRelativeOrientation(const FaceHandle& fh, const EdgeHandle& eh) const;
@@ -87,9 +225,15 @@ namespace SimplexMesh {
 
       //Pairwise relationships / traversal
       //----------------------------------
-      //Edge/Vert
-      VertexHandle fromVertex(const EdgeHandle& eh) const;
-      VertexHandle toVertex(const EdgeHandle& eh) const;
+      //Edge/Vert - the 1st vertex is the from vertex and the 2nd is the to vertex, by design
+      VertexHandle fromVertex(const EdgeHandle& eh) const {
+         assert(eh.isValid() && m_EV.getNumEntriesInRow(eh.idx()) == 2);
+         return VertexHandle(m_EV.getColByIndex(eh.idx(), 0));
+      }
+      VertexHandle toVertex(const EdgeHandle& eh) const {
+         assert(eh.isValid() && m_EV.getNumEntriesInRow(eh.idx()) == 2);
+         return VertexHandle(m_EV.getColByIndex(eh.idx(), 1));
+      }
 
       //Face/Edge - assumes consistent orientation and 2D
       FaceHandle frontFace(const EdgeHandle& fh) const;
@@ -141,6 +285,65 @@ namespace SimplexMesh {
       TetHandle nextTet(const FaceHandle& face, const TetHandle& curTet) const;
       TetHandle prevTet(const FaceHandle& face, const TetHandle& curTet) const;
 
+      //Ranges (see SimplexRanges.h): the same traversals as the iterators, for range-based for and STL algorithms
+      //---------------------------------
+      //Live simplices, in slot order
+      SimplexRange<VertexHandle> vertices() const;
+      SimplexRange<EdgeHandle> edges() const;
+      SimplexRange<FaceHandle> faces() const;
+      SimplexRange<TetHandle> tets() const;
+
+      //Neighbours, read in place from the incidence rows
+      AdjacencyRange<VertexEdgeRows> vertexEdges(const VertexHandle& vh) const;
+      AdjacencyRange<VertexVertexRows> vertexVertices(const VertexHandle& vh) const;
+      AdjacencyRange<EdgeVertexRows> edgeVertices(const EdgeHandle& eh) const;
+      AdjacencyRange<EdgeFaceRows> edgeFaces(const EdgeHandle& eh) const;
+      AdjacencyRange<FaceEdgeRows> faceEdges(const FaceHandle& fh) const;
+      AdjacencyRange<FaceTetRows> faceTets(const FaceHandle& fh) const;
+      AdjacencyRange<TetFaceRows> tetFaces(const TetHandle& th) const;
+
+      //Neighbours two or more dimensions away, gathered up front (sorted, except for ordered face vertices)
+      GatheredRange<FaceHandle> vertexFaces(const VertexHandle& vh) const;
+      GatheredRange<TetHandle> vertexTets(const VertexHandle& vh) const;
+      GatheredRange<TetHandle> edgeTets(const EdgeHandle& eh) const;
+      GatheredRange<VertexHandle> faceVertices(const FaceHandle& fh, bool ordered = false) const;
+      GatheredRange<VertexHandle> tetVertices(const TetHandle& th) const;
+      GatheredRange<EdgeHandle> tetEdges(const TetHandle& th) const;
+
+      //Read-only snapshot
+      //---------------------------------
+
+      //Pack the current topology into an immutable, traversal-friendly CompactComplex (reusing its buffers).
+      void freeze(CompactComplex& frozen) const;
+
+      //Storage accounting
+      //---------------------------------
+
+      //Bytes used and reserved by each incidence matrix, registered property, dead-slot pool and lookup index,
+      //plus live/dead slot counts per dimension. The report's buffers are reused, so this is cheap enough to call
+      //every frame; the upward row-length histograms are only gathered if asked for, as they are linear in the slots.
+      void memoryReport(MemoryReport& report, bool rowHistograms = false) const;
+
+      //Storage maintenance
+      //---------------------------------
+
+      //Renumber the live simplices densely, dropping all dead slots from the incidence matrices and from every
+      //registered property. Relative order and orientation are preserved. Existing handles are invalidated;
+      //the returned tables map them to their new values.
+      SimplexRemap compact();
+
+      //Locality-improving reorderings. Each renumbers every simplex so that neighbours end up close together in
+      //the matrices and properties, dropping dead slots as compact() does, and returns the old-to-new tables.
+      //Orientations are preserved.
+      // - reorderHilbert: vertices along a 3D Hilbert curve through the given positions (any type indexable by 0..2)
+      // - reorderRCM: vertices in reverse Cuthill-McKee order of the vertex graph, reducing its bandwidth
+      // - reorderTetBFS: tets in breadth-first order across shared faces
+      //The first two order edges/faces/tets lexicographically by their (renumbered) vertices; the last numbers
+      //faces, edges and vertices as the tets reach them.
+      template<class Vec> SimplexRemap reorderHilbert(const VertexProperty<Vec>& positions);
+      SimplexRemap reorderRCM();
+      SimplexRemap reorderTetBFS();
+
       //Common connectivity editing operations
       //---------------------------------
 
@@ -170,12 +373,44 @@ namespace SimplexMesh {
       friend class VertexEdgeIterator; friend class EdgeVertexIterator; friend class VertexVertexIterator;
       friend class EdgeFaceIterator; friend class FaceEdgeIterator;
       friend class FaceTetIterator; friend class TetFaceIterator;
+      friend class VertexFaceIterator; friend class VertexTetIterator; friend class EdgeTetIterator;
+      friend class TetVertexIterator; friend class TetEdgeIterator;
+
+      //Cached adjacency iterators read the cache rows
+      friend class CachedVertexTetIterator; friend class CachedEdgeTetIterator;
+      friend class TetTetIterator; friend class CachedVertexVertexIterator;
+
+      //Ranges read the raw storage through their traits
+      template<class Handle> friend struct SimplexTraits;
+
+      //Snapshots read the raw incidence data
+      friend class CompactComplex;
+
+      //The reference topology backend reports on the raw storage
+      friend class IncidenceBackend;
 
       //allow properties to access object internals (for registering/unregistering themselves) 
+      friend class SimplexPropertyBase;
       template<class T> friend class VertexProperty;
       template<class T> friend class EdgeProperty;
       template<class T> friend class FaceProperty;
       template<class T> friend class TetProperty;
+      template<class T, unsigned int N> friend class VertexPropertySoA;
+      template<class T, unsigned int N> friend class EdgePropertySoA;
+      template<class T, unsigned int N> friend class FacePropertySoA;
+      template<class T, unsigned int N> friend class TetPropertySoA;
+      template<class T, unsigned int N> friend class VertexPropertyBuffered;
+      template<class T, unsigned int N> friend class EdgePropertyBuffered;
+      template<class T, unsigned int N> friend class FacePropertyBuffered;
+      template<class T, unsigned int N> friend class TetPropertyBuffered;
+      template<class Codec, unsigned int N> friend class VertexPropertyCompressed;
+      template<class Codec, unsigned int N> friend class EdgePropertyCompressed;
+      template<class Codec, unsigned int N> friend class FacePropertyCompressed;
+      template<class Codec, unsigned int N> friend class TetPropertyCompressed;
+      template<class T> friend class VertexPropertySparse;
+      template<class T> friend class EdgePropertySparse;
+      template<class T> friend class FacePropertySparse;
+      template<class T> friend class TetPropertySparse;
 
       //Internal functions
       //////////////////////////////////////////////////////////////////////////
@@ -183,6 +418,77 @@ namespace SimplexMesh {
       EdgeHandle getSharedEdge(const FaceHandle& f0, const FaceHandle& f1) const;
       FaceHandle getSharedFace(const TetHandle &t0, const TetHandle& t1) const;
 
+      //Renumbering, behind compact() and the reorderings
+      //--------------------------------
+
+      //Move every simplex to the slot given by the old-to-new tables (one entry per current slot, -1 to drop
+      //a dead slot), rebuilding the incidence matrices and permuting the registered properties to match.
+      //Downward rows keep their oriented order; the upward rows are rederived by rebuildTransposes, so they
+      //come out sorted by the new column numbers rather than in their previous order.
+      void applyRemap(const SimplexRemap& remap);
+
+      //Derive the upward relations (m_VE, m_EF, m_FT) from the downward ones in bulk, with a parallel counting-sort
+      //transpose, after import or renumbering. Upward rows come out in increasing order, as incremental construction
+      //leaves them when nothing has been deleted.
+      void rebuildTransposes();
+
+      //Complete remap tables from an ordering of the live vertices (or tets), as described for the reorderings above.
+      SimplexRemap remapFromVertexOrder(const std::vector<int>& vertOrder) const;
+      SimplexRemap remapFromTetOrder(const std::vector<int>& tetOrder) const;
+
+      //Hilbert reordering, given 3 coordinates per vertex slot
+      SimplexRemap reorderHilbert(const std::vector<double>& coords);
+
+      //The canonical oriented gathers, on slot indices, and their batched forms over handles [begin, end)
+      void orientedFaceVerts(int face, int out[3]) const;
+      void orientedTetVerts(int tet, int out[4]) const;
+      void orientedTetEdges(int tet, int out[6]) const;
+      void gatherFaceVertices(const FaceHandle* faces, size_t begin, size_t end, int* out) const;
+      void gatherTetVertices(const TetHandle* tets, size_t begin, size_t end, int* out) const;
+      void gatherTetEdges(const TetHandle* tets, size_t begin, size_t end, int* out) const;
+
+      //Fill in the downward row of a new face (edges given in order) or tet, choosing orientations exactly as
+      //addFace/addTet do. The chosen signs are returned, for the transpose.
+      void setFaceRow(int face, const EdgeHandle& e0, const EdgeHandle& e1, const EdgeHandle& e2, int signs[3]);
+      void setTetRow(int tet, const FaceHandle& f0, const FaceHandle& f1, const FaceHandle& f2, const FaceHandle& f3,
+         bool flip_face0, int signs[4]);
+
+      //Lookup index maintenance. Keys are computed from the current rows, so a simplex must be unindexed before
+      //its vertices change and indexed again afterwards.
+      SimplexKey edgeKey(int edge) const;
+      SimplexKey faceKey(int face) const;
+      SimplexKey tetKey(int tet) const;
+      void indexEdge(int edge) { if(m_indexed) m_edgeIndex.insert(edgeKey(edge), edge); }
+      void indexFace(int face) { if(m_indexed) m_faceIndex.insert(faceKey(face), face); }
+      void indexTet(int tet) { if(m_indexed) m_tetIndex.insert(tetKey(tet), tet); }
+      void unindexEdge(int edge) { if(m_indexed) m_edgeIndex.erase(edgeKey(edge), edge); }
+      void unindexFace(int face) { if(m_indexed) m_faceIndex.erase(faceKey(face), face); }
+      void unindexTet(int tet) { if(m_indexed) m_tetIndex.erase(tetKey(tet), tet); }
+      void rebuildLookupIndex();
+
+      //Adjacency cache maintenance: mark the cached rows around a tet or edge stale, both before and after it changes,
+      //and read a row (refreshing the cache first if need be).
+      enum AdjacencyKind { VertexTets, EdgeTets, TetTets, VertexVerts, AdjacencyKinds };
+      void staleTetAdjacency(int tet);
+      void staleEdgeAdjacency(int edge);
+      const AdjacencyCache& adjacency(AdjacencyKind kind, int row) const;
+      void rebuildAdjacency(AdjacencyKind kind) const;
+      void gatherAdjacencyRow(AdjacencyKind kind, int row, SmallIndexList& out) const;
+
+      //Property storage runs ahead of the slot counts: grow every property in the list to hold at least
+      //n entries (reserveProperties), or make room for the given number of slots with geometric growth (growProperties).
+      void reserveProperties(std::vector<SimplexPropertyBase*>& props, unsigned int& capacity, unsigned int n);
+      void growProperties(std::vector<SimplexPropertyBase*>& props, unsigned int& capacity, unsigned int slots);
+      //Tell every property in the list that a simplex was deleted, or that the simplices in [first, last) were added or reconnected.
+      //Both do nothing unless some property listens (see SimplexPropertyBase::listenToSlots).
+      void dropFromProperties(std::vector<SimplexPropertyBase*>& props, unsigned int slot);
+      void markChanged(std::vector<SimplexPropertyBase*>& props, unsigned int first, unsigned int last);
+
+      //Apply the update policies of the properties in the list (see PropertyUpdate) inside splitEdge, collapseEdge and flipEdge.
+      void deriveProperties(std::vector<SimplexPropertyBase*>& props, int child, int parent);
+      void interpolateProperties(std::vector<SimplexPropertyBase*>& props, int target, int a, int b);
+      void mergeProperties(std::vector<SimplexPropertyBase*>& props, int target, int other);
+
       //Functions for registering/unregistering properties associated to simplex elements
       void registerVertexProperty(SimplexPropertyBase* prop);
       void removeVertexProperty(SimplexPropertyBase* prop);
@@ -209,11 +515,15 @@ namespace SimplexMesh {
       //Simplex counts
       int m_nVerts, m_nEdges, m_nFaces, m_nTets;
 
-      //Fundamental mesh data (incidence matrix format)
-      IncidenceMatrix m_TF;  ///< tet-to-face relations
-      IncidenceMatrix m_FE;  ///< face-to-edge relations
-      IncidenceMatrix m_EV;  ///< edge-to-vert relations
-      std::vector<bool> m_V; ///< vertex existence, to support isolated vertices
+      //Fundamental mesh data (incidence matrix format).
+      //Live rows always have exactly 4/3/2 entries, so these use fixed-width rows.
+      FixedIncidenceMatrix<4> m_TF;  ///< tet-to-face relations
+      FixedIncidenceMatrix<3> m_FE;  ///< face-to-edge relations
+      FixedIncidenceMatrix<2> m_EV;  ///< edge-to-vert relations
+
+      //Which slots are live, one bit each (for vertices, the only record of existence, to support isolated vertices).
+      //Always the same length as the corresponding matrix.
+      OccupancyBitmap m_V, m_E, m_F, m_T;
 
       //Transposes, needed for efficient deletion/traversal/etc
       IncidenceMatrix m_FT; ///< face-to-tet relations
@@ -231,14 +541,49 @@ namespace SimplexMesh {
       std::vector<SimplexPropertyBase*> m_faceProperties;
       std::vector<SimplexPropertyBase*> m_tetProperties;
 
+      //Number of entries currently allocated in each registered property of the given type (at least the number of slots)
+      unsigned int m_vertCapacity, m_edgeCapacity, m_faceCapacity, m_tetCapacity;
+
+      //Optional lookup index from vertex tuples to simplices (see setLookupIndex)
+      SimplexIndex m_edgeIndex, m_faceIndex, m_tetIndex;
+
+      //Derived adjacency caches, by AdjacencyKind (see updateAdjacencyCaches)
+      mutable AdjacencyCache m_adjacency[AdjacencyKinds];
+
+      //Number of properties, of any simplex type, that want dropFromProperties/markChanged notifications
+      unsigned int m_slotListeners;
+
       //Option flags
       bool m_safetyChecks;
+      bool m_indexed;
 
    };
 
 } // namespace SimplexMesh
 
 #include "SimplexProperty.h"
+#include "SimplexPropertyBuffered.h"
+#include "SimplexPropertyCompressed.h"
+#include "SimplexPropertySoA.h"
+#include "SimplexPropertySparse.h"
 #include "SimplexIterators.h"
+#include "CompactComplex.h"
+
+namespace SimplexMesh {
+
+   template<class Vec>
+   SimplexRemap SimplicialComplex::reorderHilbert(const VertexProperty<Vec>& positions) {
+      std::vector<double> coords(3*numVertexSlots(), 0.0);
+      for(unsigned int i = 0; i < numVertexSlots(); ++i) {
+         if(!m_V[i]) continue;
+         const Vec& pos = positions[VertexHandle(i)];
+         coords[3*i] = pos[0];
+         coords[3*i+1] = pos[1];
+         coords[3*i+2] = pos[2];
+      }
+      return reorderHilbert(coords);
+   }
+
+} // namespace SimplexMesh
 
 #endif // SIMPLICIALCOMPLEX_H
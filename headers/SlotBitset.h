@@ -0,0 +1,122 @@
+#ifndef SLOTBITSET_H
+#define SLOTBITSET_H
+
+#include <algorithm>
+#include <vector>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace SimplexMesh {
+
+   //One bit per simplex slot, packed into 64-bit words so that runs of clear bits are skipped a word at a time:
+   //   for(size_t i = bits.findNext(0); i != SlotBitset::npos; i = bits.findNext(i+1)) ...
+   class SlotBitset {
+   public:
+      typedef unsigned long long Word;
+      static const size_t npos = ~(size_t)0;
+
+      SlotBitset() : m_size(0) {}
+
+      //New bits are clear.
+      void resize(size_t n) {
+         m_words.resize((n + 63) / 64, 0);
+         m_size = n;
+         if(n % 64 != 0)
+            m_words.back() &= ((Word)1 << (n % 64)) - 1;
+      }
+      size_t size() const { return m_size; }
+      void reserve(size_t n) { m_words.reserve((n + 63) / 64); }
+
+      //Raw words, bit i of the bitset being bit i%64 of word i/64.
+      size_t numWords() const { return m_words.size(); }
+      Word word(size_t w) const { return m_words[w]; }
+
+      void set(size_t i) { m_words[i >> 6] |= (Word)1 << (i & 63); }
+      void reset(size_t i) { m_words[i >> 6] &= ~((Word)1 << (i & 63)); }
+      bool test(size_t i) const { return (m_words[i >> 6] >> (i & 63)) & 1; }
+
+      void setAll() {
+         m_words.assign(m_words.size(), ~(Word)0);
+         resize(m_size);
+      }
+      void clearAll() { m_words.assign(m_words.size(), 0); }
+
+      //Sets bits first..last-1, whole words at a time in the middle.
+      void setRange(size_t first, size_t last) {
+         for(; first < last && (first & 63) != 0; ++first)
+            set(first);
+         for(; first + 64 <= last; first += 64)
+            m_words[first >> 6] = ~(Word)0;
+         for(; first < last; ++first)
+            set(first);
+      }
+
+      size_t count() const {
+         size_t n = 0;
+         for(size_t w = 0; w < m_words.size(); ++w)
+            n += popCount(m_words[w]);
+         return n;
+      }
+
+      //The first set bit at or after i, or npos.
+      size_t findNext(size_t i) const {
+         if(i >= m_size)
+            return npos;
+         size_t w = i >> 6;
+         Word bits = m_words[w] & (~(Word)0 << (i & 63));
+         while(bits == 0) {
+            if(++w == m_words.size())
+               return npos;
+            bits = m_words[w];
+         }
+         return (w << 6) + lowestBit(bits);
+      }
+
+      //New bit i takes the value of old bit newToOld[i].
+      void permute(const std::vector<int>& newToOld) {
+         SlotBitset permuted;
+         permuted.resize(newToOld.size());
+         for(size_t i = 0; i < newToOld.size(); ++i)
+            if(test(newToOld[i]))
+               permuted.set(i);
+         swap(permuted);
+      }
+
+      void swap(SlotBitset& other) {
+         m_words.swap(other.m_words);
+         std::swap(m_size, other.m_size);
+      }
+
+      size_t memoryUsed() const { return m_words.size()*sizeof(Word); }
+      size_t memoryUsage() const { return m_words.capacity()*sizeof(Word); }
+
+      //Index of the lowest set bit of a nonzero word (count of trailing zeros).
+      static unsigned int lowestBit(Word w) {
+#ifdef _MSC_VER
+         unsigned long i;
+         if(_BitScanForward(&i, (unsigned long)w))
+            return i;
+         _BitScanForward(&i, (unsigned long)(w >> 32));
+         return 32 + i;
+#else
+         return __builtin_ctzll(w);
+#endif
+      }
+
+      static unsigned int popCount(Word w) {
+         w = w - ((w >> 1) & 0x5555555555555555ull);
+         w = (w & 0x3333333333333333ull) + ((w >> 2) & 0x3333333333333333ull);
+         w = (w + (w >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+         return (unsigned int)((w * 0x0101010101010101ull) >> 56);
+      }
+
+   private:
+      std::vector<Word> m_words;
+      size_t m_size;
+   };
+
+} // namespace SimplexMesh
+
+#endif // SLOTBITSET_H
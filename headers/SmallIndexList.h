@@ -0,0 +1,57 @@
+#ifndef SMALLINDEXLIST_H
+#define SMALLINDEXLIST_H
+
+#include <algorithm>
+#include <vector>
+
+namespace SimplexMesh {
+
+//The simplex indices collected by the trickier adjacency iterators (in SimplexIterators.h and CompactComplex.h). The first
+//Inline entries live inside the iterator itself, so typical neighbourhoods are gathered, sorted and de-duplicated without
+//touching the heap.
+class SmallIndexList {
+public:
+   enum { Inline = 64 };
+
+   SmallIndexList() : m_size(0), m_onHeap(false) {}
+
+   void push_back(int idx) {
+      if(!m_onHeap && m_size == Inline) {
+         m_heap.assign(m_inline, m_inline + Inline);
+         m_onHeap = true;
+      }
+      if(m_onHeap)
+         m_heap.push_back(idx);
+      else
+         m_inline[m_size] = idx;
+      ++m_size;
+   }
+
+   //Sort ascending and drop repeats.
+   void sortUnique() {
+      int* first = data();
+      std::sort(first, first + m_size);
+      m_size = (unsigned int)(std::unique(first, first + m_size) - first);
+      if(m_onHeap)
+         m_heap.resize(m_size);
+   }
+
+   unsigned int size() const { return m_size; }
+   int operator[](unsigned int i) const { return m_onHeap ? m_heap[i] : m_inline[i]; }
+
+   //Membership test, once sorted.
+   bool contains(int idx) const { return std::binary_search(data(), data() + m_size, idx); }
+
+private:
+   int* data() { return m_onHeap ? &m_heap[0] : m_inline; }
+   const int* data() const { return m_onHeap ? &m_heap[0] : m_inline; }
+
+   int m_inline[Inline];
+   std::vector<int> m_heap;
+   unsigned int m_size;
+   bool m_onHeap;
+};
+
+} // namespace SimplexMesh
+
+#endif // SMALLINDEXLIST_H
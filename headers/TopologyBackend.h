@@ -0,0 +1,118 @@
+#ifndef TOPOLOGYBACKEND_H
+#define TOPOLOGYBACKEND_H
+
+#include "SimplicialComplex.h"
+#include "SimplexHandles.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace SimplexMesh {
+
+   //An unoriented simplex of dimension 0-3, identified by its vertices (kept sorted, so equal simplices compare equal).
+   struct Simplex {
+      int dim;
+      VertexHandle v[4];
+
+      Simplex() : dim(-1) {}
+      explicit Simplex(const VertexHandle& v0) : dim(0) { v[0] = v0; }
+      Simplex(const VertexHandle& v0, const VertexHandle& v1) : dim(1) { v[0] = v0; v[1] = v1; sort(); }
+      Simplex(const VertexHandle& v0, const VertexHandle& v1, const VertexHandle& v2) : dim(2) { v[0] = v0; v[1] = v1; v[2] = v2; sort(); }
+      Simplex(const VertexHandle& v0, const VertexHandle& v1, const VertexHandle& v2, const VertexHandle& v3) : dim(3) {
+         v[0] = v0; v[1] = v1; v[2] = v2; v[3] = v3; sort();
+      }
+
+      int numVerts() const { return dim+1; }
+      bool contains(const VertexHandle& vh) const {
+         for(int i = 0; i <= dim; ++i) if(v[i] == vh) return true;
+         return false;
+      }
+
+      bool operator==(const Simplex& rhs) const {
+         if(dim != rhs.dim) return false;
+         for(int i = 0; i <= dim; ++i) if(v[i] != rhs.v[i]) return false;
+         return true;
+      }
+      bool operator!=(const Simplex& rhs) const { return !(*this == rhs); }
+      bool operator<(const Simplex& rhs) const {
+         if(dim != rhs.dim) return dim < rhs.dim;
+         for(int i = 0; i <= dim; ++i) if(v[i] != rhs.v[i]) return v[i] < rhs.v[i];
+         return false;
+      }
+
+      //insertion sort, as there are at most four vertices
+      void sort() {
+         for(int i = 1; i <= dim; ++i)
+            for(int j = i; j > 0 && v[j] < v[j-1]; --j)
+               std::swap(v[j], v[j-1]);
+      }
+   };
+
+   //Abstract interface to the core topological relations of a simplicial complex, so that different
+   //underlying representations can be swapped in and compared. Everything is expressed in terms of
+   //vertex handles and unoriented simplices, which every representation can support, whether or not it
+   //stores intermediate simplices explicitly.
+   //SimplicialComplex itself remains the full-featured, oriented data structure; IncidenceBackend exposes it
+   //through this interface as the reference implementation.
+   class TopologyBackend {
+   public:
+      virtual ~TopologyBackend() {}
+
+      virtual const char* name() const = 0;
+
+      //Addition: a simplex is added along with any of its missing faces. Returns false if it already
+      //exists, or if any vertex is invalid or repeated.
+      virtual VertexHandle addVertex() = 0;
+      virtual bool addSimplex(const Simplex& s) = 0;
+
+      //Deletion: only succeeds if no higher-dimensional simplex uses it. Its faces are kept.
+      virtual bool deleteSimplex(const Simplex& s) = 0;
+
+      //Existence
+      virtual bool exists(const Simplex& s) const = 0;
+
+      //Boundary (faces of one dimension lower) and coboundary (simplices of one dimension higher that contain s).
+      //Results are appended to out.
+      virtual void boundary(const Simplex& s, std::vector<Simplex>& out) const = 0;
+      virtual void coboundary(const Simplex& s, std::vector<Simplex>& out) const = 0;
+
+      //Bytes allocated for the topology.
+      virtual size_t memoryUsage() const = 0;
+   };
+
+   //The reference backend: a SimplicialComplex, with explicit simplices of every dimension in incidence matrices.
+   class IncidenceBackend : public TopologyBackend {
+   public:
+      IncidenceBackend();
+
+      const char* name() const { return "IncidenceMatrix"; }
+
+      VertexHandle addVertex();
+      bool addSimplex(const Simplex& s);
+      bool deleteSimplex(const Simplex& s);
+      bool exists(const Simplex& s) const;
+      void boundary(const Simplex& s, std::vector<Simplex>& out) const;
+      void coboundary(const Simplex& s, std::vector<Simplex>& out) const;
+      size_t memoryUsage() const;
+
+      //Direct access to the underlying complex.
+      SimplicialComplex& complex() { return m_obj; }
+      const SimplicialComplex& complex() const { return m_obj; }
+
+   private:
+
+      //Lookup of the explicit simplex matching s (invalid handle if none)
+      EdgeHandle findEdge(const Simplex& s) const;
+      FaceHandle findFace(const Simplex& s) const;
+      TetHandle findTet(const Simplex& s) const;
+
+      Simplex toSimplex(const EdgeHandle& eh) const;
+      Simplex toSimplex(const FaceHandle& fh) const;
+      Simplex toSimplex(const TetHandle& th) const;
+
+      SimplicialComplex m_obj;
+   };
+
+} // namespace SimplexMesh
+
+#endif // TOPOLOGYBACKEND_H
@@ -0,0 +1,108 @@
+#include "CompactComplex.h"
+
+namespace SimplexMesh {
+
+   //Assign dense indices to the live slots, recording the mapping in both directions.
+   void numberSlots(const OccupancyBitmap& live, std::vector<int>& handles, std::vector<int>& indices) {
+      handles.clear();
+      handles.reserve(live.count());
+      indices.assign(live.size(), -1);
+      for(size_t slot = live.findNext(0); slot != OccupancyBitmap::npos; slot = live.findNext(slot+1)) {
+         indices[slot] = handles.size();
+         handles.push_back(slot);
+      }
+   }
+
+   //Pack the live rows of an incidence matrix, translating columns to dense indices.
+   template<class Matrix>
+   void packRelation(const Matrix& mat, const std::vector<int>& rowSlots, const std::vector<int>& colIndices,
+      std::vector<int>& rowPtr, std::vector<int>& col, std::vector<signed char>& sign)
+   {
+      rowPtr.resize(rowSlots.size()+1);
+      col.clear();
+      sign.clear();
+
+      rowPtr[0] = 0;
+      for(unsigned int row = 0; row < rowSlots.size(); ++row) {
+         unsigned int slot = rowSlots[row];
+         unsigned int count = mat.getNumEntriesInRow(slot);
+         for(unsigned int k = 0; k < count; ++k) {
+            col.push_back(colIndices[mat.getColByIndex(slot, k)]);
+            sign.push_back((signed char)mat.getValueByIndex(slot, k));
+         }
+         rowPtr[row+1] = col.size();
+      }
+   }
+
+   CompactComplex::CompactComplex() {
+   }
+
+   CompactComplex::CompactComplex(const SimplicialComplex& obj) {
+      build(obj);
+   }
+
+   void CompactComplex::build(const SimplicialComplex& obj) {
+
+      //number the live simplices of each dimension
+      numberSlots(obj.m_V, m_vertHandles, m_vertIndices);
+      numberSlots(obj.m_E, m_edgeHandles, m_edgeIndices);
+      numberSlots(obj.m_F, m_faceHandles, m_faceIndices);
+      numberSlots(obj.m_T, m_tetHandles, m_tetIndices);
+
+      //pack the relations
+      packRelation(obj.m_EV, m_edgeHandles, m_vertIndices, m_EV.rowPtr, m_EV.col, m_EV.sign);
+      packRelation(obj.m_FE, m_faceHandles, m_edgeIndices, m_FE.rowPtr, m_FE.col, m_FE.sign);
+      packRelation(obj.m_TF, m_tetHandles, m_faceIndices, m_TF.rowPtr, m_TF.col, m_TF.sign);
+
+      packRelation(obj.m_VE, m_vertHandles, m_edgeIndices, m_VE.rowPtr, m_VE.col, m_VE.sign);
+      packRelation(obj.m_EF, m_edgeHandles, m_faceIndices, m_EF.rowPtr, m_EF.col, m_EF.sign);
+      packRelation(obj.m_FT, m_faceHandles, m_tetIndices, m_FT.rowPtr, m_FT.col, m_FT.sign);
+   }
+
+   void CompactComplex::appendRow(const Relation& rel, int row, SmallIndexList& out) {
+      if(row < 0) return;
+      for(int k = rel.rowPtr[row]; k < rel.rowPtr[row+1]; ++k)
+         out.push_back(rel.col[k]);
+   }
+
+   void CompactComplex::gatherVertexFaces(int vert, SmallIndexList& out) const {
+      SmallIndexList edges;
+      appendRow(m_VE, vert, edges);
+      for(unsigned int e = 0; e < edges.size(); ++e)
+         appendRow(m_EF, edges[e], out);
+      out.sortUnique();
+   }
+
+   void CompactComplex::gatherVertexTets(int vert, SmallIndexList& out) const {
+      SmallIndexList faces;
+      gatherVertexFaces(vert, faces);
+      for(unsigned int f = 0; f < faces.size(); ++f)
+         appendRow(m_FT, faces[f], out);
+      out.sortUnique();
+   }
+
+   void CompactComplex::gatherEdgeTets(int edge, SmallIndexList& out) const {
+      SmallIndexList faces;
+      appendRow(m_EF, edge, faces);
+      for(unsigned int f = 0; f < faces.size(); ++f)
+         appendRow(m_FT, faces[f], out);
+      out.sortUnique();
+   }
+
+   void CompactComplex::gatherTetVerts(int tet, SmallIndexList& out) const {
+      SmallIndexList edges;
+      gatherTetEdges(tet, edges);
+      for(unsigned int e = 0; e < edges.size(); ++e)
+         appendRow(m_EV, edges[e], out);
+      out.sortUnique();
+   }
+
+   void CompactComplex::gatherTetEdges(int tet, SmallIndexList& out) const {
+      SmallIndexList faces;
+      appendRow(m_TF, tet, faces);
+      for(unsigned int f = 0; f < faces.size(); ++f)
+         appendRow(m_FE, faces[f], out);
+      out.sortUnique();
+   }
+
+}
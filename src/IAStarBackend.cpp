@@ -0,0 +1,206 @@
+#include "IAStarBackend.h"
+
+namespace SimplexMesh {
+
+   IAStarBackend::IAStarBackend() {
+      for(int d = 0; d < 4; ++d)
+         m_numTops[d] = 0;
+
+      //most vertices see a handful of top simplices; tet meshes average around 20-25, and spill to the slab
+      m_VT.setInlineWidth(8);
+   }
+
+   VertexHandle IAStarBackend::addVertex() {
+      m_V.push_back(true);
+      m_VT.addRows(1);
+      return VertexHandle(m_V.size()-1);
+   }
+
+   bool IAStarBackend::validVertices(const Simplex& s) const {
+      for(int i = 0; i <= s.dim; ++i) {
+         int v = s.v[i].idx();
+         if(v < 0 || v >= (int)m_V.size() || !m_V[v]) return false;
+         if(i > 0 && s.v[i] == s.v[i-1]) return false;
+      }
+      return true;
+   }
+
+   bool IAStarBackend::topContains(int ref, const Simplex& s) const {
+      const int* verts = topVerts(ref);
+      int count = topDim(ref)+1;
+      for(int i = 0; i <= s.dim; ++i) {
+         int k = 0;
+         while(k < count && verts[k] != s.v[i].idx()) ++k;
+         if(k == count) return false;
+      }
+      return true;
+   }
+
+   int IAStarBackend::findCoveringTop(const Simplex& s) const {
+      //scan the shortest vertex-top list among the vertices of s
+      int best = s.v[0].idx();
+      for(int i = 1; i <= s.dim; ++i)
+         if(m_VT.getNumEntriesInRow(s.v[i].idx()) < m_VT.getNumEntriesInRow(best))
+            best = s.v[i].idx();
+
+      for(unsigned int k = 0; k < m_VT.getNumEntriesInRow(best); ++k) {
+         int ref = m_VT.getColByIndex(best, k);
+         if(topDim(ref) >= s.dim && topContains(ref, s))
+            return ref;
+      }
+      return -1;
+   }
+
+   int IAStarBackend::findTop(const Simplex& s) const {
+      int v = s.v[0].idx();
+      for(unsigned int k = 0; k < m_VT.getNumEntriesInRow(v); ++k) {
+         int ref = m_VT.getColByIndex(v, k);
+         if(topDim(ref) == s.dim && topContains(ref, s))
+            return ref;
+      }
+      return -1;
+   }
+
+   void IAStarBackend::insertTop(const Simplex& s) {
+      int d = s.dim;
+      int id;
+      if(m_freeTops[d].size() > 0) {
+         id = m_freeTops[d].back();
+         m_freeTops[d].pop_back();
+      }
+      else {
+         id = m_tops[d].size() / (d+1);
+         m_tops[d].resize(m_tops[d].size() + d+1);
+      }
+      for(int i = 0; i <= d; ++i)
+         m_tops[d][id*(d+1) + i] = s.v[i].idx();
+      ++m_numTops[d];
+
+      int ref = topRef(id, d);
+      if(ref >= (int)m_VT.getNumCols())
+         m_VT.addCols(ref + 1 - m_VT.getNumCols());
+      for(int i = 0; i <= d; ++i)
+         m_VT.set(s.v[i].idx(), ref, 1);
+   }
+
+   void IAStarBackend::eraseTop(int ref) {
+      int d = topDim(ref), id = topId(ref);
+      int* verts = &m_tops[d][id*(d+1)];
+      for(int i = 0; i <= d; ++i)
+         m_VT.remove(verts[i], ref);
+      verts[0] = -1;
+      m_freeTops[d].push_back(id);
+      --m_numTops[d];
+   }
+
+   bool IAStarBackend::addSimplex(const Simplex& s) {
+      if(s.dim < 1 || !validVertices(s) || exists(s))
+         return false;
+
+      //any current tops made up only of vertices of s become (implicit) faces of it
+      std::vector<int> covered;
+      for(int i = 0; i <= s.dim; ++i) {
+         int v = s.v[i].idx();
+         for(unsigned int k = 0; k < m_VT.getNumEntriesInRow(v); ++k) {
+            int ref = m_VT.getColByIndex(v, k);
+            if(topDim(ref) >= s.dim) continue;
+            const int* verts = topVerts(ref);
+            bool inside = true;
+            for(int j = 0; j <= topDim(ref) && inside; ++j)
+               inside = s.contains(VertexHandle(verts[j]));
+            if(inside && std::find(covered.begin(), covered.end(), ref) == covered.end())
+               covered.push_back(ref);
+         }
+      }
+      for(unsigned int i = 0; i < covered.size(); ++i)
+         eraseTop(covered[i]);
+
+      insertTop(s);
+      return true;
+   }
+
+   bool IAStarBackend::deleteSimplex(const Simplex& s) {
+      if(!validVertices(s))
+         return false;
+
+      if(s.dim == 0) {
+         //only isolated vertices can go
+         if(m_VT.getNumEntriesInRow(s.v[0].idx()) != 0)
+            return false;
+         m_V[s.v[0].idx()] = false;
+         return true;
+      }
+
+      //a simplex with no cofaces is necessarily a top; anything else is either in use or absent
+      int ref = findTop(s);
+      if(ref < 0)
+         return false;
+
+      std::vector<Simplex> faces;
+      if(s.dim >= 2)
+         boundary(s, faces);
+      eraseTop(ref);
+
+      //faces that were only held up by s are now tops in their own right (vertices need no record)
+      for(unsigned int i = 0; i < faces.size(); ++i)
+         if(findCoveringTop(faces[i]) < 0)
+            insertTop(faces[i]);
+      return true;
+   }
+
+   bool IAStarBackend::exists(const Simplex& s) const {
+      if(s.dim < 0 || !validVertices(s))
+         return false;
+      return s.dim == 0 || findCoveringTop(s) >= 0;
+   }
+
+   void IAStarBackend::boundary(const Simplex& s, std::vector<Simplex>& out) const {
+      //purely combinatorial: every face of an existing simplex exists
+      if(s.dim < 1 || !exists(s))
+         return;
+      for(int skip = 0; skip <= s.dim; ++skip) {
+         Simplex face;
+         face.dim = s.dim-1;
+         for(int i = 0, k = 0; i <= s.dim; ++i)
+            if(i != skip) face.v[k++] = s.v[i];
+         out.push_back(face);
+      }
+   }
+
+   void IAStarBackend::coboundary(const Simplex& s, std::vector<Simplex>& out) const {
+      if(s.dim < 0 || s.dim > 2 || !validVertices(s))
+         return;
+
+      //every top around v0 that strictly contains s contributes s plus each of its other vertices
+      unsigned int first = out.size();
+      int v = s.v[0].idx();
+      for(unsigned int k = 0; k < m_VT.getNumEntriesInRow(v); ++k) {
+         int ref = m_VT.getColByIndex(v, k);
+         if(topDim(ref) <= s.dim || !topContains(ref, s))
+            continue;
+
+         const int* verts = topVerts(ref);
+         for(int j = 0; j <= topDim(ref); ++j) {
+            VertexHandle w(verts[j]);
+            if(s.contains(w)) continue;
+
+            Simplex coface = s;
+            coface.dim = s.dim+1;
+            coface.v[coface.dim] = w;
+            coface.sort();
+
+            //cofaces are shared by neighbouring tops, so drop repeats
+            if(std::find(out.begin() + first, out.end(), coface) == out.end())
+               out.push_back(coface);
+         }
+      }
+   }
+
+   size_t IAStarBackend::memoryUsage() const {
+      size_t bytes = m_V.capacity()/8 + m_VT.memoryUsage();
+      for(int d = 0; d < 4; ++d)
+         bytes += (m_tops[d].capacity() + m_freeTops[d].capacity())*sizeof(int);
+      return bytes;
+   }
+
+}
@@ -1,4 +1,9 @@
 #include "IncidenceMatrix.h"
+#include "Parallel.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 
 namespace SimplexMesh {
 
@@ -7,49 +12,277 @@ int signum(int val) {
 
 }
 
-IncidenceMatrix::IncidenceMatrix() : 
-   n_rows(0), n_cols(0), m_indices(0)
+//Orders row entries by column, ignoring the sign.
+bool absLess(int a, int b) {
+  return std::abs(a) < std::abs(b);
+}
+
+//Orders rows by their position in the slab, so compaction can slide them down safely.
+struct RowOffsetLess {
+  RowOffsetLess(const std::vector<unsigned int>& offsets) : m_offsets(offsets) {}
+  bool operator()(unsigned int a, unsigned int b) const { return m_offsets[a] < m_offsets[b]; }
+  const std::vector<unsigned int>& m_offsets;
+};
+
+IncidenceMatrix::IncidenceMatrix() :
+   n_rows(0), n_cols(0), m_inlineWidth(0), m_wasted(0), m_sorted(false)
 {
 }
 
-IncidenceMatrix::IncidenceMatrix(unsigned int rows, unsigned int cols) : 
-   n_rows(rows), n_cols(cols), 
-   m_indices(rows, std::vector<int>())
+IncidenceMatrix::IncidenceMatrix(unsigned int rows, unsigned int cols) :
+   n_rows(rows), n_cols(cols), m_inlineWidth(0), m_wasted(0), m_sorted(false)
 {
+   RowSpan empty = {0, 0, 0};
+   m_rows.resize(rows, empty);
+}
+
+void IncidenceMatrix::reserveRow(unsigned int i, unsigned int entries) {
+   RowSpan& row = m_rows[i];
+   if(entries <= row.capacity || (row.capacity == 0 && entries <= m_inlineWidth))
+      return;
+
+   //an inline row spilling over gets its current entries copied out to the slab
+   if(row.capacity == 0) {
+      unsigned int new_cap = std::max(entries, std::max(4u, m_inlineWidth*2));
+      unsigned int new_offset = m_slab.size();
+      m_slab.resize(new_offset + new_cap, 0);
+      if(row.length > 0)
+         std::memcpy(&m_slab[new_offset], &m_inline[i*m_inlineWidth], row.length*sizeof(int));
+      row.offset = new_offset;
+      row.capacity = new_cap;
+      return;
+   }
+
+   unsigned int new_cap = std::max(entries, std::max(2u, row.capacity*2));
+
+   //the last row in the slab can simply be extended in place
+   if(row.capacity > 0 && row.offset + row.capacity == m_slab.size()) {
+      m_slab.resize(row.offset + new_cap, 0);
+      row.capacity = new_cap;
+      return;
+   }
+
+   //otherwise move the row to the end of the slab, abandoning its old space
+   unsigned int new_offset = m_slab.size();
+   m_slab.resize(new_offset + new_cap, 0);
+   if(row.length > 0)
+      std::memmove(&m_slab[new_offset], &m_slab[row.offset], row.length*sizeof(int));
+
+   m_wasted += row.capacity;
+   row.offset = new_offset;
+   row.capacity = new_cap;
+
+   //once more than half the slab is dead space, squeeze it out
+   if(m_wasted > 1024 && m_wasted > m_slab.size()/2)
+      compact();
+}
+
+void IncidenceMatrix::moveRowInline(unsigned int i) {
+   RowSpan& row = m_rows[i];
+   assert(row.capacity > 0 && row.length <= m_inlineWidth);
+
+   if(row.length > 0)
+      std::memcpy(&m_inline[i*m_inlineWidth], &m_slab[row.offset], row.length*sizeof(int));
+   m_wasted += row.capacity;
+   row.offset = 0;
+   row.capacity = 0;
+
+   if(m_wasted > 1024 && m_wasted > m_slab.size()/2)
+      compact();
+}
+
+void IncidenceMatrix::setInlineWidth(unsigned int width) {
+   if(width == m_inlineWidth)
+      return;
+
+   //lay every row out again from scratch under the new width
+   std::vector<int> new_inline(n_rows*width, 0);
+   std::vector<int> new_slab;
+   for(unsigned int i = 0; i < n_rows; ++i) {
+      RowSpan& row = m_rows[i];
+      const int* data = rowData(i);
+      if(row.length <= width) {
+         if(row.length > 0)
+            std::memcpy(&new_inline[i*width], data, row.length*sizeof(int));
+         row.offset = 0;
+         row.capacity = 0;
+      }
+      else {
+         unsigned int new_offset = new_slab.size();
+         new_slab.insert(new_slab.end(), data, data + row.length);
+         row.offset = new_offset;
+         row.capacity = row.length;
+      }
+   }
+
+   m_inlineWidth = width;
+   m_inline.swap(new_inline);
+   m_slab.swap(new_slab);
+   m_wasted = 0;
+}
+
+size_t IncidenceMatrix::memoryUsage() const {
+   return m_slab.capacity()*sizeof(int) + m_inline.capacity()*sizeof(int) + m_rows.capacity()*sizeof(RowSpan);
+}
+
+size_t IncidenceMatrix::memoryUsed() const {
+   return (m_slab.size() - m_wasted)*sizeof(int) + m_inline.size()*sizeof(int) + m_rows.size()*sizeof(RowSpan);
+}
+
+void IncidenceMatrix::rowLengthHistogram(std::vector<unsigned int>& counts) const {
+   counts.clear();
+   for(unsigned int i = 0; i < n_rows; ++i) {
+      unsigned int length = m_rows[i].length;
+      if(length >= counts.size())
+         counts.resize(length+1, 0);
+      ++counts[length];
+   }
+}
+
+//Copies a block of rows into place for assignRows, once their storage has been laid out.
+struct AssignRowsBlock {
+   IncidenceMatrix& mat;
+   const unsigned int* rowStart;
+   const int* entries;
+   AssignRowsBlock(IncidenceMatrix& m, const unsigned int* starts, const int* data) : mat(m), rowStart(starts), entries(data) {}
+
+   void operator()(size_t begin, size_t end) const {
+      for(size_t i = begin; i < end; ++i) {
+         unsigned int length = mat.m_rows[i].length;
+         const int* src = entries + rowStart[i];
+         if(length > 0)
+            std::memcpy(mat.rowData(i), src, length*sizeof(int));
+         assert(!mat.m_sorted || std::is_sorted(src, src + length, absLess));
+      }
+   }
+};
+
+void IncidenceMatrix::assignRows(unsigned int rows, unsigned int cols, const std::vector<unsigned int>& rowStart, const std::vector<int>& entries) {
+   assert(rowStart.size() == rows+1 && rowStart[rows] == entries.size());
+   n_rows = rows;
+   n_cols = cols;
+
+   RowSpan empty = {0, 0, 0};
+   m_rows.assign(rows, empty);
+   m_inline.assign(rows*m_inlineWidth, 0);
+   m_wasted = 0;
+
+   //rows that don't fit inline are packed back to back in an exactly sized slab
+   size_t spilled = 0;
+   for(unsigned int i = 0; i < rows; ++i) {
+      unsigned int length = rowStart[i+1] - rowStart[i];
+      m_rows[i].length = length;
+      if(length > m_inlineWidth) {
+         m_rows[i].offset = spilled;
+         m_rows[i].capacity = length;
+         spilled += length;
+      }
+   }
+   m_slab.clear();
+   m_slab.resize(spilled);
+
+   parallelFor(rows, AssignRowsBlock(*this, rowStart.data(), entries.data()));
 }
 
-unsigned int IncidenceMatrix::getNumEntriesInRow(unsigned int row) const {
- assert(row < n_rows);
- return m_indices[row].size();
+void IncidenceMatrix::swap(IncidenceMatrix& other) {
+   std::swap(n_rows, other.n_rows);
+   std::swap(n_cols, other.n_cols);
+   m_slab.swap(other.m_slab);
+   m_rows.swap(other.m_rows);
+   std::swap(m_inlineWidth, other.m_inlineWidth);
+   m_inline.swap(other.m_inline);
+   std::swap(m_wasted, other.m_wasted);
+   std::swap(m_sorted, other.m_sorted);
 }
 
-int IncidenceMatrix::getValueByIndex(unsigned int i, unsigned int index_in_row) const {
- assert(i < n_rows);
- assert(index_in_row < m_indices[i].size());
+void IncidenceMatrix::compact() {
+   if(m_wasted == 0)
+      return;
+
+   //visit rows in slab order; since each destination is never past its source, rows can be slid down in place
+   std::vector<unsigned int> offsets(n_rows);
+   std::vector<unsigned int> order;
+   order.reserve(n_rows);
+   for(unsigned int i = 0; i < n_rows; ++i) {
+      offsets[i] = m_rows[i].offset;
+      if(m_rows[i].capacity > 0)
+         order.push_back(i);
+   }
+   std::sort(order.begin(), order.end(), RowOffsetLess(offsets));
+
+   unsigned int next = 0;
+   for(unsigned int k = 0; k < order.size(); ++k) {
+      RowSpan& row = m_rows[order[k]];
+      if(row.offset != next && row.length > 0)
+         std::memmove(&m_slab[next], &m_slab[row.offset], row.length*sizeof(int));
+      row.offset = next;
+      next += row.capacity;
+   }
 
- return signum(m_indices[i][index_in_row]);
+   m_slab.resize(next);
+   m_wasted = 0;
 }
 
-unsigned int IncidenceMatrix::getColByIndex(unsigned int i, unsigned int index_in_row) const {
-  assert(i < n_rows);
-  assert(index_in_row < m_indices[i].size());
+unsigned int IncidenceMatrix::findInRow(unsigned int i, int colShift) const {
+   const int* row = rowData(i);
+   unsigned int len = m_rows[i].length;
+
+   if(!m_sorted) {
+      for(unsigned int k = 0; k < len; ++k)
+         if(std::abs(row[k]) == colShift)
+            return k;
+      return len;
+   }
+
+   if(len == 0)
+      return 0;
 
-  return abs(m_indices[i][index_in_row]) - 1;
+   //branch-free lower bound: the comparison only selects the next base, which compiles to a conditional move
+   const int* base = row;
+   unsigned int n = len;
+   while(n > 1) {
+      unsigned int half = n/2;
+      base = (std::abs(base[half]) < colShift) ? base + half : base;
+      n -= half;
+   }
+   base += (std::abs(*base) < colShift);
+
+   unsigned int k = base - row;
+   return (k < len && std::abs(row[k]) == colShift) ? k : len;
+}
+
+void IncidenceMatrix::setSortedRows(bool sorted) {
+   if(sorted && !m_sorted) {
+      for(unsigned int i = 0; i < n_rows; ++i) {
+         int* row = rowData(i);
+         std::sort(row, row + m_rows[i].length, absLess);
+      }
+   }
+   m_sorted = sorted;
 }
 
 void IncidenceMatrix::cycleRow(unsigned int i) {
-  int t = m_indices[i][0];
-  int row_len = m_indices[i].size();
+  assert(!m_sorted);
+  int* row = rowData(i);
+  int row_len = m_rows[i].length;
+  int t = row[0];
   for(int j = 0; j < row_len-1; ++j)
-    m_indices[i][j] = m_indices[i][j+1];
-  m_indices[i][row_len-1] = t;
+    row[j] = row[j+1];
+  row[row_len-1] = t;
 }
 
 void IncidenceMatrix::setByIndex(unsigned int i, unsigned int index_in_row, unsigned int col, int value) {
    assert(value == 1 || value == -1);
-   if(index_in_row >= m_indices[i].size()) m_indices[i].resize(index_in_row+1);
-  
-   m_indices[i][index_in_row] = (col+1)*value;
+   assert(!m_sorted);
+   if(index_in_row >= m_rows[i].length) {
+      reserveRow(i, index_in_row+1);
+      int* row = rowData(i);
+      for(unsigned int k = m_rows[i].length; k < index_in_row; ++k)
+         row[k] = 0;
+      m_rows[i].length = index_in_row+1;
+   }
+
+   rowData(i)[index_in_row] = (col+1)*value;
 }
 
 void IncidenceMatrix::set(unsigned int i, unsigned int j, int new_val) {
@@ -60,60 +293,74 @@ void IncidenceMatrix::set(unsigned int i, unsigned int j, int new_val) {
    }
 
    assert(new_val == 1 || new_val == -1);
-  
+
    int colShift = j+1;
-   bool found = false;
-   for(unsigned int cur = 0; cur < m_indices[i].size(); ++cur) {
-     if(abs(m_indices[i][cur]) == (int)colShift ) {
-        m_indices[i][cur] = signum(new_val)*colShift;
-        found = true;
-        break;
-     }
+   unsigned int len = m_rows[i].length;
+   unsigned int k = findInRow(i, colShift);
+   if(k < len) {
+      rowData(i)[k] = signum(new_val)*colShift;
+      return;
+   }
+
+   reserveRow(i, len+1);
+   int* row = rowData(i);
+   m_rows[i].length = len+1;
+
+   if(!m_sorted) {
+      row[len] = signum(new_val)*colShift;
+      return;
    }
-   if(!found)
-      m_indices[i].push_back(signum(new_val)*colShift);
-   
+
+   //shift larger columns up to open a gap at the sorted position
+   unsigned int pos = len;
+   while(pos > 0 && std::abs(row[pos-1]) > colShift) {
+      row[pos] = row[pos-1];
+      --pos;
+   }
+   row[pos] = signum(new_val)*colShift;
 }
 
 int IncidenceMatrix::get(unsigned int i, unsigned int j) const {
    assert(i < n_rows && j < n_cols);
-  
-   int colShift = j+1;
-   for(unsigned int k=0; k<m_indices[i].size(); ++k){
-      if(abs(m_indices[i][k])==(int)colShift){
-         return signum(m_indices[i][k]);
-      }
-   }
-   return 0;
+
+   unsigned int k = findInRow(i, j+1);
+   return k < m_rows[i].length ? signum(rowData(i)[k]) : 0;
 }
 
 void IncidenceMatrix::remove(unsigned int i, unsigned int j) {
    assert(i<n_rows && j < n_cols);
 
-   int colShift = j+1;
-   for(unsigned int k=0; k<m_indices[i].size(); ++k){
-      if(abs(m_indices[i][k])==colShift){
-         m_indices[i].erase(m_indices[i].begin()+k);
-         return;
-      }
-   }
+   unsigned int len = m_rows[i].length;
+   unsigned int k = findInRow(i, j+1);
+   if(k == len)
+      return;
+
+   int* row = rowData(i);
+   for(unsigned int m = k; m < len-1; ++m)
+      row[m] = row[m+1];
+   m_rows[i].length = len-1;
+
+   //a spilled row that has shrunk well below the inline width can go back home
+   if(m_rows[i].capacity > 0 && m_inlineWidth > 0 && len-1 <= m_inlineWidth/2)
+      moveRowInline(i);
 }
 
 bool IncidenceMatrix::exists(unsigned int i, unsigned int j) const {
    assert(i<n_rows && j < n_cols);
-  
-   int colShift = j+1;
-   for(unsigned int k=0; k<m_indices[i].size(); ++k){
-      if(abs(m_indices[i][k])==colShift){
-         return true;
-      }
-   }
-   return false;
+
+   return findInRow(i, j+1) < m_rows[i].length;
 }
 
 void IncidenceMatrix::addRows(unsigned int rows) {
    n_rows += rows;
-   m_indices.resize(n_rows);
+   RowSpan empty = {0, 0, 0};
+   m_rows.resize(n_rows, empty);
+   m_inline.resize(n_rows*m_inlineWidth, 0);
+}
+
+void IncidenceMatrix::reserveRows(unsigned int rows) {
+   m_rows.reserve(rows);
+   m_inline.reserve(rows*m_inlineWidth);
 }
 
 void IncidenceMatrix::addCols(unsigned int cols) {
@@ -122,16 +369,18 @@ void IncidenceMatrix::addCols(unsigned int cols) {
 
 void IncidenceMatrix::zeroRow( unsigned int i )
 {
-   m_indices[i].clear();
+   //keep the row's capacity around, since dead slots tend to get reused
+   m_rows[i].length = 0;
 }
 
-void IncidenceMatrix::printMatrix() const 
+void IncidenceMatrix::printMatrix() const
 {
    printf("Dimensions (%d,%d):\n", n_rows, n_cols);
-   for(unsigned int row = 0; row < m_indices.size(); ++row) {
+   for(unsigned int row = 0; row < n_rows; ++row) {
       printf("%d: ", row);
-      for(unsigned int i = 0; i < m_indices[row].size(); ++i)
-        printf("%c%d ", m_indices[row][i] > 0?'+':'-', abs(m_indices[row][i])-1);
+      const int* data = rowData(row);
+      for(unsigned int i = 0; i < m_rows[row].length; ++i)
+        printf("%c%d ", data[i] > 0?'+':'-', std::abs(data[i])-1);
       printf("\n");
    }
 }
@@ -142,4 +391,4 @@ void IncidenceMatrix::zeroAll()
     zeroRow(i);
 }
 
-}
\ No newline at end of file
+}
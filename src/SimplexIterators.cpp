@@ -9,9 +9,9 @@ VertexIterator::VertexIterator(const SimplicialComplex& obj): m_obj(obj), m_idx(
 }
 
 void VertexIterator::advance() {
-   do {
-      m_idx++;
-   } while(m_idx < (int)m_obj.numVertexSlots() && !m_obj.m_V[m_idx]);
+   //skip straight over runs of dead slots
+   size_t next = m_obj.m_V.findNext(m_idx+1);
+   m_idx = next == OccupancyBitmap::npos ? (int)m_obj.numVertexSlots() : (int)next;
 }
 
 bool VertexIterator::done() const {
@@ -29,9 +29,9 @@ EdgeIterator::EdgeIterator(const SimplicialComplex& obj): m_obj(obj), m_idx(-1)
 }
 
 void EdgeIterator::advance() {
-   do {
-      m_idx++;
-   } while(m_idx < (int)m_obj.numEdgeSlots() && m_obj.m_EV.getNumEntriesInRow(m_idx) == 0);
+   //skip straight over runs of dead slots
+   size_t next = m_obj.m_E.findNext(m_idx+1);
+   m_idx = next == OccupancyBitmap::npos ? (int)m_obj.numEdgeSlots() : (int)next;
 }
 
 bool EdgeIterator::done() const {
@@ -49,9 +49,9 @@ FaceIterator::FaceIterator(const SimplicialComplex& obj): m_obj(obj), m_idx(-1)
 }
 
 void FaceIterator::advance() {
-   do {
-      m_idx++;
-   } while(m_idx < (int)m_obj.numFaceSlots() && m_obj.m_FE.getNumEntriesInRow(m_idx) == 0);
+   //skip straight over runs of dead slots
+   size_t next = m_obj.m_F.findNext(m_idx+1);
+   m_idx = next == OccupancyBitmap::npos ? (int)m_obj.numFaceSlots() : (int)next;
 }
 
 bool FaceIterator::done() const {
@@ -70,9 +70,9 @@ TetIterator::TetIterator(const SimplicialComplex& obj): m_obj(obj), m_idx(-1) {
 }
 
 void TetIterator::advance() {
-   do {
-      m_idx++;
-   } while(m_idx < (int)m_obj.numTetSlots() && m_obj.m_TF.getNumEntriesInRow(m_idx) == 0);
+   //skip straight over runs of dead slots
+   size_t next = m_obj.m_T.findNext(m_idx+1);
+   m_idx = next == OccupancyBitmap::npos ? (int)m_obj.numTetSlots() : (int)next;
 }
 
 bool TetIterator::done() const {
@@ -238,30 +238,41 @@ FaceHandle TetFaceIterator::current() const {
 }
 
 //VertexFaceIterator
-VertexFaceIterator::VertexFaceIterator(const SimplicialComplex& obj, const VertexHandle& vh) : m_obj(obj) {
+VertexFaceIterator::VertexFaceIterator(const SimplicialComplex& obj, const VertexHandle& vh) : m_obj(obj), m_idx(0) {
   
-   //build the set of (unique) faces
-   for(VertexEdgeIterator veit(m_obj, vh); !veit.done(); veit.advance())
-      for(EdgeFaceIterator efit(m_obj, veit.current()); !efit.done(); efit.advance())
-         m_faces.insert(efit.current());
+   //collect each face once, from the lowest-numbered of its edges at vh
+   for(VertexEdgeIterator veit(m_obj, vh); !veit.done(); veit.advance()) {
+      int edge = veit.current().idx();
+      for(EdgeFaceIterator efit(m_obj, veit.current()); !efit.done(); efit.advance()) {
+         int face = efit.current().idx();
+         bool lowest = true;
+         for(unsigned int i = 0; i < m_obj.m_FE.getNumEntriesInRow(face) && lowest; ++i) {
+            int other = m_obj.m_FE.getColByIndex(face, i);
+            if(other < edge && ((int)m_obj.m_EV.getColByIndex(other, 0) == vh.idx() || (int)m_obj.m_EV.getColByIndex(other, 1) == vh.idx()))
+               lowest = false;
+         }
+         if(lowest)
+            m_faces.push_back(face);
+      }
+   }
 
-   //...and set up an iterator
-   m_fiter = m_faces.begin();
+   //...in increasing order
+   m_faces.sortUnique();
 }
 
 
 void VertexFaceIterator::advance() {
    if(!done())
-      ++m_fiter;
+      ++m_idx;
 }
 
 bool VertexFaceIterator::done() const {
-   return m_fiter == m_faces.end();
+   return m_idx >= m_faces.size();
 }
 
 FaceHandle VertexFaceIterator::current() const {
    if(!done())
-      return *m_fiter;
+      return FaceHandle(m_faces[m_idx]);
    else
       return FaceHandle::invalid();
 }
@@ -289,31 +300,45 @@ VertexHandle FaceVertexIterator::current() const {
 }
 
 //VertexTetIterator
-VertexTetIterator::VertexTetIterator(const SimplicialComplex& obj, const VertexHandle& vh) : m_obj(obj) {
-
-   //build the set of (unique) tets
-   for(VertexEdgeIterator veit(m_obj, vh); !veit.done(); veit.advance())
-      for(EdgeFaceIterator efit(m_obj, veit.current()); !efit.done(); efit.advance())
-         for(FaceTetIterator ftit(m_obj, efit.current()); !ftit.done(); ftit.advance())
-            m_tets.insert(ftit.current());  
+VertexTetIterator::VertexTetIterator(const SimplicialComplex& obj, const VertexHandle& vh) : m_obj(obj), m_idx(0) {
+
+   //the (unique, sorted) faces around the vertex
+   SmallIndexList faces;
+   for(VertexFaceIterator vfit(m_obj, vh); !vfit.done(); vfit.advance())
+      faces.push_back(vfit.current().idx());
+
+   //collect each tet once, from the lowest-numbered of its faces at vh
+   for(unsigned int f = 0; f < faces.size(); ++f) {
+      for(FaceTetIterator ftit(m_obj, FaceHandle(faces[f])); !ftit.done(); ftit.advance()) {
+         int tet = ftit.current().idx();
+         bool lowest = true;
+         for(unsigned int i = 0; i < m_obj.m_TF.getNumEntriesInRow(tet) && lowest; ++i) {
+            int other = m_obj.m_TF.getColByIndex(tet, i);
+            if(other < faces[f] && faces.contains(other))
+               lowest = false;
+         }
+         if(lowest)
+            m_tets.push_back(tet);
+      }
+   }
 
-   //...and set up an iterator
-   m_titer = m_tets.begin();
+   //...in increasing order
+   m_tets.sortUnique();
 }
 
 
 void VertexTetIterator::advance() {
    if(!done())
-      ++m_titer;
+      ++m_idx;
 }
 
 bool VertexTetIterator::done() const {
-   return m_titer == m_tets.end();
+   return m_idx >= m_tets.size();
 }
 
 TetHandle VertexTetIterator::current() const {
    if(!done())
-      return *m_titer;
+      return TetHandle(m_tets[m_idx]);
    else
       return TetHandle::invalid();
 }
@@ -321,61 +346,67 @@ TetHandle VertexTetIterator::current() const {
 
 //TetVertexIterator
 TetVertexIterator::TetVertexIterator(const SimplicialComplex& obj, const TetHandle& th) : 
-m_obj(obj)
+m_obj(obj), m_count(0), m_idx(0)
 {
-   //build the set of (unique) vertices
-   for(TetFaceIterator tfit(m_obj, th); !tfit.done(); tfit.advance())
-      for(FaceEdgeIterator feit(m_obj, tfit.current(), false); !feit.done(); feit.advance())
-         for(EdgeVertexIterator evit(m_obj, feit.current(), false); !evit.done(); evit.advance())
-            m_verts.insert(evit.current());
-   
-   //...and set up an iterator
-   m_viter = m_verts.begin();
+   //gather the distinct vertices in place (two faces already hold all four)
+   const FixedIncidenceMatrix<4>& TF = m_obj.m_TF;
+   for(unsigned int f = 0; f < TF.getNumEntriesInRow(th.idx()) && m_count < 4; ++f) {
+      int face = TF.getColByIndex(th.idx(), f);
+      for(unsigned int e = 0; e < m_obj.m_FE.getNumEntriesInRow(face); ++e) {
+         int edge = m_obj.m_FE.getColByIndex(face, e);
+         for(int v = 0; v < 2; ++v) {
+            int vert = m_obj.m_EV.getColByIndex(edge, v);
+            if(std::find(m_verts, m_verts + m_count, vert) == m_verts + m_count && m_count < 4)
+               m_verts[m_count++] = vert;
+         }
+      }
+   }
 
+   //...in increasing order
+   std::sort(m_verts, m_verts + m_count);
 }
 
 void TetVertexIterator::advance() {
    if(!done())
-      ++m_viter;
+      ++m_idx;
 }
 
 bool TetVertexIterator::done() const {
-   return m_viter == m_verts.end();
+   return m_idx >= m_count;
 }
 
 VertexHandle TetVertexIterator::current() const {
    if(!done())
-      return *m_viter;
+      return VertexHandle(m_verts[m_idx]);
    else
       return VertexHandle::invalid();
 }
 
 
 //EdgeTetIterator
-EdgeTetIterator::EdgeTetIterator(const SimplicialComplex& obj, const EdgeHandle& eh) : m_obj(obj) {
+EdgeTetIterator::EdgeTetIterator(const SimplicialComplex& obj, const EdgeHandle& eh) : m_obj(obj), m_idx(0) {
 
-   //build the set of (unique) tets
+   //collect the tets (each shows up through its two faces at the edge), and de-duplicate
    for(EdgeFaceIterator efit(m_obj, eh); !efit.done(); efit.advance())
       for(FaceTetIterator ftit(m_obj, efit.current()); !ftit.done(); ftit.advance())
-         m_tets.insert(ftit.current());  
+         m_tets.push_back(ftit.current().idx());
 
-   //...and set up an iterator
-   m_titer = m_tets.begin();
+   m_tets.sortUnique();
 }
 
 
 void EdgeTetIterator::advance() {
    if(!done())
-      ++m_titer;
+      ++m_idx;
 }
 
 bool EdgeTetIterator::done() const {
-   return m_titer == m_tets.end();
+   return m_idx >= m_tets.size();
 }
 
 TetHandle EdgeTetIterator::current() const {
    if(!done())
-      return *m_titer;
+      return TetHandle(m_tets[m_idx]);
    else
       return TetHandle::invalid();
 }
@@ -383,32 +414,129 @@ TetHandle EdgeTetIterator::current() const {
 
 //TetEdgeIterator
 TetEdgeIterator::TetEdgeIterator(const SimplicialComplex& obj, const TetHandle& th) : 
-m_obj(obj)
+m_obj(obj), m_count(0), m_idx(0)
 {
-   //build the set of (unique) vertices
-   for(TetFaceIterator tfit(m_obj, th); !tfit.done(); tfit.advance())
-      for(FaceEdgeIterator feit(m_obj, tfit.current(), false); !feit.done(); feit.advance())
-         m_edges.insert(feit.current());
-
-   //...and set up an iterator
-   m_eiter = m_edges.begin();
+   //gather the distinct edges in place (three faces already hold all six)
+   const FixedIncidenceMatrix<4>& TF = m_obj.m_TF;
+   for(unsigned int f = 0; f < TF.getNumEntriesInRow(th.idx()) && m_count < 6; ++f) {
+      int face = TF.getColByIndex(th.idx(), f);
+      for(unsigned int e = 0; e < m_obj.m_FE.getNumEntriesInRow(face); ++e) {
+         int edge = m_obj.m_FE.getColByIndex(face, e);
+         if(std::find(m_edges, m_edges + m_count, edge) == m_edges + m_count && m_count < 6)
+            m_edges[m_count++] = edge;
+      }
+   }
 
+   //...in increasing order
+   std::sort(m_edges, m_edges + m_count);
 }
 
 void TetEdgeIterator::advance() {
    if(!done())
-      ++m_eiter;
+      ++m_idx;
 }
 
 bool TetEdgeIterator::done() const {
-   return m_eiter == m_edges.end();
+   return m_idx >= m_count;
 }
 
 EdgeHandle TetEdgeIterator::current() const {
    if(!done())
-      return *m_eiter;
+      return EdgeHandle(m_edges[m_idx]);
    else
       return EdgeHandle::invalid();
 }
 
-}
\ No newline at end of file
+
+//////////////////////////////////////////////////////////////////////////
+//Cached adjacency iterators
+
+//CachedVertexTetIterator
+CachedVertexTetIterator::CachedVertexTetIterator(const SimplicialComplex& obj, const VertexHandle& vh) : 
+m_cache(obj.adjacency(SimplicialComplex::VertexTets, vh.idx())), m_row(vh.idx()), m_idx(0)
+{
+   m_cache.row(m_row, m_count);
+}
+
+void CachedVertexTetIterator::advance() {
+   if(!done())
+      ++m_idx;
+}
+
+bool CachedVertexTetIterator::done() const {
+   return m_idx >= m_count;
+}
+
+TetHandle CachedVertexTetIterator::current() const {
+   //the row is looked up afresh, since reading other rows may have moved it (though not changed it)
+   unsigned int count;
+   return done() ? TetHandle::invalid() : TetHandle(m_cache.row(m_row, count)[m_idx]);
+}
+
+//CachedEdgeTetIterator
+CachedEdgeTetIterator::CachedEdgeTetIterator(const SimplicialComplex& obj, const EdgeHandle& eh) : 
+m_cache(obj.adjacency(SimplicialComplex::EdgeTets, eh.idx())), m_row(eh.idx()), m_idx(0)
+{
+   m_cache.row(m_row, m_count);
+}
+
+void CachedEdgeTetIterator::advance() {
+   if(!done())
+      ++m_idx;
+}
+
+bool CachedEdgeTetIterator::done() const {
+   return m_idx >= m_count;
+}
+
+TetHandle CachedEdgeTetIterator::current() const {
+   //the row is looked up afresh, since reading other rows may have moved it (though not changed it)
+   unsigned int count;
+   return done() ? TetHandle::invalid() : TetHandle(m_cache.row(m_row, count)[m_idx]);
+}
+
+//TetTetIterator
+TetTetIterator::TetTetIterator(const SimplicialComplex& obj, const TetHandle& th) : 
+m_cache(obj.adjacency(SimplicialComplex::TetTets, th.idx())), m_row(th.idx()), m_idx(0)
+{
+   m_cache.row(m_row, m_count);
+}
+
+void TetTetIterator::advance() {
+   if(!done())
+      ++m_idx;
+}
+
+bool TetTetIterator::done() const {
+   return m_idx >= m_count;
+}
+
+TetHandle TetTetIterator::current() const {
+   //the row is looked up afresh, since reading other rows may have moved it (though not changed it)
+   unsigned int count;
+   return done() ? TetHandle::invalid() : TetHandle(m_cache.row(m_row, count)[m_idx]);
+}
+
+//CachedVertexVertexIterator
+CachedVertexVertexIterator::CachedVertexVertexIterator(const SimplicialComplex& obj, const VertexHandle& vh) : 
+m_cache(obj.adjacency(SimplicialComplex::VertexVerts, vh.idx())), m_row(vh.idx()), m_idx(0)
+{
+   m_cache.row(m_row, m_count);
+}
+
+void CachedVertexVertexIterator::advance() {
+   if(!done())
+      ++m_idx;
+}
+
+bool CachedVertexVertexIterator::done() const {
+   return m_idx >= m_count;
+}
+
+VertexHandle CachedVertexVertexIterator::current() const {
+   //the row is looked up afresh, since reading other rows may have moved it (though not changed it)
+   unsigned int count;
+   return done() ? VertexHandle::invalid() : VertexHandle(m_cache.row(m_row, count)[m_idx]);
+}
+
+}
@@ -1,7 +1,11 @@
 #include "SimplicialComplex.h"
 #include "SimplexProperty.h"
 #include "SimplexIterators.h"
+#include "CompactComplex.h"
+#include "Parallel.h"
 
+#include <atomic>
+#include <cstdio>
 #include <iostream>
 #include <utility>
 #include <set>
@@ -17,6 +21,22 @@ namespace SimplexMesh {
    int SimplicialComplex::numFaces() const { return m_nFaces;}
 
    int SimplicialComplex::numTets() const { return m_nTets;}
+
+   VertexHandle SimplicialComplex::nthVertex(unsigned int k) const { return VertexHandle(k < m_V.count() ? (int)m_V.select(k) : -1); }
+
+   EdgeHandle SimplicialComplex::nthEdge(unsigned int k) const { return EdgeHandle(k < m_E.count() ? (int)m_E.select(k) : -1); }
+
+   FaceHandle SimplicialComplex::nthFace(unsigned int k) const { return FaceHandle(k < m_F.count() ? (int)m_F.select(k) : -1); }
+
+   TetHandle SimplicialComplex::nthTet(unsigned int k) const { return TetHandle(k < m_T.count() ? (int)m_T.select(k) : -1); }
+
+   unsigned int SimplicialComplex::rankOf(const VertexHandle& vh) const { return (unsigned int)m_V.rank(vh.idx()); }
+
+   unsigned int SimplicialComplex::rankOf(const EdgeHandle& eh) const { return (unsigned int)m_E.rank(eh.idx()); }
+
+   unsigned int SimplicialComplex::rankOf(const FaceHandle& fh) const { return (unsigned int)m_F.rank(fh.idx()); }
+
+   unsigned int SimplicialComplex::rankOf(const TetHandle& th) const { return (unsigned int)m_T.rank(th.idx()); }
    
    SimplicialComplex::SimplicialComplex()
    {
@@ -26,8 +46,248 @@ namespace SimplexMesh {
       m_nFaces = 0;
       m_nTets = 0;
 
+      m_vertCapacity = 0;
+      m_edgeCapacity = 0;
+      m_faceCapacity = 0;
+      m_tetCapacity = 0;
+
+      m_safetyChecks = false;
+      m_indexed = false;
+      m_slotListeners = 0;
+
+      //Typical upward valences (edges per vertex, faces per edge, tets per face) fit inline;
+      //only non-manifold hotspots spill into the matrices' shared overflow storage.
+      m_VE.setInlineWidth(8);
+      m_EF.setInlineWidth(4);
+      m_FT.setInlineWidth(2);
+
+   }
+
+
+   void SimplicialComplex::reserveVertices(unsigned int n) {
+      m_V.reserve(n);
+      m_VE.reserveRows(n);
+      reserveProperties(m_vertProperties, m_vertCapacity, n);
+   }
+
+   void SimplicialComplex::reserveEdges(unsigned int n) {
+      m_E.reserve(n);
+      m_EV.reserveRows(n);
+      m_EF.reserveRows(n);
+      reserveProperties(m_edgeProperties, m_edgeCapacity, n);
+   }
+
+   void SimplicialComplex::reserveFaces(unsigned int n) {
+      m_F.reserve(n);
+      m_FE.reserveRows(n);
+      m_FT.reserveRows(n);
+      reserveProperties(m_faceProperties, m_faceCapacity, n);
+   }
+
+   void SimplicialComplex::reserveTets(unsigned int n) {
+      m_T.reserve(n);
+      m_TF.reserveRows(n);
+      reserveProperties(m_tetProperties, m_tetCapacity, n);
+   }
+
+   void SimplicialComplex::reserveProperties(std::vector<SimplexPropertyBase*>& props, unsigned int& capacity, unsigned int n) {
+      if(n <= capacity)
+         return;
+      capacity = n;
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->resize(capacity);
+   }
+
+   void SimplicialComplex::growProperties(std::vector<SimplexPropertyBase*>& props, unsigned int& capacity, unsigned int slots) {
+      //grow geometrically, so the (virtual) resizes are amortized over many additions
+      if(slots > capacity)
+         reserveProperties(props, capacity, std::max(slots, 2*capacity));
+   }
+
+   //The key spanned by two n-vertex keys that differ in exactly one vertex (two edges of a face, or two faces of a tet).
+   //Returns false if they don't.
+   bool joinKeys(const SimplexKey& a, const SimplexKey& b, int n, SimplexKey& joined) {
+      int verts[4] = { a.v[0], a.v[1], a.v[2], -1 };
+      int count = n;
+      for(int i = 0; i < n; ++i) {
+         if(std::find(a.v, a.v+n, b.v[i]) != a.v+n) continue;
+         if(count == n+1) return false;
+         verts[count++] = b.v[i];
+      }
+      if(count != n+1) return false;
+      joined = n == 2 ? SimplexKey(verts[0], verts[1], verts[2]) : SimplexKey(verts[0], verts[1], verts[2], verts[3]);
+      return true;
+   }
+
+   SimplexKey SimplicialComplex::edgeKey(int edge) const {
+      return SimplexKey(m_EV.getColByIndex(edge, 0), m_EV.getColByIndex(edge, 1));
+   }
+
+   SimplexKey SimplicialComplex::faceKey(int face) const {
+      SimplexKey key;
+      bool valid = joinKeys(edgeKey(m_FE.getColByIndex(face, 0)), edgeKey(m_FE.getColByIndex(face, 1)), 2, key);
+      assert(valid);
+      return key;
+   }
+
+   SimplexKey SimplicialComplex::tetKey(int tet) const {
+      SimplexKey key;
+      bool valid = joinKeys(faceKey(m_TF.getColByIndex(tet, 0)), faceKey(m_TF.getColByIndex(tet, 1)), 3, key);
+      assert(valid);
+      return key;
+   }
+
+   void SimplicialComplex::setLookupIndex(bool enabled) {
+      m_indexed = enabled;
+      rebuildLookupIndex();
+   }
+
+   void SimplicialComplex::rebuildLookupIndex() {
+      m_edgeIndex.clear();
+      m_faceIndex.clear();
+      m_tetIndex.clear();
+      if(!m_indexed)
+         return;
+
+      m_edgeIndex.reserve(m_nEdges);
+      m_faceIndex.reserve(m_nFaces);
+      m_tetIndex.reserve(m_nTets);
+      for(unsigned int i = 0; i < numEdgeSlots(); ++i)
+         if(m_EV.getNumEntriesInRow(i) != 0) indexEdge(i);
+      for(unsigned int i = 0; i < numFaceSlots(); ++i)
+         if(m_FE.getNumEntriesInRow(i) != 0) indexFace(i);
+      for(unsigned int i = 0; i < numTetSlots(); ++i)
+         if(m_TF.getNumEntriesInRow(i) != 0) indexTet(i);
+   }
+
+   void SimplicialComplex::updateAdjacencyCaches() const {
+      unsigned int slots[AdjacencyKinds] = { numVertexSlots(), numEdgeSlots(), numTetSlots(), numVertexSlots() };
+      for(int k = 0; k < AdjacencyKinds; ++k)
+         for(unsigned int row = 0; row < slots[k]; ++row)
+            adjacency(AdjacencyKind(k), row);
+   }
+
+   void SimplicialComplex::clearAdjacencyCaches() {
+      for(int k = 0; k < AdjacencyKinds; ++k)
+         m_adjacency[k].clear();
+   }
+
+   void SimplicialComplex::staleTetAdjacency(int tet) {
+      if(m_adjacency[VertexTets].built()) {
+         int verts[4];
+         orientedTetVerts(tet, verts);
+         for(int i = 0; i < 4; ++i)
+            m_adjacency[VertexTets].markStale(verts[i]);
+      }
+      if(m_adjacency[EdgeTets].built()) {
+         int edges[6];
+         orientedTetEdges(tet, edges);
+         for(int i = 0; i < 6; ++i)
+            m_adjacency[EdgeTets].markStale(edges[i]);
+      }
+      if(m_adjacency[TetTets].built()) {
+         m_adjacency[TetTets].markStale(tet);
+         for(unsigned int f = 0; f < m_TF.getNumEntriesInRow(tet); ++f) {
+            int face = m_TF.getColByIndex(tet, f);
+            for(unsigned int t = 0; t < m_FT.getNumEntriesInRow(face); ++t)
+               m_adjacency[TetTets].markStale(m_FT.getColByIndex(face, t));
+         }
+      }
+   }
+
+   void SimplicialComplex::staleEdgeAdjacency(int edge) {
+      if(m_adjacency[VertexVerts].built()) {
+         m_adjacency[VertexVerts].markStale(m_EV.getColByIndex(edge, 0));
+         m_adjacency[VertexVerts].markStale(m_EV.getColByIndex(edge, 1));
+      }
+   }
+
+   const AdjacencyCache& SimplicialComplex::adjacency(AdjacencyKind kind, int row) const {
+      AdjacencyCache& cache = m_adjacency[kind];
+      unsigned int slots = (kind == VertexTets || kind == VertexVerts) ? numVertexSlots() : kind == EdgeTets ? numEdgeSlots() : numTetSlots();
+      if(cache.needsRebuild(slots))
+         rebuildAdjacency(kind);
+      if(cache.isStale(row)) {
+         SmallIndexList list;
+         gatherAdjacencyRow(kind, row, list);
+         std::vector<int> entries(list.size());
+         for(unsigned int i = 0; i < list.size(); ++i)
+            entries[i] = list[i];
+         cache.patch(row, entries.empty() ? 0 : &entries[0], list.size());
+      }
+      return cache;
+   }
+
+   void SimplicialComplex::gatherAdjacencyRow(AdjacencyKind kind, int row, SmallIndexList& out) const {
+      switch(kind) {
+      case VertexTets:
+         for(VertexTetIterator it(*this, VertexHandle(row)); !it.done(); it.advance())
+            out.push_back(it.current().idx());
+         break;
+      case EdgeTets:
+         for(EdgeTetIterator it(*this, EdgeHandle(row)); !it.done(); it.advance())
+            out.push_back(it.current().idx());
+         break;
+      case TetTets:
+         for(unsigned int f = 0; f < m_TF.getNumEntriesInRow(row); ++f) {
+            int face = m_TF.getColByIndex(row, f);
+            for(unsigned int t = 0; t < m_FT.getNumEntriesInRow(face); ++t)
+               if((int)m_FT.getColByIndex(face, t) != row)
+                  out.push_back(m_FT.getColByIndex(face, t));
+         }
+         out.sortUnique();
+         break;
+      case VertexVerts:
+         for(VertexVertexIterator it(*this, VertexHandle(row)); !it.done(); it.advance())
+            out.push_back(it.current().idx());
+         out.sortUnique();
+         break;
+      default:
+         break;
+      }
    }
 
+   void SimplicialComplex::rebuildAdjacency(AdjacencyKind kind) const {
+      std::vector<unsigned int> rowStart;
+      std::vector<int> entries;
+
+      if(kind == VertexTets || kind == EdgeTets) {
+         //counting sort of the tets' vertices (edges); scanning tets in order leaves every row sorted
+         const int per = kind == VertexTets ? 4 : 6;
+         unsigned int rows = kind == VertexTets ? numVertexSlots() : numEdgeSlots();
+         std::vector<int> members(per*numTetSlots(), -1);
+         rowStart.assign(rows+1, 0);
+         for(unsigned int t = 0; t < numTetSlots(); ++t) {
+            if(m_TF.getNumEntriesInRow(t) == 0) continue;
+            if(kind == VertexTets) orientedTetVerts(t, &members[per*t]);
+            else orientedTetEdges(t, &members[per*t]);
+            for(int i = 0; i < per; ++i)
+               ++rowStart[members[per*t+i]+1];
+         }
+         for(unsigned int r = 0; r < rows; ++r)
+            rowStart[r+1] += rowStart[r];
+         entries.resize(rowStart[rows]);
+         std::vector<unsigned int> fill(rowStart.begin(), rowStart.end()-1);
+         for(unsigned int t = 0; t < numTetSlots(); ++t)
+            for(int i = 0; i < per && members[per*t] >= 0; ++i)
+               entries[fill[members[per*t+i]]++] = t;
+      }
+      else {
+         //rows are short, so gather them one at a time
+         unsigned int rows = kind == TetTets ? numTetSlots() : numVertexSlots();
+         rowStart.reserve(rows+1);
+         rowStart.push_back(0);
+         for(unsigned int r = 0; r < rows; ++r) {
+            SmallIndexList list;
+            gatherAdjacencyRow(kind, r, list);
+            for(unsigned int i = 0; i < list.size(); ++i)
+               entries.push_back(list[i]);
+            rowStart.push_back((unsigned int)entries.size());
+         }
+      }
+
+      m_adjacency[kind].assign(rowStart, entries);
+   }
 
    bool SimplicialComplex::vertexExists(const VertexHandle& vertex) const {
       if(vertex.idx() < 0 || vertex.idx() >= (int)m_V.size())
@@ -37,25 +297,25 @@ namespace SimplexMesh {
    }
 
    bool SimplicialComplex::edgeExists(const EdgeHandle& edge) const {
-      if(edge.idx() < 0 || edge.idx() >= (int)m_EV.getNumRows())
+      if(edge.idx() < 0 || edge.idx() >= (int)m_E.size())
          return false;
       else
-         return m_EV.getNumEntriesInRow(edge.idx()) > 0;
+         return m_E[edge.idx()];
 
    }
 
    bool SimplicialComplex::faceExists(const FaceHandle& face) const {
-      if(face.idx() < 0 || face.idx() >= (int)m_FE.getNumRows())
+      if(face.idx() < 0 || face.idx() >= (int)m_F.size())
          return false;
       else
-         return m_FE.getNumEntriesInRow(face.idx()) > 0;
+         return m_F[face.idx()];
    }
 
    bool SimplicialComplex::tetExists(const TetHandle& tet) const {
-      if(tet.idx() < 0 || tet.idx() >= (int)m_TF.getNumRows())
+      if(tet.idx() < 0 || tet.idx() >= (int)m_T.size())
          return false;
       else
-         return m_TF.getNumEntriesInRow(tet.idx()) > 0;
+         return m_T[tet.idx()];
    }
 
    
@@ -77,6 +337,136 @@ namespace SimplexMesh {
       return m_EV.get(eh.idx(), vh.idx());
    }
 
+
+   void SimplicialComplex::orientedFaceVerts(int face, int out[3]) const {
+      //the first edge, in the face's direction, gives two vertices; the far end of the second edge the third
+      int e0 = m_FE.getColByIndex(face, 0), e1 = m_FE.getColByIndex(face, 1);
+      bool forward = m_FE.getValueByIndex(face, 0) > 0;
+      int a = m_EV.getColByIndex(e0, forward ? 0 : 1), b = m_EV.getColByIndex(e0, forward ? 1 : 0);
+      int c = m_EV.getColByIndex(e1, 0);
+      if(c == a || c == b)
+         c = m_EV.getColByIndex(e1, 1);
+
+      //rotate the lowest to the front
+      if(b < a && b < c) { out[0] = b; out[1] = c; out[2] = a; }
+      else if(c < a && c < b) { out[0] = c; out[1] = a; out[2] = b; }
+      else { out[0] = a; out[1] = b; out[2] = c; }
+   }
+
+   void SimplicialComplex::orientedTetVerts(int tet, int out[4]) const {
+      //a face, turned to match the tet, followed by the vertex opposite it
+      int face = m_TF.getColByIndex(tet, 0);
+      int tri[3];
+      orientedFaceVerts(face, tri);
+      bool inward = m_TF.getValueByIndex(tet, 0) < 0;
+      out[0] = tri[0]; out[1] = inward ? tri[1] : tri[2]; out[2] = inward ? tri[2] : tri[1];
+      int other = m_TF.getColByIndex(tet, 1);
+      for(unsigned int k = 0; k < 3; ++k) {
+         int edge = m_FE.getColByIndex(other, k);
+         for(unsigned int i = 0; i < 2; ++i) {
+            int vert = m_EV.getColByIndex(edge, i);
+            if(vert != tri[0] && vert != tri[1] && vert != tri[2])
+               out[3] = vert;
+         }
+      }
+
+      //only even permutations from here on: bring the lowest to the front with a double swap...
+      int lowest = (int)(std::min_element(out, out + 4) - out);
+      if(lowest != 0) {
+         std::swap(out[0], out[lowest]);
+         int a = lowest == 1 ? 2 : 1, b = lowest == 3 ? 2 : 3;
+         std::swap(out[a], out[b]);
+      }
+      //...then rotate the rest
+      while(out[1] > out[2] || out[1] > out[3]) {
+         int first = out[1];
+         out[1] = out[2]; out[2] = out[3]; out[3] = first;
+      }
+   }
+
+   void SimplicialComplex::orientedTetEdges(int tet, int out[6]) const {
+      static const int pairs[6][2] = { {0,1}, {0,2}, {0,3}, {1,2}, {1,3}, {2,3} };
+      int verts[4];
+      orientedTetVerts(tet, verts);
+
+      //match the tet's edges (each shared by two of its faces) to vertex pairs
+      for(unsigned int f = 0; f < 4; ++f) {
+         int face = m_TF.getColByIndex(tet, f);
+         for(unsigned int k = 0; k < 3; ++k) {
+            int edge = m_FE.getColByIndex(face, k);
+            int a = m_EV.getColByIndex(edge, 0), b = m_EV.getColByIndex(edge, 1);
+            for(int p = 0; p < 6; ++p) {
+               int u = verts[pairs[p][0]], v = verts[pairs[p][1]];
+               if((a == u && b == v) || (a == v && b == u))
+                  out[p] = edge;
+            }
+         }
+      }
+   }
+
+   void SimplicialComplex::getFaceVertices(const FaceHandle& fh, VertexHandle out[3]) const {
+      assert(faceExists(fh));
+      int verts[3];
+      orientedFaceVerts(fh.idx(), verts);
+      for(int i = 0; i < 3; ++i)
+         out[i] = VertexHandle(verts[i]);
+   }
+
+   void SimplicialComplex::getTetVertices(const TetHandle& th, VertexHandle out[4]) const {
+      assert(tetExists(th));
+      int verts[4];
+      orientedTetVerts(th.idx(), verts);
+      for(int i = 0; i < 4; ++i)
+         out[i] = VertexHandle(verts[i]);
+   }
+
+   void SimplicialComplex::getTetEdges(const TetHandle& th, EdgeHandle out[6]) const {
+      assert(tetExists(th));
+      int edges[6];
+      orientedTetEdges(th.idx(), edges);
+      for(int i = 0; i < 6; ++i)
+         out[i] = EdgeHandle(edges[i]);
+   }
+
+   void SimplicialComplex::gatherFaceVertices(const FaceHandle* faces, size_t begin, size_t end, int* out) const {
+      for(size_t i = begin; i < end; ++i)
+         orientedFaceVerts(faces[i].idx(), out + 3*i);
+   }
+
+   void SimplicialComplex::gatherTetVertices(const TetHandle* tets, size_t begin, size_t end, int* out) const {
+      for(size_t i = begin; i < end; ++i)
+         orientedTetVerts(tets[i].idx(), out + 4*i);
+   }
+
+   void SimplicialComplex::gatherTetEdges(const TetHandle* tets, size_t begin, size_t end, int* out) const {
+      for(size_t i = begin; i < end; ++i)
+         orientedTetEdges(tets[i].idx(), out + 6*i);
+   }
+
+   //A block of a batched gather, run by parallelFor
+   template<class Handle>
+   struct GatherBlock {
+      typedef void (SimplicialComplex::*Gather)(const Handle*, size_t, size_t, int*) const;
+      const SimplicialComplex& obj;
+      Gather gather;
+      const Handle* handles;
+      int* out;
+      GatherBlock(const SimplicialComplex& o, Gather g, const Handle* h, int* result) : obj(o), gather(g), handles(h), out(result) {}
+      void operator()(size_t begin, size_t end) const { (obj.*gather)(handles, begin, end, out); }
+   };
+
+   void SimplicialComplex::getFaceVertices(const FaceHandle* faces, size_t count, int* out) const {
+      parallelFor(count, GatherBlock<FaceHandle>(*this, &SimplicialComplex::gatherFaceVertices, faces, out));
+   }
+
+   void SimplicialComplex::getTetVertices(const TetHandle* tets, size_t count, int* out) const {
+      parallelFor(count, GatherBlock<TetHandle>(*this, &SimplicialComplex::gatherTetVertices, tets, out));
+   }
+
+   void SimplicialComplex::getTetEdges(const TetHandle* tets, size_t count, int* out) const {
+      parallelFor(count, GatherBlock<TetHandle>(*this, &SimplicialComplex::gatherTetEdges, tets, out));
+   }
+
    
    bool SimplicialComplex::isIncident(const VertexHandle& vh, const EdgeHandle& eh) const {
      return m_EV.get(eh.idx(), vh.idx()) != 0;
@@ -102,7 +492,7 @@ namespace SimplexMesh {
 
          //add the vertex to the data/property array
          m_V.push_back(true);
-         for(unsigned int i = 0; i < m_vertProperties.size(); ++i) m_vertProperties[i]->resize(m_V.size());
+         growProperties(m_vertProperties, m_vertCapacity, m_V.size());
 
          new_index = m_V.size()-1;
       }
@@ -112,10 +502,11 @@ namespace SimplexMesh {
 
          assert(!m_V[new_index]);
 
-         m_V[new_index] = true;
+         m_V.set(new_index);
       }
 
       m_nVerts += 1;
+      markChanged(m_vertProperties, new_index, new_index+1);
 
       return VertexHandle(new_index);
    }
@@ -134,7 +525,9 @@ namespace SimplexMesh {
       if(m_safetyChecks) {
 
          //full duplication: check if any edge joining these vertices already exists
-         for(unsigned int i = 0; i < m_VE.getNumEntriesInRow(v0.idx()); ++i) {
+         if(m_indexed && getEdge(v0, v1).isValid())
+            return EdgeHandle::invalid();
+         for(unsigned int i = 0; !m_indexed && i < m_VE.getNumEntriesInRow(v0.idx()); ++i) {
             int edgeID = m_VE.getColByIndex(v0.idx(), i);
             for(unsigned int j = 0; j < m_EV.getNumEntriesInRow(edgeID); ++j){
                int vertID = m_EV.getColByIndex(edgeID, j);
@@ -154,11 +547,12 @@ namespace SimplexMesh {
 
          m_EV.addRows(1);
          m_VE.addCols(1);
+         m_E.push_back(false);
 
          new_index = m_EV.getNumRows()-1;
 
          //add property slots for the new edge
-         for(unsigned int i = 0; i < m_edgeProperties.size(); ++i) m_edgeProperties[i]->resize(m_EV.getNumRows());
+         growProperties(m_edgeProperties, m_edgeCapacity, m_EV.getNumRows());
 
          assert(m_EV.getNumRows() == m_VE.getNumCols());
          assert(m_EV.getNumCols() == m_VE.getNumRows());
@@ -170,6 +564,7 @@ namespace SimplexMesh {
          new_index = m_deadEdges.back();
          m_deadEdges.pop_back();
       }
+      m_E.set(new_index);
 
       //build new edge connectivity
       //choose indices explicitly, to indicate ordering
@@ -178,9 +573,12 @@ namespace SimplexMesh {
       
       m_VE.set(v0.idx(), new_index, -1);
       m_VE.set(v1.idx(), new_index, 1);
+      indexEdge(new_index);
+      staleEdgeAdjacency(new_index);
 
       //adjust edge count
       m_nEdges += 1;
+      markChanged(m_edgeProperties, new_index, new_index+1);
 
       return EdgeHandle(new_index);
    }
@@ -200,8 +598,9 @@ namespace SimplexMesh {
       
       if(m_safetyChecks) {
 
-         //check if a duplicate face already exists (including partial matches and reversed orientations)
-         for(unsigned int i = 0; i < m_EF.getNumEntriesInRow(e0.idx()); ++i) {
+         //check if a duplicate face already exists (including partial matches and reversed orientations).
+         //With the index this is a lookup on the face's vertices, after the checks below.
+         for(unsigned int i = 0; !m_indexed && i < m_EF.getNumEntriesInRow(e0.idx()); ++i) {
             int faceInd = m_EF.getColByIndex(e0.idx(), i);
             for(unsigned int j = 0; j < m_FE.getNumEntriesInRow(faceInd); ++j) {
                int edgeInd = m_FE.getColByIndex(faceInd, j);
@@ -209,7 +608,7 @@ namespace SimplexMesh {
                   return FaceHandle::invalid();
             }
          }
-         for(unsigned int i = 0; i < m_EF.getNumEntriesInRow(e1.idx()); ++i) {
+         for(unsigned int i = 0; !m_indexed && i < m_EF.getNumEntriesInRow(e1.idx()); ++i) {
             int faceInd = m_EF.getColByIndex(e1.idx(), i);
             for(unsigned int j = 0; j < m_FE.getNumEntriesInRow(faceInd); ++j) {
                int edgeInd = m_FE.getColByIndex(faceInd, j);
@@ -217,7 +616,7 @@ namespace SimplexMesh {
                   return FaceHandle::invalid();
             }
          }
-         for(unsigned int i = 0; i < m_EF.getNumEntriesInRow(e2.idx()); ++i) {
+         for(unsigned int i = 0; !m_indexed && i < m_EF.getNumEntriesInRow(e2.idx()); ++i) {
             int faceInd = m_EF.getColByIndex(e2.idx(), i);
             for(unsigned int j = 0; j < m_FE.getNumEntriesInRow(faceInd); ++j) {
                int edgeInd = m_FE.getColByIndex(faceInd, j);
@@ -241,6 +640,14 @@ namespace SimplexMesh {
                return FaceHandle::invalid();
             }
          }
+
+         //any face on the same vertices shares at least two edges with this one, or duplicates them
+         if(m_indexed) {
+            std::map<int,int>::iterator iter = vertList.begin();
+            int a = (iter++)->first, b = (iter++)->first, c = iter->first;
+            if(m_faceIndex.find(SimplexKey(a, b, c)) != SimplexIndex::npos)
+               return FaceHandle::invalid();
+         }
       }
 
       //get the next free face or add one
@@ -252,11 +659,12 @@ namespace SimplexMesh {
 
          m_FE.addRows(1);
          m_EF.addCols(1);
+         m_F.push_back(false);
 
          new_index = m_FE.getNumRows()-1;
 
          //allocate space for properties associated to the edge
-         for(unsigned int i = 0; i < m_faceProperties.size(); ++i) m_faceProperties[i]->resize(m_FE.getNumRows());
+         growProperties(m_faceProperties, m_faceCapacity, m_FE.getNumRows());
 
          assert(m_FE.getNumRows() == m_EF.getNumCols());
          assert(m_FE.getNumCols() == m_EF.getNumRows());
@@ -268,43 +676,19 @@ namespace SimplexMesh {
          new_index = m_deadFaces.back();
          m_deadFaces.pop_back();
       }
+      m_F.set(new_index);
 
-      //Signs are chosen to follow the ordering of edges provided as input,
-      //so we flip to ensure edge vertices connect properly.
-
-      //If the head of the first edge doesn't match either of the second edge's vertices, we must flip it,
-      //since we want it oriented towards the second edge.
-      bool flip0 = (toVertex(e0) != fromVertex(e1) && toVertex(e0) != toVertex(e1));
-
-      //Now determine the shared vertex between edges 0 and 1.
-      //Then flip edge1 if the shared_vertex is at the head; it should be at the tail.
-      VertexHandle shared_vert0_hnd = flip0? fromVertex(e0) : toVertex(e0);
-      bool flip1 = (shared_vert0_hnd != fromVertex(e1));
-
-      //Determine shared vertex between edge 1 and 2.
-      //Then flip edge2 if the shared_vertex is at the head.
-      VertexHandle shared_vert1_hnd = flip1 ? fromVertex(e1) : toVertex(e1);
-      bool flip2 = (shared_vert1_hnd != fromVertex(e2));
-
-      //build face connectivity
-      //get a unique ordering by arbitrarily choosing smallest index to go first
-      int smallest = std::min(std::min(e0.idx(), e1.idx()), e2.idx());
-      
-      //add'em in requested ordering
-      m_FE.setByIndex(new_index, 0, e0.idx(), flip0?-1:1);
-      m_FE.setByIndex(new_index, 1, e1.idx(), flip1?-1:1);
-      m_FE.setByIndex(new_index, 2, e2.idx(), flip2?-1:1);
-
-      //cycle to get the smallest one first, for consistency
-      while(m_FE.getColByIndex((unsigned int)new_index, (unsigned int)0) != (unsigned int)smallest)
-        m_FE.cycleRow(new_index);
+      int signs[3];
+      setFaceRow(new_index, e0, e1, e2, signs);
 
       //build the other one the usual way
-      m_EF.set(e0.idx(), new_index, flip0?-1:1);
-      m_EF.set(e1.idx(), new_index, flip1?-1:1);
-      m_EF.set(e2.idx(), new_index, flip2?-1:1);
+      m_EF.set(e0.idx(), new_index, signs[0]);
+      m_EF.set(e1.idx(), new_index, signs[1]);
+      m_EF.set(e2.idx(), new_index, signs[2]);
+      indexFace(new_index);
 
       m_nFaces += 1;
+      markChanged(m_faceProperties, new_index, new_index+1);
 
       return FaceHandle(new_index);
    }
@@ -327,14 +711,22 @@ namespace SimplexMesh {
          
          //check for tets that share 2 (or possibly more) of the same faces, since this isn't really valid when embedded in 3D.
          //[technically perhaps sharing 3 faces should be the no-no]
+         //Two faces of a tet span all four of its vertices, so with the index this is a lookup on the tet's vertices.
          FaceHandle faceList[4] = {f0, f1, f2, f3};
-         for(int i = 0; i < 4; ++i) {
+         if(m_indexed) {
+            SimplexKey key;
+            if(joinKeys(faceKey(f0.idx()), faceKey(f1.idx()), 3, key)) {
+               if(m_tetIndex.find(key) != SimplexIndex::npos)
+                  return TetHandle::invalid();
+            }
+         }
+         for(int i = 0; !m_indexed && i < 4; ++i) {
             FaceHandle curF = faceList[i];
             for(unsigned int j = 0; j < m_FT.getNumEntriesInRow(curF.idx()); ++j) {
                unsigned tetId = m_FT.getColByIndex(curF.idx(), j);
                for(unsigned int k = 0; k < m_TF.getNumEntriesInRow(tetId); ++k) {
                   int otherF = m_TF.getColByIndex(tetId, k);
-                  if(otherF == f0.idx() || otherF == f1.idx() || otherF == f2.idx() || otherF == f3.idx())
+                  if(otherF != curF.idx() && (otherF == f0.idx() || otherF == f1.idx() || otherF == f2.idx() || otherF == f3.idx()))
                      return TetHandle::invalid();
                }
             }
@@ -366,11 +758,12 @@ namespace SimplexMesh {
          //create new tet
          m_TF.addRows(1);
          m_FT.addCols(1);
+         m_T.push_back(false);
 
          new_index = m_TF.getNumRows()-1;
 
          //allocate space for the properties
-         for(unsigned int i = 0; i < m_tetProperties.size(); ++i) m_tetProperties[i]->resize(m_TF.getNumRows());
+         growProperties(m_tetProperties, m_tetCapacity, m_TF.getNumRows());
 
          assert(m_FT.getNumRows() == m_TF.getNumCols());
          assert(m_FT.getNumCols() == m_TF.getNumRows());
@@ -380,7 +773,65 @@ namespace SimplexMesh {
          new_index = m_deadTets.back();
          m_deadTets.pop_back();
       }
+      m_T.set(new_index);
+
+      int signs[4];
+      setTetRow(new_index, f0, f1, f2, f3, flip_face0, signs);
+
+      m_FT.set(f0.idx(), new_index, signs[0]);
+      m_FT.set(f1.idx(), new_index, signs[1]);
+      m_FT.set(f2.idx(), new_index, signs[2]);
+      m_FT.set(f3.idx(), new_index, signs[3]);
+      indexTet(new_index);
+      staleTetAdjacency(new_index);
+
+      m_nTets += 1;
+      markChanged(m_tetProperties, new_index, new_index+1);
+
+      //invalidate the relevant cached neighbour data
 
+      return TetHandle(new_index);
+   }
+
+   void SimplicialComplex::setFaceRow(int face, const EdgeHandle& e0, const EdgeHandle& e1, const EdgeHandle& e2, int signs[3]) {
+      //Signs are chosen to follow the ordering of edges provided as input,
+      //so we flip to ensure edge vertices connect properly.
+
+      //If the head of the first edge doesn't match either of the second edge's vertices, we must flip it,
+      //since we want it oriented towards the second edge.
+      bool flip0 = (toVertex(e0) != fromVertex(e1) && toVertex(e0) != toVertex(e1));
+
+      //Now determine the shared vertex between edges 0 and 1.
+      //Then flip edge1 if the shared_vertex is at the head; it should be at the tail.
+      VertexHandle shared_vert0_hnd = flip0? fromVertex(e0) : toVertex(e0);
+      bool flip1 = (shared_vert0_hnd != fromVertex(e1));
+
+      //Determine shared vertex between edge 1 and 2.
+      //Then flip edge2 if the shared_vertex is at the head.
+      VertexHandle shared_vert1_hnd = flip1 ? fromVertex(e1) : toVertex(e1);
+      bool flip2 = (shared_vert1_hnd != fromVertex(e2));
+
+      //build face connectivity
+      //get a unique ordering by arbitrarily choosing smallest index to go first
+      int smallest = std::min(std::min(e0.idx(), e1.idx()), e2.idx());
+      
+      //add'em in requested ordering
+      m_FE.setByIndex(face, 0, e0.idx(), flip0?-1:1);
+      m_FE.setByIndex(face, 1, e1.idx(), flip1?-1:1);
+      m_FE.setByIndex(face, 2, e2.idx(), flip2?-1:1);
+
+      //cycle to get the smallest one first, for consistency
+      while(m_FE.getColByIndex((unsigned int)face, (unsigned int)0) != (unsigned int)smallest)
+        m_FE.cycleRow(face);
+
+      signs[0] = flip0?-1:1;
+      signs[1] = flip1?-1:1;
+      signs[2] = flip2?-1:1;
+   }
+
+   void SimplicialComplex::setTetRow(int tet, const FaceHandle& f0, const FaceHandle& f1, const FaceHandle& f2, const FaceHandle& f3,
+      bool flip_face0, int signs[4])
+   {
       //Need to figure out signs to be consistent with the choice of the first face
 
       //Determine the shared edge between two adjacent faces. Flip the 2nd so its direction is opposed (signs differ) after the flips.
@@ -397,21 +848,15 @@ namespace SimplexMesh {
          m_FE.get(f0.idx(), shared_edge2.idx()) != m_FE.get(f3.idx(), shared_edge1.idx());
 
       //build tet connectivity
-      m_TF.set(new_index, f0.idx(), flip_face0?1:-1);
-      m_TF.set(new_index, f1.idx(), flip1?1:-1);
-      m_TF.set(new_index, f2.idx(), flip2?1:-1);
-      m_TF.set(new_index, f3.idx(), flip3?1:-1);
+      m_TF.set(tet, f0.idx(), flip_face0?1:-1);
+      m_TF.set(tet, f1.idx(), flip1?1:-1);
+      m_TF.set(tet, f2.idx(), flip2?1:-1);
+      m_TF.set(tet, f3.idx(), flip3?1:-1);
 
-      m_FT.set(f0.idx(), new_index, flip_face0?1:-1);
-      m_FT.set(f1.idx(), new_index, flip1?1:-1);
-      m_FT.set(f2.idx(), new_index, flip2?1:-1);
-      m_FT.set(f3.idx(), new_index, flip3?1:-1);
-
-      m_nTets += 1;
-
-      //invalidate the relevant cached neighbour data
-
-      return TetHandle(new_index);
+      signs[0] = flip_face0?1:-1;
+      signs[1] = flip1?1:-1;
+      signs[2] = flip2?1:-1;
+      signs[3] = flip3?1:-1;
    }
 
    FaceHandle SimplicialComplex::addFace(const VertexHandle& v0, const VertexHandle& v1, const VertexHandle& v2)
@@ -469,6 +914,335 @@ namespace SimplexMesh {
 
 
 
+   //Random access to the edge and face occurrences of a simplex soup, in the order in which adding the segments,
+   //then triangles, then tets one at a time would meet them.
+   struct SimplexSoup {
+      const int *tv, *fv, *ev;
+      size_t numTets, numTris, numSegs;
+
+      size_t numEdgeOccurrences() const { return numSegs + 3*numTris + 6*numTets; }
+      size_t numFaceOccurrences() const { return numTris + 4*numTets; }
+
+      //Vertices of an edge occurrence, in the direction it would be created
+      void edge(size_t pos, int v[2]) const {
+         static const int triEdges[3][2] = { {0,1}, {2,0}, {1,2} }; //as in addFace(v0,v1,v2)
+         static const int tetEdges[6][2] = { {0,1}, {0,2}, {0,3}, {1,2}, {1,3}, {2,3} }; //as in addTet(v0,v1,v2,v3)
+         if(pos < numSegs) {
+            v[0] = ev[2*pos]; v[1] = ev[2*pos+1];
+            return;
+         }
+         pos -= numSegs;
+         if(pos < 3*numTris) {
+            const int* f = fv + 3*(pos/3);
+            v[0] = f[triEdges[pos%3][0]]; v[1] = f[triEdges[pos%3][1]];
+            return;
+         }
+         pos -= 3*numTris;
+         const int* t = tv + 4*(pos/6);
+         v[0] = t[tetEdges[pos%6][0]]; v[1] = t[tetEdges[pos%6][1]];
+      }
+
+      //Vertices of a face occurrence (unordered)
+      void face(size_t pos, int v[3]) const {
+         static const int tetFaceSkips[4] = { 2, 0, 3, 1 }; //the vertex opposite each face of addTet(v0,v1,v2,v3)
+         if(pos < numTris) {
+            v[0] = fv[3*pos]; v[1] = fv[3*pos+1]; v[2] = fv[3*pos+2];
+            return;
+         }
+         pos -= numTris;
+         const int* t = tv + 4*(pos/4);
+         for(int i = 0, k = 0; i < 4; ++i)
+            if(i != tetFaceSkips[pos%4]) v[k++] = t[i];
+      }
+
+      //Edge occurrences making up a face occurrence, in the order addFace receives them
+      void faceEdges(size_t pos, size_t e[3]) const {
+         static const int triFaceEdges[3] = { 0, 2, 1 };
+         static const int tetFaceEdges[4][3] = { {0,2,4}, {3,4,5}, {0,1,3}, {1,2,5} };
+         if(pos < numTris) {
+            for(int k = 0; k < 3; ++k) e[k] = numSegs + 3*pos + triFaceEdges[k];
+            return;
+         }
+         pos -= numTris;
+         for(int k = 0; k < 3; ++k) e[k] = numSegs + 3*numTris + 6*(pos/4) + tetFaceEdges[pos%4][k];
+      }
+   };
+
+   //Sort keys for the soup's occurrences: the smallest vertex, and the remaining (sorted) vertices packed together.
+   struct EdgeOccurrenceKey {
+      const SimplexSoup& soup;
+      EdgeOccurrenceKey(const SimplexSoup& s) : soup(s) {}
+      void operator()(size_t pos, int& lead, unsigned long long& rest) const {
+         int v[2];
+         soup.edge(pos, v);
+         lead = std::min(v[0], v[1]);
+         rest = (unsigned long long)std::max(v[0], v[1]);
+      }
+   };
+
+   struct FaceOccurrenceKey {
+      const SimplexSoup& soup;
+      FaceOccurrenceKey(const SimplexSoup& s) : soup(s) {}
+      void operator()(size_t pos, int& lead, unsigned long long& rest) const {
+         int v[3];
+         soup.face(pos, v);
+         std::sort(v, v+3);
+         lead = v[0];
+         rest = ((unsigned long long)v[1] << 32) | (unsigned long long)v[2];
+      }
+   };
+
+   //Number the distinct simplices among n occurrences, in order of first appearance. Occurrences are bucketed on
+   //their smallest vertex with a counting sort, and each (small) bucket is then sorted on the rest of its key.
+   //On return, ids[pos] is the number given to occurrence pos, and firsts lists each simplex's first occurrence.
+   template<class KeyFunc>
+   void numberOccurrences(size_t n, int numVerts, const KeyFunc& key, std::vector<unsigned int>& ids, std::vector<unsigned int>& firsts) {
+      int lead;
+      unsigned long long rest;
+
+      std::vector<unsigned int> bucketStart(numVerts+1, 0);
+      for(size_t pos = 0; pos < n; ++pos) {
+         key(pos, lead, rest);
+         ++bucketStart[lead+1];
+      }
+      for(int v = 0; v < numVerts; ++v)
+         bucketStart[v+1] += bucketStart[v];
+
+      std::vector< std::pair<unsigned long long, unsigned int> > sorted(n);
+      {
+         std::vector<unsigned int> fill(bucketStart.begin(), bucketStart.end()-1);
+         for(size_t pos = 0; pos < n; ++pos) {
+            key(pos, lead, rest);
+            sorted[fill[lead]++] = std::make_pair(rest, (unsigned int)pos);
+         }
+      }
+
+      //point every occurrence at the first one with the same key
+      ids.resize(n);
+      for(int v = 0; v < numVerts; ++v) {
+         std::sort(sorted.begin() + bucketStart[v], sorted.begin() + bucketStart[v+1]);
+         for(unsigned int i = bucketStart[v], first = i; i < bucketStart[v+1]; ++i) {
+            if(sorted[i].first != sorted[first].first) first = i;
+            ids[sorted[i].second] = sorted[first].second;
+         }
+      }
+      std::vector< std::pair<unsigned long long, unsigned int> >().swap(sorted);
+
+      //then number in order of first appearance (earlier entries have already been turned into numbers)
+      firsts.clear();
+      for(size_t pos = 0; pos < n; ++pos) {
+         if(ids[pos] == pos) {
+            ids[pos] = firsts.size();
+            firsts.push_back(pos);
+         }
+         else
+            ids[pos] = ids[ids[pos]];
+      }
+   }
+
+   //The stages of a parallel counting-sort transpose of a downward matrix (see transposeInto). Counting and
+   //scattering go through atomic counters, so entries land in their upward rows in no particular order, and
+   //each row is then sorted.
+   template<unsigned int N>
+   struct TransposeCount {
+      const FixedIncidenceMatrix<N>& down;
+      std::vector< std::atomic<unsigned int> >& counts;
+      TransposeCount(const FixedIncidenceMatrix<N>& d, std::vector< std::atomic<unsigned int> >& c) : down(d), counts(c) {}
+
+      void operator()(size_t begin, size_t end) const {
+         for(size_t r = begin; r < end; ++r)
+            for(unsigned int k = 0; k < down.getNumEntriesInRow(r); ++k)
+               counts[down.getColByIndex(r, k)].fetch_add(1, std::memory_order_relaxed);
+      }
+   };
+
+   template<unsigned int N>
+   struct TransposeScatter {
+      const FixedIncidenceMatrix<N>& down;
+      std::vector< std::atomic<unsigned int> >& fill;
+      std::vector<int>& entries;
+      TransposeScatter(const FixedIncidenceMatrix<N>& d, std::vector< std::atomic<unsigned int> >& f, std::vector<int>& e)
+         : down(d), fill(f), entries(e) {}
+
+      void operator()(size_t begin, size_t end) const {
+         for(size_t r = begin; r < end; ++r)
+            for(unsigned int k = 0; k < down.getNumEntriesInRow(r); ++k) {
+               unsigned int slot = fill[down.getColByIndex(r, k)].fetch_add(1, std::memory_order_relaxed);
+               entries[slot] = IncidenceMatrix::encode(r, down.getValueByIndex(r, k));
+            }
+      }
+   };
+
+   struct TransposeSortRows {
+      const std::vector<unsigned int>& rowStart;
+      std::vector<int>& entries;
+      TransposeSortRows(const std::vector<unsigned int>& starts, std::vector<int>& e) : rowStart(starts), entries(e) {}
+
+      void operator()(size_t begin, size_t end) const {
+         //upward rows are short, so insertion sort by column
+         for(size_t i = begin; i < end; ++i) {
+            for(unsigned int j = rowStart[i]+1; j < rowStart[i+1]; ++j) {
+               int entry = entries[j];
+               unsigned int k = j;
+               for(; k > rowStart[i] && std::abs(entries[k-1]) > std::abs(entry); --k)
+                  entries[k] = entries[k-1];
+               entries[k] = entry;
+            }
+         }
+      }
+   };
+
+   //Build an upward matrix as the transpose of a downward one, in parallel. Each row lists its entries in
+   //increasing column order, which is the order that incremental construction produces.
+   template<unsigned int N>
+   void transposeInto(const FixedIncidenceMatrix<N>& down, IncidenceMatrix& up, unsigned int upRows) {
+      std::vector< std::atomic<unsigned int> > counters(upRows);
+      for(unsigned int i = 0; i < upRows; ++i)
+         counters[i].store(0, std::memory_order_relaxed);
+      parallelFor(down.getNumRows(), TransposeCount<N>(down, counters));
+
+      std::vector<unsigned int> rowStart(upRows+1, 0);
+      for(unsigned int i = 0; i < upRows; ++i) {
+         rowStart[i+1] = rowStart[i] + counters[i].load(std::memory_order_relaxed);
+         counters[i].store(rowStart[i], std::memory_order_relaxed);
+      }
+
+      std::vector<int> entries(rowStart[upRows]);
+      parallelFor(down.getNumRows(), TransposeScatter<N>(down, counters, entries));
+      parallelFor(upRows, TransposeSortRows(rowStart, entries));
+
+      up.assignRows(upRows, down.getNumRows(), rowStart, entries);
+   }
+
+   void SimplicialComplex::rebuildTransposes() {
+      transposeInto(m_EV, m_VE, numVertexSlots());
+      transposeInto(m_FE, m_EF, numEdgeSlots());
+      transposeInto(m_TF, m_FT, numFaceSlots());
+   }
+
+   bool SimplicialComplex::buildFromTets(const int* tv, size_t n) {
+      return buildFromSimplices(tv, n, 0, 0, 0, 0);
+   }
+
+   bool SimplicialComplex::buildFromTriangles(const int* fv, size_t n) {
+      return buildFromSimplices(0, 0, fv, n, 0, 0);
+   }
+
+   bool SimplicialComplex::buildFromSegments(const int* ev, size_t n) {
+      return buildFromSimplices(0, 0, 0, 0, ev, n);
+   }
+
+   bool SimplicialComplex::buildFromSimplices(const int* tv, size_t numTets, const int* fv, size_t numTris, const int* ev, size_t numSegs) {
+      if(numVertexSlots() != 0 || numEdgeSlots() != 0 || numFaceSlots() != 0 || numTetSlots() != 0)
+         return false;
+
+      //validate the input, and find the number of vertices
+      int maxVert = -1;
+      const int* lists[3] = { ev, fv, tv };
+      size_t counts[3] = { numSegs, numTris, numTets };
+      for(int d = 0; d < 3; ++d) {
+         int size = d+2;
+         for(size_t i = 0; i < counts[d]; ++i) {
+            const int* verts = lists[d] + size*i;
+            for(int a = 0; a < size; ++a) {
+               if(verts[a] < 0) return false;
+               for(int b = 0; b < a; ++b)
+                  if(verts[a] == verts[b]) return false;
+               maxVert = std::max(maxVert, verts[a]);
+            }
+         }
+      }
+      int numVerts = maxVert+1;
+
+      SimplexSoup soup = { tv, fv, ev, numTets, numTris, numSegs };
+
+      //find the distinct edges and faces
+      std::vector<unsigned int> edgeIds, edgeFirsts, faceIds, faceFirsts;
+      numberOccurrences(soup.numEdgeOccurrences(), numVerts, EdgeOccurrenceKey(soup), edgeIds, edgeFirsts);
+      numberOccurrences(soup.numFaceOccurrences(), numVerts, FaceOccurrenceKey(soup), faceIds, faceFirsts);
+      unsigned int numEdges = edgeFirsts.size(), numFaces = faceFirsts.size();
+
+      //downward relations, each simplex set up from its first occurrence
+      m_V.assign(numVerts, true);
+      m_E.assign(numEdges, true);
+      m_F.assign(numFaces, true);
+      m_T.assign(numTets, true);
+
+      m_EV.addRows(numEdges);
+      m_EV.addCols(numVerts);
+      for(unsigned int e = 0; e < numEdges; ++e) {
+         int v[2];
+         soup.edge(edgeFirsts[e], v);
+         m_EV.setByIndex(e, 0, v[0], -1);
+         m_EV.setByIndex(e, 1, v[1], +1);
+      }
+
+      m_FE.addRows(numFaces);
+      m_FE.addCols(numEdges);
+      for(unsigned int f = 0; f < numFaces; ++f) {
+         size_t e[3];
+         soup.faceEdges(faceFirsts[f], e);
+         int signs[3];
+         setFaceRow(f, EdgeHandle(edgeIds[e[0]]), EdgeHandle(edgeIds[e[1]]), EdgeHandle(edgeIds[e[2]]), signs);
+      }
+
+      m_TF.addRows(numTets);
+      m_TF.addCols(numFaces);
+      for(unsigned int t = 0; t < numTets; ++t) {
+         const unsigned int* faces = &faceIds[numTris + 4*t];
+         int signs[4];
+         setTetRow(t, FaceHandle(faces[0]), FaceHandle(faces[1]), FaceHandle(faces[2]), FaceHandle(faces[3]), false, signs);
+      }
+
+      rebuildTransposes();
+
+      m_nVerts = numVerts;
+      m_nEdges = numEdges;
+      m_nFaces = numFaces;
+      m_nTets = numTets;
+
+      growProperties(m_vertProperties, m_vertCapacity, numVerts);
+      growProperties(m_edgeProperties, m_edgeCapacity, numEdges);
+      growProperties(m_faceProperties, m_faceCapacity, numFaces);
+      growProperties(m_tetProperties, m_tetCapacity, numTets);
+      markChanged(m_vertProperties, 0, numVerts);
+      markChanged(m_edgeProperties, 0, numEdges);
+      markChanged(m_faceProperties, 0, numFaces);
+      markChanged(m_tetProperties, 0, numTets);
+
+      rebuildLookupIndex();
+      clearAdjacencyCaches();
+
+      return true;
+   }
+
+   void SimplicialComplex::dropFromProperties(std::vector<SimplexPropertyBase*>& props, unsigned int slot) {
+      if(m_slotListeners == 0) return;
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->simplexDeleted(slot);
+   }
+
+   void SimplicialComplex::markChanged(std::vector<SimplexPropertyBase*>& props, unsigned int first, unsigned int last) {
+      if(m_slotListeners == 0 || first == last) return;
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->simplexChanged(first, last);
+   }
+
+   void SimplicialComplex::deriveProperties(std::vector<SimplexPropertyBase*>& props, int child, int parent) {
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->deriveSlot(child, parent);
+   }
+
+   void SimplicialComplex::interpolateProperties(std::vector<SimplexPropertyBase*>& props, int target, int a, int b) {
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->interpolateSlots(target, a, b);
+   }
+
+   void SimplicialComplex::mergeProperties(std::vector<SimplexPropertyBase*>& props, int target, int other) {
+      for(unsigned int i = 0; i < props.size(); ++i)
+         props[i]->mergeSlots(target, other);
+   }
+
    bool SimplicialComplex::deleteVertex(const VertexHandle& vertex)
    {
       if(!vertexExists(vertex))
@@ -479,8 +1253,9 @@ namespace SimplexMesh {
          return false;
 
       //set the vertex to inactive
-      m_V[vertex.idx()] = false;
+      m_V.reset(vertex.idx());
       m_deadVerts.push_back(vertex.idx());
+      dropFromProperties(m_vertProperties, vertex.idx());
 
       //adjust the vertex count
       m_nVerts -= 1;
@@ -497,6 +1272,9 @@ namespace SimplexMesh {
       if(m_EF.getNumEntriesInRow(edge.idx()) != 0)
          return false;
 
+      unindexEdge(edge.idx());
+      staleEdgeAdjacency(edge.idx());
+
       //determine the corresponding vertices
       for(unsigned int i = 0; i < m_EV.getNumEntriesInRow(edge.idx()); ++i) {
 
@@ -511,7 +1289,9 @@ namespace SimplexMesh {
 
       //...and delete the row
       m_EV.zeroRow(edge.idx());
+      m_E.reset(edge.idx());
       m_deadEdges.push_back(edge.idx());
+      dropFromProperties(m_edgeProperties, edge.idx());
 
       //adjust the edge count
       m_nEdges -= 1;
@@ -528,6 +1308,8 @@ namespace SimplexMesh {
       if(m_FT.getNumEntriesInRow(face.idx()) != 0)
          return false;
 
+      unindexFace(face.idx());
+
       //determine the corresponding edges
       for(unsigned int i = 0; i < m_FE.getNumEntriesInRow(face.idx()); ++i) {
 
@@ -542,7 +1324,9 @@ namespace SimplexMesh {
 
       //...and delete the row
       m_FE.zeroRow(face.idx());
+      m_F.reset(face.idx());
       m_deadFaces.push_back(face.idx());
+      dropFromProperties(m_faceProperties, face.idx());
 
       //adjust the face count
       m_nFaces -= 1;
@@ -557,6 +1341,9 @@ namespace SimplexMesh {
       //There are no higher dimensional simplices in 3D, so deleting the tet cannot introduce inconsistencies
       //as it can in the lower cases.
 
+      unindexTet(tet.idx());
+      staleTetAdjacency(tet.idx());
+
       //determine the corresponding faces
       for(unsigned int i = 0; i < m_TF.getNumEntriesInRow(tet.idx()); ++i) {
 
@@ -571,7 +1358,9 @@ namespace SimplexMesh {
 
       //...and delete the row
       m_TF.zeroRow(tet.idx());
+      m_T.reset(tet.idx());
       m_deadTets.push_back(tet.idx());
+      dropFromProperties(m_tetProperties, tet.idx());
 
       //adjust the tet count
       m_nTets -= 1;
@@ -584,29 +1373,16 @@ namespace SimplexMesh {
 
 
    
-   VertexHandle SimplicialComplex::getVertex(const EdgeHandle& edge, int index) const {
-      assert(edgeExists(edge));
-      assert(index >= 0 && index <= 1);
-      return VertexHandle(m_EV.getColByIndex(edge.idx(), index));
-   }
-
-   EdgeHandle SimplicialComplex::getEdge(const FaceHandle& face, int index) const {
-      assert(faceExists(face));
-      assert(index >= 0 && index <= 2);
-      return EdgeHandle(m_FE.getColByIndex(face.idx(), index));
-   }
-
-   FaceHandle SimplicialComplex::getFace(const TetHandle& tet, int index) const {
-      assert(tetExists(tet));
-      assert(index >= 0 && index <= 3);
-      return FaceHandle(m_TF.getColByIndex(tet.idx(), index));
-   }
-
    EdgeHandle SimplicialComplex::getEdge(const VertexHandle& v0, const VertexHandle& v1) const {
       //returns the appropriate edge if it exists, ignoring orientation
       if(!vertexExists(v0) || !vertexExists(v1))
          return EdgeHandle::invalid();
 
+      if(m_indexed) {
+         unsigned int slot = m_edgeIndex.find(SimplexKey(v0.idx(), v1.idx()));
+         return slot != SimplexIndex::npos ? EdgeHandle(m_edgeIndex.at(slot)) : EdgeHandle::invalid();
+      }
+
       for(VertexEdgeIterator veit(*this, v0); !veit.done(); veit.advance()) {
          EdgeHandle curEdge = veit.current();
          if(fromVertex(curEdge) == v1 || toVertex(curEdge) == v1)
@@ -621,6 +1397,16 @@ namespace SimplexMesh {
       if(!edgeExists(e0) || !edgeExists(e1) || !edgeExists(e2)) 
          return FaceHandle::invalid();
 
+      SimplexKey key;
+      if(m_indexed && joinKeys(edgeKey(e0.idx()), edgeKey(e1.idx()), 2, key)) {
+         for(unsigned int slot = m_faceIndex.find(key); slot != SimplexIndex::npos; slot = m_faceIndex.findNext(key, slot)) {
+            FaceHandle curFace(m_faceIndex.at(slot));
+            if(isIncident(e0, curFace) && isIncident(e1, curFace) && isIncident(e2, curFace))
+               return curFace;
+         }
+         return FaceHandle::invalid();
+      }
+
       for(EdgeFaceIterator efit(*this, e0); !efit.done(); efit.advance()) {
          FaceHandle curFace = efit.current();
          bool foundE1 = false, foundE2 = false;
@@ -641,6 +1427,16 @@ namespace SimplexMesh {
       if(!faceExists(f0) || !faceExists(f1) || !faceExists(f2) || !faceExists(f3)) 
          return TetHandle::invalid();
 
+      SimplexKey key;
+      if(m_indexed && joinKeys(faceKey(f0.idx()), faceKey(f1.idx()), 3, key)) {
+         for(unsigned int slot = m_tetIndex.find(key); slot != SimplexIndex::npos; slot = m_tetIndex.findNext(key, slot)) {
+            TetHandle curTet(m_tetIndex.at(slot));
+            if(isIncident(f0, curTet) && isIncident(f1, curTet) && isIncident(f2, curTet) && isIncident(f3, curTet))
+               return curTet;
+         }
+         return TetHandle::invalid();
+      }
+
       for(FaceTetIterator ftit(*this, f0); !ftit.done(); ftit.advance()) {
          TetHandle curTet = ftit.current();
          bool foundf1 = false, foundf2 = false, foundf3 = false;
@@ -675,24 +1471,6 @@ namespace SimplexMesh {
    }
 
    
-   VertexHandle SimplicialComplex::fromVertex(const EdgeHandle& eh) const
-   {
-      assert(eh.isValid());
-      assert(m_EV.getNumEntriesInRow(eh.idx()) == 2);
-
-      //1st vertex is the from vertex, by design
-      return VertexHandle(m_EV.getColByIndex(eh.idx(), 0));
-   }
-
-   VertexHandle SimplicialComplex::toVertex(const EdgeHandle& eh) const
-   {
-      assert(eh.isValid());
-      assert(m_EV.getNumEntriesInRow(eh.idx()) == 2);
-
-      //2nd vertex is the to vertex, by design
-      return VertexHandle(m_EV.getColByIndex(eh.idx(), 1));
-   }
-
    FaceHandle SimplicialComplex::frontFace(const EdgeHandle& eh) const {
       assert(eh.isValid());
       assert(m_EF.getNumEntriesInRow(eh.idx()) <= 2);
@@ -1007,6 +1785,35 @@ namespace SimplexMesh {
          edgeIndices.push_back(std::make_pair(edgeInd,sign));
       }
 
+      //everything around the vertex being eliminated changes vertices. The lookup index, properties listening for
+      //changes and the adjacency caches need to know which, so only when one of them is in use, collect it and take it
+      //out of the index for now.
+      bool trackNeighbourhood = m_indexed || m_slotListeners > 0;
+      for(int k = 0; k < AdjacencyKinds; ++k)
+         trackNeighbourhood = trackNeighbourhood || m_adjacency[k].built();
+
+      SmallIndexList facesAround, tetsAround;
+      if(trackNeighbourhood) {
+         for(unsigned int i = 0; i < edgeIndices.size(); ++i) {
+            int edgeInd = edgeIndices[i].first;
+            unindexEdge(edgeInd);
+            staleEdgeAdjacency(edgeInd);
+            for(unsigned int f = 0; f < m_EF.getNumEntriesInRow(edgeInd); ++f)
+               facesAround.push_back(m_EF.getColByIndex(edgeInd, f));
+         }
+         facesAround.sortUnique();
+         for(unsigned int i = 0; i < facesAround.size(); ++i) {
+            unindexFace(facesAround[i]);
+            for(unsigned int t = 0; t < m_FT.getNumEntriesInRow(facesAround[i]); ++t)
+               tetsAround.push_back(m_FT.getColByIndex(facesAround[i], t));
+         }
+         tetsAround.sortUnique();
+         for(unsigned int i = 0; i < tetsAround.size(); ++i) {
+            unindexTet(tetsAround[i]);
+            staleTetAdjacency(tetsAround[i]);
+         }
+      }
+
       //relabel all the edges' to-be-deleted endpoints to the vertex being kept.
       //doing it "in place" like this rather than using safer atomic add/deletes
       //ensures that the original data on the modified edges gets maintained.
@@ -1073,19 +1880,526 @@ namespace SimplexMesh {
 
             m_EF.set(e0.idx(), faceInd, newSign);
             m_FE.set(faceInd, e0.idx(), newSign);
+            markChanged(m_faceProperties, faceInd, faceInd+1);
          }
 
-         //finally, delete the orphaned edge
+         //finally, fold its data into the survivor and delete the orphaned edge
+         mergeProperties(m_edgeProperties, e0.idx(), e1.idx());
          bool success = deleteEdge(e1, false);
          assert(success);
       }
 
+      mergeProperties(m_vertProperties, vertToKeep, vertToRemove.idx());
       success = deleteVertex(vertToRemove);
       assert(success);
 
+      //put the survivors back in the index under their new vertices, and flag them as changed
+      if(trackNeighbourhood) {
+         markChanged(m_vertProperties, vertToKeep, vertToKeep+1);
+         for(unsigned int i = 0; i < edgeIndices.size(); ++i) {
+            int edgeInd = edgeIndices[i].first;
+            if(!edgeExists(EdgeHandle(edgeInd))) continue;
+            indexEdge(edgeInd);
+            staleEdgeAdjacency(edgeInd);
+            markChanged(m_edgeProperties, edgeInd, edgeInd+1);
+         }
+         for(unsigned int i = 0; i < facesAround.size(); ++i) {
+            indexFace(facesAround[i]);
+            markChanged(m_faceProperties, facesAround[i], facesAround[i]+1);
+         }
+         for(unsigned int i = 0; i < tetsAround.size(); ++i) {
+            indexTet(tetsAround[i]);
+            staleTetAdjacency(tetsAround[i]);
+            markChanged(m_tetProperties, tetsAround[i], tetsAround[i]+1);
+         }
+      }
+
       return VertexHandle(vertToKeep);
    }
 
+   size_t MemoryReport::totalUsed() const {
+      size_t total = 0;
+      const std::vector<Block>* lists[4] = { &matrices, &properties, &deadPools, &indices };
+      for(int l = 0; l < 4; ++l)
+         for(unsigned int i = 0; i < lists[l]->size(); ++i)
+            total += (*lists[l])[i].used;
+      return total;
+   }
+
+   size_t MemoryReport::totalReserved() const {
+      size_t total = 0;
+      const std::vector<Block>* lists[4] = { &matrices, &properties, &deadPools, &indices };
+      for(int l = 0; l < 4; ++l)
+         for(unsigned int i = 0; i < lists[l]->size(); ++i)
+            total += (*lists[l])[i].reserved;
+      return total;
+   }
+
+   void MemoryReport::print() const {
+      const char* listNames[4] = { "Incidence matrices", "Properties", "Dead slot pools", "Lookup index" };
+      const std::vector<Block>* lists[4] = { &matrices, &properties, &deadPools, &indices };
+      for(int l = 0; l < 4; ++l) {
+         if(lists[l]->empty()) continue;
+         printf("%s:\n", listNames[l]);
+         for(unsigned int i = 0; i < lists[l]->size(); ++i) {
+            const Block& block = (*lists[l])[i];
+            printf("  %-8s %12lu used %12lu reserved\n", block.name, (unsigned long)block.used, (unsigned long)block.reserved);
+         }
+      }
+      printf("Total: %lu used, %lu reserved\n", (unsigned long)totalUsed(), (unsigned long)totalReserved());
+
+      const char* dimNames[4] = { "vertices", "edges", "faces", "tets" };
+      for(int d = 0; d < 4; ++d) {
+         unsigned int slots = liveSlots[d] + deadSlots[d];
+         printf("%-8s: %u live, %u dead (%.1f%% dead)\n", dimNames[d], liveSlots[d], deadSlots[d], slots ? 100.0*deadSlots[d]/slots : 0.0);
+      }
+
+      const char* upNames[3] = { "VE", "EF", "FT" };
+      for(int d = 0; d < 3; ++d) {
+         if(rowLengths[d].empty()) continue;
+         printf("%s row lengths:", upNames[d]);
+         for(unsigned int k = 0; k < rowLengths[d].size(); ++k)
+            if(rowLengths[d][k] > 0) printf(" %u:%u", k, rowLengths[d][k]);
+         printf("\n");
+      }
+   }
+
+   void addBlock(std::vector<MemoryReport::Block>& list, const char* name, size_t used, size_t reserved) {
+      MemoryReport::Block block = { name, used, reserved };
+      list.push_back(block);
+   }
+
+   void SimplicialComplex::memoryReport(MemoryReport& report, bool rowHistograms) const {
+      report.matrices.clear();
+      addBlock(report.matrices, "TF", m_TF.memoryUsed(), m_TF.memoryUsage());
+      addBlock(report.matrices, "FE", m_FE.memoryUsed(), m_FE.memoryUsage());
+      addBlock(report.matrices, "EV", m_EV.memoryUsed(), m_EV.memoryUsage());
+      addBlock(report.matrices, "FT", m_FT.memoryUsed(), m_FT.memoryUsage());
+      addBlock(report.matrices, "EF", m_EF.memoryUsed(), m_EF.memoryUsage());
+      addBlock(report.matrices, "VE", m_VE.memoryUsed(), m_VE.memoryUsage());
+      addBlock(report.matrices, "live", m_V.memoryUsed() + m_E.memoryUsed() + m_F.memoryUsed() + m_T.memoryUsed(),
+         m_V.memoryUsage() + m_E.memoryUsage() + m_F.memoryUsage() + m_T.memoryUsage());
+
+      report.properties.clear();
+      const char* propNames[4] = { "vertex", "edge", "face", "tet" };
+      const std::vector<SimplexPropertyBase*>* props[4] = { &m_vertProperties, &m_edgeProperties, &m_faceProperties, &m_tetProperties };
+      unsigned int slots[4] = { numVertexSlots(), numEdgeSlots(), numFaceSlots(), numTetSlots() };
+      for(int d = 0; d < 4; ++d) {
+         for(unsigned int i = 0; i < props[d]->size(); ++i) {
+            size_t used, reserved;
+            (*props[d])[i]->memoryUsage(slots[d], used, reserved);
+            addBlock(report.properties, propNames[d], used, reserved);
+         }
+      }
+
+      report.deadPools.clear();
+      const std::vector<unsigned int>* pools[4] = { &m_deadVerts, &m_deadEdges, &m_deadFaces, &m_deadTets };
+      for(int d = 0; d < 4; ++d)
+         addBlock(report.deadPools, propNames[d], pools[d]->size()*sizeof(unsigned int), pools[d]->capacity()*sizeof(unsigned int));
+
+      report.indices.clear();
+      if(m_indexed) {
+         addBlock(report.indices, "edge", m_edgeIndex.memoryUsed(), m_edgeIndex.memoryUsage());
+         addBlock(report.indices, "face", m_faceIndex.memoryUsed(), m_faceIndex.memoryUsage());
+         addBlock(report.indices, "tet", m_tetIndex.memoryUsed(), m_tetIndex.memoryUsage());
+      }
+      const char* adjacencyNames[AdjacencyKinds] = { "vertex-tet", "edge-tet", "tet-tet", "vertex-vertex" };
+      for(int k = 0; k < AdjacencyKinds; ++k)
+         if(m_adjacency[k].built())
+            addBlock(report.indices, adjacencyNames[k], m_adjacency[k].memoryUsed(), m_adjacency[k].memoryUsage());
+
+      int live[4] = { m_nVerts, m_nEdges, m_nFaces, m_nTets };
+      for(int d = 0; d < 4; ++d) {
+         report.liveSlots[d] = live[d];
+         report.deadSlots[d] = slots[d] - live[d];
+      }
+
+      for(int d = 0; d < 3; ++d)
+         report.rowLengths[d].clear();
+      if(rowHistograms) {
+         m_VE.rowLengthHistogram(report.rowLengths[0]);
+         m_EF.rowLengthHistogram(report.rowLengths[1]);
+         m_FT.rowLengthHistogram(report.rowLengths[2]);
+      }
+   }
+
+   void SimplicialComplex::freeze(CompactComplex& frozen) const {
+      frozen.build(*this);
+   }
+
+   //Copy the rows of src listed in newToOld into dst, in order, translating columns through colMap.
+   //Entry order (and hence orientation) within each row is preserved.
+   template<class Matrix>
+   void remapRows(const Matrix& src, Matrix& dst, const std::vector<int>& newToOld, const std::vector<int>& colMap) {
+      for(unsigned int row = 0; row < newToOld.size(); ++row) {
+         unsigned int old = newToOld[row];
+         for(unsigned int k = 0; k < src.getNumEntriesInRow(old); ++k)
+            dst.set(row, colMap[src.getColByIndex(old, k)], src.getValueByIndex(old, k));
+      }
+   }
+
+   //Invert an old-to-new table into a new-to-old one.
+   void invertRemap(const std::vector<int>& oldToNew, std::vector<int>& newToOld) {
+      int count = 0;
+      for(unsigned int i = 0; i < oldToNew.size(); ++i)
+         if(oldToNew[i] >= 0) ++count;
+      newToOld.assign(count, -1);
+      for(unsigned int i = 0; i < oldToNew.size(); ++i)
+         if(oldToNew[i] >= 0) newToOld[oldToNew[i]] = i;
+   }
+
+   void SimplicialComplex::applyRemap(const SimplexRemap& remap) {
+      assert(remap.verts.size() == numVertexSlots() && remap.edges.size() == numEdgeSlots() &&
+         remap.faces.size() == numFaceSlots() && remap.tets.size() == numTetSlots());
+
+      std::vector<int> vertOrder, edgeOrder, faceOrder, tetOrder;
+      invertRemap(remap.verts, vertOrder);
+      invertRemap(remap.edges, edgeOrder);
+      invertRemap(remap.faces, faceOrder);
+      invertRemap(remap.tets, tetOrder);
+
+      //downward relations
+      FixedIncidenceMatrix<2> EV(edgeOrder.size(), vertOrder.size());
+      FixedIncidenceMatrix<3> FE(faceOrder.size(), edgeOrder.size());
+      FixedIncidenceMatrix<4> TF(tetOrder.size(), faceOrder.size());
+      remapRows(m_EV, EV, edgeOrder, remap.verts);
+      remapRows(m_FE, FE, faceOrder, remap.edges);
+      remapRows(m_TF, TF, tetOrder, remap.faces);
+
+      m_EV.swap(EV);
+      m_FE.swap(FE);
+      m_TF.swap(TF);
+
+      //the vertex slots must be in place before the upward relations are derived
+      m_V.assign(vertOrder.size(), true);
+      m_E.assign(edgeOrder.size(), true);
+      m_F.assign(faceOrder.size(), true);
+      m_T.assign(tetOrder.size(), true);
+      rebuildTransposes();
+
+      //only live simplices can be carried over, so every slot is now occupied
+      m_deadVerts.clear(); m_deadEdges.clear(); m_deadFaces.clear(); m_deadTets.clear();
+
+      //bring the properties along
+      for(unsigned int i = 0; i < m_vertProperties.size(); ++i) m_vertProperties[i]->permute(vertOrder);
+      for(unsigned int i = 0; i < m_edgeProperties.size(); ++i) m_edgeProperties[i]->permute(edgeOrder);
+      for(unsigned int i = 0; i < m_faceProperties.size(); ++i) m_faceProperties[i]->permute(faceOrder);
+      for(unsigned int i = 0; i < m_tetProperties.size(); ++i) m_tetProperties[i]->permute(tetOrder);
+      m_vertCapacity = vertOrder.size();
+      m_edgeCapacity = edgeOrder.size();
+      m_faceCapacity = faceOrder.size();
+      m_tetCapacity = tetOrder.size();
+
+      rebuildLookupIndex();
+      clearAdjacencyCaches();
+   }
+
+   SimplexRemap SimplicialComplex::compact() {
+      //number live slots in their current order
+      SimplexRemap remap;
+      int count = 0;
+      remap.verts.resize(numVertexSlots());
+      for(unsigned int i = 0; i < numVertexSlots(); ++i) remap.verts[i] = m_V[i] ? count++ : -1;
+      count = 0;
+      remap.edges.resize(numEdgeSlots());
+      for(unsigned int i = 0; i < numEdgeSlots(); ++i) remap.edges[i] = m_E[i] ? count++ : -1;
+      count = 0;
+      remap.faces.resize(numFaceSlots());
+      for(unsigned int i = 0; i < numFaceSlots(); ++i) remap.faces[i] = m_F[i] ? count++ : -1;
+      count = 0;
+      remap.tets.resize(numTetSlots());
+      for(unsigned int i = 0; i < numTetSlots(); ++i) remap.tets[i] = m_T[i] ? count++ : -1;
+
+      applyRemap(remap);
+      return remap;
+   }
+
+   //Sort key for ordering simplices lexicographically by their (sorted) vertex indices.
+   struct VertexTupleKey {
+      int v[4];
+      int slot;
+      bool operator<(const VertexTupleKey& rhs) const {
+         for(int i = 0; i < 4; ++i)
+            if(v[i] != rhs.v[i]) return v[i] < rhs.v[i];
+         return slot < rhs.slot;
+      }
+   };
+
+   //Number the slots in the order given by the sorted keys.
+   void numberByKeys(std::vector<VertexTupleKey>& keys, std::vector<int>& table) {
+      std::sort(keys.begin(), keys.end());
+      for(unsigned int i = 0; i < keys.size(); ++i)
+         table[keys[i].slot] = i;
+   }
+
+   SimplexRemap SimplicialComplex::remapFromVertexOrder(const std::vector<int>& vertOrder) const {
+      SimplexRemap remap;
+      remap.verts.assign(numVertexSlots(), -1);
+      remap.edges.assign(numEdgeSlots(), -1);
+      remap.faces.assign(numFaceSlots(), -1);
+      remap.tets.assign(numTetSlots(), -1);
+      for(unsigned int i = 0; i < vertOrder.size(); ++i)
+         remap.verts[vertOrder[i]] = i;
+
+      //each higher simplex is keyed on its renumbered vertices, smallest first, padded with -1
+      std::vector<VertexTupleKey> keys;
+      VertexTupleKey key;
+
+      for(unsigned int e = 0; e < numEdgeSlots(); ++e) {
+         if(m_EV.getNumEntriesInRow(e) == 0) continue;
+         key.v[0] = remap.verts[m_EV.getColByIndex(e, 0)];
+         key.v[1] = remap.verts[m_EV.getColByIndex(e, 1)];
+         key.v[2] = key.v[3] = -1;
+         std::sort(key.v, key.v+2);
+         key.slot = e;
+         keys.push_back(key);
+      }
+      numberByKeys(keys, remap.edges);
+
+      keys.clear();
+      for(unsigned int f = 0; f < numFaceSlots(); ++f) {
+         if(m_FE.getNumEntriesInRow(f) == 0) continue;
+         //the first edge contributes two vertices, and the second edge the remaining one
+         int e0 = m_FE.getColByIndex(f, 0), e1 = m_FE.getColByIndex(f, 1);
+         int a = m_EV.getColByIndex(e0, 0), b = m_EV.getColByIndex(e0, 1);
+         int c = m_EV.getColByIndex(e1, 0);
+         if(c == a || c == b) c = m_EV.getColByIndex(e1, 1);
+         key.v[0] = remap.verts[a]; key.v[1] = remap.verts[b]; key.v[2] = remap.verts[c]; key.v[3] = -1;
+         std::sort(key.v, key.v+3);
+         key.slot = f;
+         keys.push_back(key);
+      }
+      numberByKeys(keys, remap.faces);
+
+      keys.clear();
+      for(unsigned int t = 0; t < numTetSlots(); ++t) {
+         if(m_TF.getNumEntriesInRow(t) == 0) continue;
+         //three vertices from the first face, and the one off it from the second
+         int f0 = m_TF.getColByIndex(t, 0), f1 = m_TF.getColByIndex(t, 1);
+         int verts[4], count = 0;
+         for(int i = 0; i < 2; ++i) {
+            int e = m_FE.getColByIndex(f0, i);
+            for(int j = 0; j < 2; ++j) {
+               int v = m_EV.getColByIndex(e, j);
+               if(std::find(verts, verts+count, v) == verts+count) verts[count++] = v;
+            }
+         }
+         for(int i = 0; i < 3 && count < 4; ++i) {
+            int e = m_FE.getColByIndex(f1, i);
+            for(int j = 0; j < 2 && count < 4; ++j) {
+               int v = m_EV.getColByIndex(e, j);
+               if(std::find(verts, verts+count, v) == verts+count) verts[count++] = v;
+            }
+         }
+         for(int i = 0; i < 4; ++i) key.v[i] = remap.verts[verts[i]];
+         std::sort(key.v, key.v+4);
+         key.slot = t;
+         keys.push_back(key);
+      }
+      numberByKeys(keys, remap.tets);
+
+      return remap;
+   }
+
+   SimplexRemap SimplicialComplex::remapFromTetOrder(const std::vector<int>& tetOrder) const {
+      SimplexRemap remap;
+      remap.verts.assign(numVertexSlots(), -1);
+      remap.edges.assign(numEdgeSlots(), -1);
+      remap.faces.assign(numFaceSlots(), -1);
+      remap.tets.assign(numTetSlots(), -1);
+      int nv = 0, ne = 0, nf = 0;
+
+      //number faces, then edges, then vertices as they are first reached from the tets, in order; simplices not
+      //on any tet follow, in their current order
+      std::vector<int> faceList, edgeList, vertList;
+      for(unsigned int i = 0; i < tetOrder.size(); ++i) {
+         remap.tets[tetOrder[i]] = i;
+         for(unsigned int k = 0; k < m_TF.getNumEntriesInRow(tetOrder[i]); ++k) {
+            int f = m_TF.getColByIndex(tetOrder[i], k);
+            if(remap.faces[f] < 0) { remap.faces[f] = nf++; faceList.push_back(f); }
+         }
+      }
+      for(unsigned int f = 0; f < numFaceSlots(); ++f)
+         if(remap.faces[f] < 0 && m_FE.getNumEntriesInRow(f) > 0) { remap.faces[f] = nf++; faceList.push_back(f); }
+
+      for(unsigned int i = 0; i < faceList.size(); ++i) {
+         for(unsigned int k = 0; k < m_FE.getNumEntriesInRow(faceList[i]); ++k) {
+            int e = m_FE.getColByIndex(faceList[i], k);
+            if(remap.edges[e] < 0) { remap.edges[e] = ne++; edgeList.push_back(e); }
+         }
+      }
+      for(unsigned int e = 0; e < numEdgeSlots(); ++e)
+         if(remap.edges[e] < 0 && m_EV.getNumEntriesInRow(e) > 0) { remap.edges[e] = ne++; edgeList.push_back(e); }
+
+      for(unsigned int i = 0; i < edgeList.size(); ++i) {
+         for(unsigned int k = 0; k < m_EV.getNumEntriesInRow(edgeList[i]); ++k) {
+            int v = m_EV.getColByIndex(edgeList[i], k);
+            if(remap.verts[v] < 0) remap.verts[v] = nv++;
+         }
+      }
+      for(unsigned int v = 0; v < numVertexSlots(); ++v)
+         if(remap.verts[v] < 0 && m_V[v]) remap.verts[v] = nv++;
+
+      return remap;
+   }
+
+   //Position along a 3D Hilbert curve of a point with the given number of bits per axis (at most 21), using the
+   //transpose formulation of J. Skilling, "Programming the Hilbert curve", AIP Conf. Proc. 707 (2004).
+   unsigned long long hilbertIndex(unsigned int x[3], int bits) {
+      unsigned int M = 1u << (bits-1);
+
+      //inverse undo
+      for(unsigned int Q = M; Q > 1; Q >>= 1) {
+         unsigned int P = Q - 1;
+         for(int i = 0; i < 3; ++i) {
+            if(x[i] & Q)
+               x[0] ^= P;
+            else {
+               unsigned int t = (x[0] ^ x[i]) & P;
+               x[0] ^= t;
+               x[i] ^= t;
+            }
+         }
+      }
+
+      //Gray encode
+      for(int i = 1; i < 3; ++i)
+         x[i] ^= x[i-1];
+      unsigned int t = 0;
+      for(unsigned int Q = M; Q > 1; Q >>= 1)
+         if(x[2] & Q) t ^= Q - 1;
+      for(int i = 0; i < 3; ++i)
+         x[i] ^= t;
+
+      //interleave the transposed bits, most significant first
+      unsigned long long key = 0;
+      for(int b = bits-1; b >= 0; --b)
+         for(int i = 0; i < 3; ++i)
+            key = (key << 1) | ((x[i] >> b) & 1);
+      return key;
+   }
+
+   SimplexRemap SimplicialComplex::reorderHilbert(const std::vector<double>& coords) {
+      const int bits = 21;
+
+      //bounding box of the live vertices
+      double lo[3], hi[3];
+      bool first = true;
+      for(unsigned int v = 0; v < numVertexSlots(); ++v) {
+         if(!m_V[v]) continue;
+         for(int k = 0; k < 3; ++k) {
+            double c = coords[3*v+k];
+            if(first || c < lo[k]) lo[k] = c;
+            if(first || c > hi[k]) hi[k] = c;
+         }
+         first = false;
+      }
+
+      //quantize onto the curve's grid, using the same scale on every axis
+      double extent = 0;
+      for(int k = 0; !first && k < 3; ++k)
+         extent = std::max(extent, hi[k] - lo[k]);
+      double scale = extent > 0 ? ((1u << bits) - 1) / extent : 0;
+
+      std::vector< std::pair<unsigned long long, int> > keys;
+      for(unsigned int v = 0; v < numVertexSlots(); ++v) {
+         if(!m_V[v]) continue;
+         unsigned int x[3];
+         for(int k = 0; k < 3; ++k)
+            x[k] = (unsigned int)((coords[3*v+k] - lo[k]) * scale);
+         keys.push_back(std::make_pair(hilbertIndex(x, bits), (int)v));
+      }
+      std::sort(keys.begin(), keys.end());
+
+      std::vector<int> vertOrder(keys.size());
+      for(unsigned int i = 0; i < keys.size(); ++i)
+         vertOrder[i] = keys[i].second;
+
+      SimplexRemap remap = remapFromVertexOrder(vertOrder);
+      applyRemap(remap);
+      return remap;
+   }
+
+   //Orders vertices by increasing valence.
+   struct DegreeLess {
+      const IncidenceMatrix& VE;
+      DegreeLess(const IncidenceMatrix& ve) : VE(ve) {}
+      bool operator()(int a, int b) const {
+         unsigned int da = VE.getNumEntriesInRow(a), db = VE.getNumEntriesInRow(b);
+         return da != db ? da < db : a < b;
+      }
+   };
+
+   SimplexRemap SimplicialComplex::reorderRCM() {
+      //start each connected component from a vertex of minimal valence
+      std::vector<int> starts;
+      for(unsigned int v = 0; v < numVertexSlots(); ++v)
+         if(m_V[v]) starts.push_back(v);
+      std::sort(starts.begin(), starts.end(), DegreeLess(m_VE));
+
+      std::vector<int> order;
+      order.reserve(starts.size());
+      std::vector<bool> visited(numVertexSlots(), false);
+      std::vector<int> neighbours;
+      for(unsigned int s = 0; s < starts.size(); ++s) {
+         if(visited[starts[s]]) continue;
+
+         //breadth-first, visiting each vertex's unvisited neighbours by increasing valence
+         visited[starts[s]] = true;
+         order.push_back(starts[s]);
+         for(unsigned int head = order.size()-1; head < order.size(); ++head) {
+            int v = order[head];
+            neighbours.clear();
+            for(unsigned int k = 0; k < m_VE.getNumEntriesInRow(v); ++k) {
+               int e = m_VE.getColByIndex(v, k);
+               int other = m_EV.getColByIndex(e, 0);
+               if(other == v) other = m_EV.getColByIndex(e, 1);
+               if(!visited[other]) {
+                  visited[other] = true;
+                  neighbours.push_back(other);
+               }
+            }
+            std::sort(neighbours.begin(), neighbours.end(), DegreeLess(m_VE));
+            order.insert(order.end(), neighbours.begin(), neighbours.end());
+         }
+      }
+      std::reverse(order.begin(), order.end());
+
+      SimplexRemap remap = remapFromVertexOrder(order);
+      applyRemap(remap);
+      return remap;
+   }
+
+   SimplexRemap SimplicialComplex::reorderTetBFS() {
+      std::vector<int> order;
+      order.reserve(m_nTets);
+      std::vector<bool> visited(numTetSlots(), false);
+      for(unsigned int start = 0; start < numTetSlots(); ++start) {
+         if(visited[start] || m_TF.getNumEntriesInRow(start) == 0) continue;
+
+         //breadth-first across shared faces
+         visited[start] = true;
+         order.push_back(start);
+         for(unsigned int head = order.size()-1; head < order.size(); ++head) {
+            int t = order[head];
+            for(unsigned int i = 0; i < m_TF.getNumEntriesInRow(t); ++i) {
+               int f = m_TF.getColByIndex(t, i);
+               for(unsigned int j = 0; j < m_FT.getNumEntriesInRow(f); ++j) {
+                  int other = m_FT.getColByIndex(f, j);
+                  if(!visited[other]) {
+                     visited[other] = true;
+                     order.push_back(other);
+                  }
+               }
+            }
+         }
+      }
+
+      SimplexRemap remap = remapFromTetOrder(order);
+      applyRemap(remap);
+      return remap;
+   }
+
    //Two silly utility functions
    VertexHandle getSharedVertexFromEdgePair(const SimplicialComplex& obj, const EdgeHandle& e0, const EdgeHandle& e1) {
       VertexHandle v0 = obj.fromVertex(e0), v1 = obj.toVertex(e0),
@@ -1097,12 +2411,7 @@ namespace SimplexMesh {
    }
 
    EdgeHandle getEdgeFromVertexPair( const SimplicialComplex& obj, const VertexHandle& v0, const VertexHandle& v1 ) {
-      for(VertexEdgeIterator ve_it(obj, v0); !ve_it.done(); ve_it.advance()) {
-         EdgeHandle eh = ve_it.current();
-         if(obj.fromVertex(eh) == v1 || obj.toVertex(eh) == v1)
-            return eh;
-      }
-      return EdgeHandle::invalid();
+      return obj.getEdge(v0, v1);
    }
 
    VertexHandle SimplicialComplex::splitEdge(const EdgeHandle& splitEdge, std::vector<FaceHandle>& newFaces) {
@@ -1118,10 +2427,13 @@ namespace SimplexMesh {
 
       //add a new midpoint vertex
       VertexHandle newVert = addVertex();
+      interpolateProperties(m_vertProperties, newVert.idx(), from_vh.idx(), to_vh.idx());
 
       //add the two new edges that are part of the original split edge
       EdgeHandle e_0 = addEdge(from_vh, newVert);
       EdgeHandle e_1 = addEdge(to_vh, newVert);
+      deriveProperties(m_edgeProperties, e_0.idx(), splitEdge.idx());
+      deriveProperties(m_edgeProperties, e_1.idx(), splitEdge.idx());
 
       //now iterate over the existing faces, splitting them in two appropriately
       std::vector<FaceHandle> facesToDelete;
@@ -1137,8 +2449,13 @@ namespace SimplexMesh {
          while((fv_it.current() == from_vh) || (fv_it.current() == to_vh)) fv_it.advance();
          VertexHandle other_vh = fv_it.current();
 
-         //create the new edge that splits this face
+         //create the new edge that splits this face; it lies between the face's two other edges
          EdgeHandle e_faceSplit = addEdge(other_vh, newVert);
+         EdgeHandle sides[2];
+         int numSides = 0;
+         for(FaceEdgeIterator side_it(*this, fh); !side_it.done() && numSides < 2; side_it.advance())
+            if(side_it.current() != splitEdge) sides[numSides++] = side_it.current();
+         if(numSides == 2) interpolateProperties(m_edgeProperties, e_faceSplit.idx(), sides[0].idx(), sides[1].idx());
 
          //build the two new faces
          FaceEdgeIterator fe_it(*this, fh);
@@ -1163,6 +2480,7 @@ namespace SimplexMesh {
                else edgeList.push_back(e_faceSplit); //the new edge that splits the face
             }
             FaceHandle newFace = addFace(edgeList[0], edgeList[1], edgeList[2]);
+            if(newFace.isValid()) deriveProperties(m_faceProperties, newFace.idx(), fh.idx());
             newFaces.push_back(newFace);
          }
 
@@ -1219,6 +2537,7 @@ namespace SimplexMesh {
       if(edge.isValid()) return EdgeHandle::invalid();
 
       EdgeHandle newEdge = addEdge(f1_vh, f2_vh);
+      deriveProperties(m_edgeProperties, newEdge.idx(), eh.idx());
 
       //grab all the current edges in proper order, starting from the shared face
       EdgeHandle e0 = nextEdge(fh, eh);
@@ -1253,9 +2572,11 @@ namespace SimplexMesh {
       if(!sharedV.isValid())
          std::swap(e2,e3);
 
-      //add in the new faces
-      addFace(e1, e2, newEdge);
-      addFace(e3, e0, newEdge);
+      //add in the new faces, each straddling both old ones
+      FaceHandle newFace0 = addFace(e1, e2, newEdge);
+      FaceHandle newFace1 = addFace(e3, e0, newEdge);
+      if(newFace0.isValid()) interpolateProperties(m_faceProperties, newFace0.idx(), fh.idx(), fh2.idx());
+      if(newFace1.isValid()) interpolateProperties(m_faceProperties, newFace1.idx(), fh.idx(), fh2.idx());
 
       //Delete the old patch
       bool success = deleteFace(fh, false);
@@ -1272,7 +2593,7 @@ namespace SimplexMesh {
    
    void SimplicialComplex::registerVertexProperty(SimplexPropertyBase* prop) { 
       m_vertProperties.push_back(prop); 
-      prop->resize(numVertexSlots());
+      prop->resize(m_vertCapacity);
    }
    void SimplicialComplex::removeVertexProperty(SimplexPropertyBase* prop) { 
       std::vector<SimplexPropertyBase*>::iterator it = std::find(m_vertProperties.begin(), m_vertProperties.end(), prop);
@@ -1283,7 +2604,7 @@ namespace SimplexMesh {
    
    void SimplicialComplex::registerEdgeProperty(SimplexPropertyBase* prop) { 
       m_edgeProperties.push_back(prop); 
-      prop->resize(numEdgeSlots());
+      prop->resize(m_edgeCapacity);
    }
    void SimplicialComplex::removeEdgeProperty(SimplexPropertyBase* prop) { 
       std::vector<SimplexPropertyBase*>::iterator it = std::find(m_edgeProperties.begin(), m_edgeProperties.end(), prop);
@@ -1294,7 +2615,7 @@ namespace SimplexMesh {
    
    void SimplicialComplex::registerFaceProperty(SimplexPropertyBase* prop) { 
       m_faceProperties.push_back(prop); 
-      prop->resize(numFaceSlots());
+      prop->resize(m_faceCapacity);
    }
    void SimplicialComplex::removeFaceProperty(SimplexPropertyBase* prop) { 
       std::vector<SimplexPropertyBase*>::iterator it = std::find(m_faceProperties.begin(), m_faceProperties.end(), prop);
@@ -1305,7 +2626,7 @@ namespace SimplexMesh {
    
    void SimplicialComplex::registerTetProperty(SimplexPropertyBase* prop) { 
       m_tetProperties.push_back(prop); 
-      prop->resize(numTetSlots());
+      prop->resize(m_tetCapacity);
    }
    void SimplicialComplex::removeTetProperty(SimplexPropertyBase* prop) { 
       std::vector<SimplexPropertyBase*>::iterator it = std::find(m_tetProperties.begin(), m_tetProperties.end(), prop);
@@ -0,0 +1,156 @@
+#include "TopologyBackend.h"
+#include "SimplexIterators.h"
+
+namespace SimplexMesh {
+
+   IncidenceBackend::IncidenceBackend() {
+      //duplicates are screened by exists() before anything is added
+      m_obj.setSafeMode(false);
+   }
+
+   VertexHandle IncidenceBackend::addVertex() {
+      return m_obj.addVertex();
+   }
+
+   bool IncidenceBackend::addSimplex(const Simplex& s) {
+      if(s.dim < 1 || exists(s))
+         return false;
+      for(int i = 0; i <= s.dim; ++i) {
+         if(!m_obj.vertexExists(s.v[i])) return false;
+         if(i > 0 && s.v[i] == s.v[i-1]) return false;
+      }
+
+      switch(s.dim) {
+         case 1: return m_obj.addEdge(s.v[0], s.v[1]).isValid();
+         case 2: return m_obj.addFace(s.v[0], s.v[1], s.v[2]).isValid();
+         case 3: return m_obj.addTet(s.v[0], s.v[1], s.v[2], s.v[3]).isValid();
+      }
+      return false;
+   }
+
+   bool IncidenceBackend::deleteSimplex(const Simplex& s) {
+      switch(s.dim) {
+         case 0: return m_obj.deleteVertex(s.v[0]);
+         case 1: return m_obj.deleteEdge(findEdge(s), false);
+         case 2: return m_obj.deleteFace(findFace(s), false);
+         case 3: return m_obj.deleteTet(findTet(s), false);
+      }
+      return false;
+   }
+
+   bool IncidenceBackend::exists(const Simplex& s) const {
+      switch(s.dim) {
+         case 0: return m_obj.vertexExists(s.v[0]);
+         case 1: return findEdge(s).isValid();
+         case 2: return findFace(s).isValid();
+         case 3: return findTet(s).isValid();
+      }
+      return false;
+   }
+
+   void IncidenceBackend::boundary(const Simplex& s, std::vector<Simplex>& out) const {
+      switch(s.dim) {
+         case 1: {
+            EdgeHandle eh = findEdge(s);
+            if(!eh.isValid()) return;
+            out.push_back(Simplex(m_obj.fromVertex(eh)));
+            out.push_back(Simplex(m_obj.toVertex(eh)));
+            break;
+         }
+         case 2: {
+            FaceHandle fh = findFace(s);
+            if(!fh.isValid()) return;
+            for(FaceEdgeIterator feit(m_obj, fh); !feit.done(); feit.advance())
+               out.push_back(toSimplex(feit.current()));
+            break;
+         }
+         case 3: {
+            TetHandle th = findTet(s);
+            if(!th.isValid()) return;
+            for(TetFaceIterator tfit(m_obj, th); !tfit.done(); tfit.advance())
+               out.push_back(toSimplex(tfit.current()));
+            break;
+         }
+      }
+   }
+
+   void IncidenceBackend::coboundary(const Simplex& s, std::vector<Simplex>& out) const {
+      switch(s.dim) {
+         case 0: {
+            if(!m_obj.vertexExists(s.v[0])) return;
+            for(VertexEdgeIterator veit(m_obj, s.v[0]); !veit.done(); veit.advance())
+               out.push_back(toSimplex(veit.current()));
+            break;
+         }
+         case 1: {
+            EdgeHandle eh = findEdge(s);
+            if(!eh.isValid()) return;
+            for(EdgeFaceIterator efit(m_obj, eh); !efit.done(); efit.advance())
+               out.push_back(toSimplex(efit.current()));
+            break;
+         }
+         case 2: {
+            FaceHandle fh = findFace(s);
+            if(!fh.isValid()) return;
+            for(FaceTetIterator ftit(m_obj, fh); !ftit.done(); ftit.advance())
+               out.push_back(toSimplex(ftit.current()));
+            break;
+         }
+      }
+   }
+
+   size_t IncidenceBackend::memoryUsage() const {
+      return m_obj.m_EV.memoryUsage() + m_obj.m_FE.memoryUsage() + m_obj.m_TF.memoryUsage() +
+         m_obj.m_VE.memoryUsage() + m_obj.m_EF.memoryUsage() + m_obj.m_FT.memoryUsage() +
+         m_obj.m_V.memoryUsage() + m_obj.m_E.memoryUsage() + m_obj.m_F.memoryUsage() + m_obj.m_T.memoryUsage() +
+         (m_obj.m_deadVerts.capacity() + m_obj.m_deadEdges.capacity() + m_obj.m_deadFaces.capacity() + m_obj.m_deadTets.capacity())*sizeof(unsigned int);
+   }
+
+   EdgeHandle IncidenceBackend::findEdge(const Simplex& s) const {
+      return m_obj.getEdge(s.v[0], s.v[1]);
+   }
+
+   FaceHandle IncidenceBackend::findFace(const Simplex& s) const {
+      EdgeHandle e01 = m_obj.getEdge(s.v[0], s.v[1]);
+      EdgeHandle e12 = m_obj.getEdge(s.v[1], s.v[2]);
+      EdgeHandle e02 = m_obj.getEdge(s.v[0], s.v[2]);
+      return m_obj.getFace(e01, e12, e02);
+   }
+
+   TetHandle IncidenceBackend::findTet(const Simplex& s) const {
+      FaceHandle f[4];
+      for(int skip = 0; skip < 4; ++skip) {
+         Simplex face;
+         face.dim = 2;
+         for(int i = 0, k = 0; i < 4; ++i)
+            if(i != skip) face.v[k++] = s.v[i];
+         f[skip] = findFace(face);
+      }
+      return m_obj.getTet(f[0], f[1], f[2], f[3]);
+   }
+
+   Simplex IncidenceBackend::toSimplex(const EdgeHandle& eh) const {
+      return Simplex(m_obj.fromVertex(eh), m_obj.toVertex(eh));
+   }
+
+   Simplex IncidenceBackend::toSimplex(const FaceHandle& fh) const {
+      Simplex s;
+      s.dim = 2;
+      int k = 0;
+      for(FaceVertexIterator fvit(m_obj, fh); !fvit.done() && k < 3; fvit.advance())
+         s.v[k++] = fvit.current();
+      s.sort();
+      return s;
+   }
+
+   Simplex IncidenceBackend::toSimplex(const TetHandle& th) const {
+      Simplex s;
+      s.dim = 3;
+      int k = 0;
+      for(TetVertexIterator tvit(m_obj, th); !tvit.done() && k < 4; tvit.advance())
+         s.v[k++] = tvit.current();
+      s.sort();
+      return s;
+   }
+
+}
@@ -0,0 +1,1216 @@
+#include "SimplicialComplex.h"
+#include "Parallel.h"
+#include "TopologyBackend.h"
+#include "IAStarBackend.h"
+#include "ParallelForEach.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+using namespace SimplexMesh;
+
+void bench_upwardRows();
+void bench_frozenTraversal();
+void bench_backends();
+void bench_reordering();
+void bench_reserve();
+void bench_bulkBuild();
+void bench_lookupIndex();
+void bench_transposes();
+void bench_memoryReport();
+void bench_soaUpdate();
+void bench_sparseProperty();
+void bench_dirtyTracking();
+void bench_updatePolicies();
+void bench_bufferedStep();
+void bench_compressedProperties();
+void bench_compositeIterators();
+void bench_ranges();
+void bench_orientedGathers();
+void bench_adjacencyCaches();
+void bench_occupancy();
+void bench_parallelForEach();
+
+typedef void (*bench_func)();
+
+const int bench_count = 21;
+bench_func benches[] = {bench_upwardRows,
+                        bench_frozenTraversal,
+                        bench_backends,
+                        bench_reordering,
+                        bench_reserve,
+                        bench_bulkBuild,
+                        bench_lookupIndex,
+                        bench_transposes,
+                        bench_memoryReport,
+                        bench_soaUpdate,
+                        bench_sparseProperty,
+                        bench_dirtyTracking,
+                        bench_updatePolicies,
+                        bench_bufferedStep,
+                        bench_compressedProperties,
+                        bench_compositeIterators,
+                        bench_ranges,
+                        bench_orientedGathers,
+                        bench_adjacencyCaches,
+                        bench_occupancy,
+                        bench_parallelForEach};
+
+
+int main() {
+   for(int i = 0; i < bench_count; ++i)
+      (*benches[i])();
+   return 0;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//Helpers
+
+class Timer {
+public:
+   Timer() : m_start(std::chrono::high_resolution_clock::now()) {}
+   double seconds() const {
+      return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - m_start).count();
+   }
+private:
+   std::chrono::high_resolution_clock::time_point m_start;
+};
+
+//The original row storage of IncidenceMatrix (one std::vector per row), kept as a baseline.
+class VectorRows {
+public:
+   VectorRows(unsigned int rows) : m_indices(rows) {}
+   void set(unsigned int i, unsigned int j, int val) { m_indices[i].push_back((j+1)*val); }
+   unsigned int getNumEntriesInRow(unsigned int i) const { return m_indices[i].size(); }
+   unsigned int getColByIndex(unsigned int i, unsigned int k) const { return std::abs(m_indices[i][k]) - 1; }
+   size_t memoryUsage() const {
+      //count a typical 16 bytes of allocator overhead per heap block
+      size_t bytes = m_indices.capacity()*sizeof(std::vector<int>);
+      for(unsigned int i = 0; i < m_indices.size(); ++i)
+         if(m_indices[i].capacity() > 0)
+            bytes += m_indices[i].capacity()*sizeof(int) + 16;
+      return bytes;
+   }
+private:
+   std::vector< std::vector<int> > m_indices;
+};
+
+//An n x n grid of vertices, triangulated into a manifold sheet.
+void buildManifoldSheet(SimplicialComplex& mesh, int n) {
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < n*n; ++i)
+      verts.push_back(mesh.addVertex());
+   for(int i = 0; i < n-1; ++i) for(int j = 0; j < n-1; ++j) {
+      VertexHandle v00 = verts[i*n+j], v10 = verts[(i+1)*n+j], v01 = verts[i*n+j+1], v11 = verts[(i+1)*n+j+1];
+      mesh.addFace(v00, v10, v11);
+      mesh.addFace(v00, v11, v01);
+   }
+}
+
+//A chain of spine edges, each shared by many triangular "pages", and with every page tip
+//also joined to a single hub vertex. Heavily non-manifold at both the spines and the hub.
+void buildNonManifoldBook(SimplicialComplex& mesh, int spines, int pages) {
+   VertexHandle hub = mesh.addVertex();
+   VertexHandle prev = mesh.addVertex();
+   for(int s = 0; s < spines; ++s) {
+      VertexHandle next = mesh.addVertex();
+      for(int p = 0; p < pages; ++p) {
+         VertexHandle tip = mesh.addVertex();
+         mesh.addFace(prev, next, tip);
+         mesh.addEdge(tip, hub);
+      }
+      prev = next;
+   }
+}
+
+//An n x n x n block of cubes, each split into the 6 tets of the Kuhn triangulation.
+void buildTetGrid(TopologyBackend& mesh, int n, std::vector<VertexHandle>& verts) {
+   int m = n+1;
+   for(int i = 0; i < m*m*m; ++i)
+      verts.push_back(mesh.addVertex());
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { 1, m, m*m };
+   for(int i = 0; i < n; ++i) for(int j = 0; j < n; ++j) for(int k = 0; k < n; ++k) {
+      int corner = (i*m + j)*m + k;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         mesh.addSimplex(Simplex(verts[corner], verts[v1], verts[v2], verts[v3]));
+      }
+   }
+}
+
+//The same triangulated sheet as buildManifoldSheet, through the backend interface.
+void buildTriangleSheet(TopologyBackend& mesh, int n, std::vector<VertexHandle>& verts) {
+   for(int i = 0; i < n*n; ++i)
+      verts.push_back(mesh.addVertex());
+   for(int i = 0; i < n-1; ++i) for(int j = 0; j < n-1; ++j) {
+      VertexHandle v00 = verts[i*n+j], v10 = verts[(i+1)*n+j], v01 = verts[i*n+j+1], v11 = verts[(i+1)*n+j+1];
+      mesh.addSimplex(Simplex(v00, v10, v11));
+      mesh.addSimplex(Simplex(v00, v11, v01));
+   }
+}
+
+//A mixed-dimensional, non-manifold complex: a strip of tets, with a book of triangular pages hinged
+//on each of its outer edges, and a dangling wire edge off every page tip.
+void buildMixedComplex(TopologyBackend& mesh, int length, int pages, std::vector<VertexHandle>& verts) {
+   for(int i = 0; i < 4*(length+1); ++i)
+      verts.push_back(mesh.addVertex());
+   for(int s = 0; s < length; ++s) {
+      const VertexHandle* a = &verts[4*s];
+      const VertexHandle* b = &verts[4*(s+1)];
+      mesh.addSimplex(Simplex(a[0], a[1], a[2], b[0]));
+      mesh.addSimplex(Simplex(a[1], a[2], b[0], b[1]));
+      mesh.addSimplex(Simplex(a[2], b[0], b[1], b[2]));
+      for(int p = 0; p < pages; ++p) {
+         VertexHandle tip = mesh.addVertex(), wire = mesh.addVertex();
+         verts.push_back(tip);
+         verts.push_back(wire);
+         mesh.addSimplex(Simplex(a[3], b[3], tip));
+         mesh.addSimplex(Simplex(tip, wire));
+      }
+   }
+}
+
+//Number the simplices densely, so the raw relations can be copied into other containers.
+template<class Rows>
+void copyUpwardRows(SimplicialComplex& mesh, Rows& ve, Rows& ef) {
+   VertexProperty<int> vid(mesh);
+   EdgeProperty<int> eid(mesh);
+   FaceProperty<int> fid(mesh);
+   int count = 0;
+   for(VertexIterator it(mesh); !it.done(); it.advance()) vid[it.current()] = count++;
+   count = 0;
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) eid[it.current()] = count++;
+   count = 0;
+   for(FaceIterator it(mesh); !it.done(); it.advance()) fid[it.current()] = count++;
+
+   for(VertexIterator it(mesh); !it.done(); it.advance())
+      for(VertexEdgeIterator veit(mesh, it.current()); !veit.done(); veit.advance())
+         ve.set(vid[it.current()], eid[veit.current()], 1);
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      for(EdgeFaceIterator efit(mesh, it.current()); !efit.done(); efit.advance())
+         ef.set(eid[it.current()], fid[efit.current()], 1);
+}
+
+//////////////////////////////////////////////////////////////////////////
+//Benchmarks
+
+void reportUpwardRows(const char* name, SimplicialComplex& mesh) {
+   const int repeats = 20;
+   long long checksum = 0;
+
+   //the real iterators, running on the complex's own (inline + overflow) storage
+   Timer timer;
+   for(int r = 0; r < repeats; ++r) {
+      for(VertexIterator it(mesh); !it.done(); it.advance())
+         for(VertexEdgeIterator veit(mesh, it.current()); !veit.done(); veit.advance())
+            checksum += veit.current().isValid();
+      for(EdgeIterator it(mesh); !it.done(); it.advance())
+         for(EdgeFaceIterator efit(mesh, it.current()); !efit.done(); efit.advance())
+            checksum += efit.current().isValid();
+   }
+   double iterTime = timer.seconds();
+
+   printf("%s: %d verts, %d edges, %d faces\n", name, mesh.numVerts(), mesh.numEdges(), mesh.numFaces());
+   printf("  VertexEdgeIterator + EdgeFaceIterator sweep: %.3f ms\n", 1000*iterTime/repeats);
+
+   //the same relations in the original vector-of-vectors rows, and in IncidenceMatrix with several inline widths
+   VectorRows vecVE(mesh.numVerts()), vecEF(mesh.numEdges());
+   copyUpwardRows(mesh, vecVE, vecEF);
+   double vecTime = 0;
+   {
+      Timer t;
+      for(int r = 0; r < repeats; ++r) {
+         for(int i = 0; i < mesh.numVerts(); ++i)
+            for(unsigned int k = 0; k < vecVE.getNumEntriesInRow(i); ++k) checksum += vecVE.getColByIndex(i, k);
+         for(int i = 0; i < mesh.numEdges(); ++i)
+            for(unsigned int k = 0; k < vecEF.getNumEntriesInRow(i); ++k) checksum += vecEF.getColByIndex(i, k);
+      }
+      vecTime = t.seconds();
+   }
+   printf("  std::vector rows        : %10lu bytes, sweep %.3f ms\n",
+      (unsigned long)(vecVE.memoryUsage() + vecEF.memoryUsage()), 1000*vecTime/repeats);
+
+   const unsigned int widths[][2] = { {0, 0}, {8, 4}, {12, 2} };
+   for(int w = 0; w < 3; ++w) {
+      IncidenceMatrix ve(mesh.numVerts(), mesh.numEdges()), ef(mesh.numEdges(), mesh.numFaces());
+      ve.setInlineWidth(widths[w][0]);
+      ef.setInlineWidth(widths[w][1]);
+      copyUpwardRows(mesh, ve, ef);
+
+      Timer t;
+      for(int r = 0; r < repeats; ++r) {
+         for(unsigned int i = 0; i < ve.getNumRows(); ++i)
+            for(unsigned int k = 0; k < ve.getNumEntriesInRow(i); ++k) checksum += ve.getColByIndex(i, k);
+         for(unsigned int i = 0; i < ef.getNumRows(); ++i)
+            for(unsigned int k = 0; k < ef.getNumEntriesInRow(i); ++k) checksum += ef.getColByIndex(i, k);
+      }
+      double time = t.seconds();
+      printf("  inline VE %2u / EF %2u    : %10lu bytes, sweep %.3f ms\n", widths[w][0], widths[w][1],
+         (unsigned long)(ve.memoryUsage() + ef.memoryUsage()), 1000*time/repeats);
+   }
+
+   printf("  (checksum %lld)\n", checksum);
+}
+
+void bench_upwardRows() {
+   SimplicialComplex sheet;
+   buildManifoldSheet(sheet, 300);
+   reportUpwardRows("Manifold sheet", sheet);
+
+   SimplicialComplex book;
+   buildNonManifoldBook(book, 2000, 40);
+   reportUpwardRows("Non-manifold book", book);
+}
+
+void bench_frozenTraversal() {
+   SimplicialComplex mesh;
+   buildManifoldSheet(mesh, 300);
+
+   const int repeats = 20;
+   long long checksum = 0;
+
+   //vertex -> edges -> faces -> vertices, on the mutable structure
+   Timer timer;
+   for(int r = 0; r < repeats; ++r)
+      for(VertexIterator it(mesh); !it.done(); it.advance())
+         for(VertexEdgeIterator veit(mesh, it.current()); !veit.done(); veit.advance())
+            for(EdgeFaceIterator efit(mesh, veit.current()); !efit.done(); efit.advance())
+               for(FaceVertexIterator fvit(mesh, efit.current()); !fvit.done(); fvit.advance())
+                  checksum += fvit.current().isValid();
+   double mutableTime = timer.seconds();
+
+   Timer buildTimer;
+   CompactComplex frozen;
+   mesh.freeze(frozen);
+   double buildTime = buildTimer.seconds();
+
+   //the same walk on the snapshot, staying in dense indices throughout
+   Timer frozenTimer;
+   for(int r = 0; r < repeats; ++r)
+      for(int v = 0; v < frozen.numVerts(); ++v)
+         for(CompactComplex::VertexEdgeIterator veit(frozen, v); !veit.done(); veit.advance())
+            for(CompactComplex::EdgeFaceIterator efit(frozen, veit.index()); !efit.done(); efit.advance())
+               for(CompactComplex::FaceVertexIterator fvit(frozen, efit.index()); !fvit.done(); fvit.advance())
+                  checksum += fvit.vertexIndex() >= 0;
+   double frozenTime = frozenTimer.seconds();
+
+   printf("Frozen traversal (%d faces): mutable %.3f ms, frozen %.3f ms, freeze() %.3f ms  (checksum %lld)\n",
+      mesh.numFaces(), 1000*mutableTime/repeats, 1000*frozenTime/repeats, 1000*buildTime, checksum);
+}
+
+//Time the full star of every vertex (vertex -> edges -> faces -> tets) and the boundary of every edge found.
+void reportBackend(const char* shape, TopologyBackend& mesh, const std::vector<VertexHandle>& verts, double buildTime) {
+   const int repeats = 3;
+   long long checksum = 0;
+   std::vector<Simplex> edges, faces, tets, bounds;
+
+   Timer timer;
+   for(int r = 0; r < repeats; ++r) {
+      for(unsigned int i = 0; i < verts.size(); ++i) {
+         edges.clear();
+         mesh.coboundary(Simplex(verts[i]), edges);
+         for(unsigned int e = 0; e < edges.size(); ++e) {
+            bounds.clear();
+            mesh.boundary(edges[e], bounds);
+            faces.clear();
+            mesh.coboundary(edges[e], faces);
+            for(unsigned int f = 0; f < faces.size(); ++f) {
+               tets.clear();
+               mesh.coboundary(faces[f], tets);
+               checksum += tets.size();
+            }
+            checksum += bounds.size() + faces.size();
+         }
+      }
+   }
+   double time = timer.seconds();
+
+   printf("  %-9s %-16s: %10lu bytes, build %8.2f ms, star sweep %8.2f ms  (checksum %lld)\n", shape, mesh.name(),
+      (unsigned long)mesh.memoryUsage(), 1000*buildTime, 1000*time/repeats, checksum);
+}
+
+void bench_backends() {
+   printf("Topology backends:\n");
+   for(int shape = 0; shape < 3; ++shape) {
+      IncidenceBackend reference;
+      IAStarBackend compact;
+      TopologyBackend* backends[2] = { &reference, &compact };
+
+      for(int b = 0; b < 2; ++b) {
+         std::vector<VertexHandle> verts;
+         Timer timer;
+         const char* name = "";
+         switch(shape) {
+            case 0: buildTetGrid(*backends[b], 16, verts); name = "tets"; break;
+            case 1: buildTriangleSheet(*backends[b], 200, verts); name = "triangles"; break;
+            case 2: buildMixedComplex(*backends[b], 2000, 8, verts); name = "mixed"; break;
+         }
+         reportBackend(name, *backends[b], verts, timer.seconds());
+      }
+   }
+}
+
+struct Point {
+   double x[3];
+   double operator[](int i) const { return x[i]; }
+};
+
+//A typical per-tet assembly loop: gather the four vertex positions and write a per-tet result.
+double assembleTets(SimplicialComplex& mesh, VertexProperty<Point>& pos, TetProperty<double>& result) {
+   const int repeats = 5;
+   Timer timer;
+   for(int r = 0; r < repeats; ++r) {
+      for(TetIterator it(mesh); !it.done(); it.advance()) {
+         TetHandle th = it.current();
+         double sum = 0;
+         for(int i = 0; i < 4; i += 3) { //two opposite faces cover all four vertices
+            FaceHandle fh = mesh.getFace(th, i);
+            for(int j = 0; j < 3; ++j) {
+               const Point& p = pos[mesh.getVertex(mesh.getEdge(fh, j), 0)];
+               sum += p[0] + p[1] + p[2];
+            }
+         }
+         result[th] = sum;
+      }
+   }
+   return 1000*timer.seconds()/repeats;
+}
+
+void bench_reordering() {
+   //a block of cubes, created in scrambled order
+   const int n = 30, m = n+1;
+   SimplicialComplex mesh;
+   VertexProperty<Point> pos(mesh);
+   TetProperty<double> result(mesh);
+
+   std::vector<int> shuffle(m*m*m);
+   for(int i = 0; i < m*m*m; ++i) shuffle[i] = i;
+   std::random_shuffle(shuffle.begin(), shuffle.end());
+   std::vector<VertexHandle> verts(m*m*m);
+   for(int i = 0; i < m*m*m; ++i) {
+      int id = shuffle[i];
+      verts[id] = mesh.addVertex();
+      Point p = { { double(id / (m*m)), double((id / m) % m), double(id % m) } };
+      pos[verts[id]] = p;
+   }
+   std::vector<int> cubes(n*n*n);
+   for(int i = 0; i < n*n*n; ++i) cubes[i] = i;
+   std::random_shuffle(cubes.begin(), cubes.end());
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { m*m, m, 1 };
+   for(int c = 0; c < n*n*n; ++c) {
+      int corner = (cubes[c] / (n*n))*m*m + ((cubes[c] / n) % n)*m + cubes[c] % n;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         mesh.addTet(verts[corner], verts[v1], verts[v2], verts[v3]);
+      }
+   }
+
+   printf("Reordering (%d tets), per-tet assembly loop:\n", mesh.numTets());
+   printf("  scrambled : %8.2f ms\n", assembleTets(mesh, pos, result));
+   for(int pass = 0; pass < 3; ++pass) {
+      const char* names[3] = { "Hilbert", "RCM", "tet BFS" };
+      Timer timer;
+      if(pass == 0) mesh.reorderHilbert(pos);
+      else if(pass == 1) mesh.reorderRCM();
+      else mesh.reorderTetBFS();
+      double reorderTime = 1000*timer.seconds();
+      printf("  %-9s : %8.2f ms  (reorder %.1f ms)\n", names[pass], assembleTets(mesh, pos, result), reorderTime);
+   }
+}
+
+//Build an n x n x n block of Kuhn-split cubes, with a few properties attached, optionally reserving first.
+double buildGrid(int n, bool reserve) {
+   const int m = n+1;
+   Timer timer;
+
+   SimplicialComplex mesh;
+   VertexProperty<Point> pos(mesh);
+   FaceProperty<int> faceTag(mesh);
+   TetProperty<double> volume(mesh);
+   if(reserve) {
+      //counts for the Kuhn triangulation of the block
+      mesh.reserveVertices(m*m*m);
+      mesh.reserveEdges(3*n*m*m + 3*n*n*m + n*n*n);
+      mesh.reserveFaces(6*n*n*m + 6*n*n*n);
+      mesh.reserveTets(6*n*n*n);
+   }
+
+   std::vector<VertexHandle> verts(m*m*m);
+   for(int id = 0; id < m*m*m; ++id) {
+      verts[id] = mesh.addVertex();
+      Point p = { { double(id / (m*m)), double((id / m) % m), double(id % m) } };
+      pos[verts[id]] = p;
+   }
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { m*m, m, 1 };
+   for(int i = 0; i < n; ++i) for(int j = 0; j < n; ++j) for(int k = 0; k < n; ++k) {
+      int corner = (i*m + j)*m + k;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         volume[mesh.addTet(verts[corner], verts[v1], verts[v2], verts[v3])] = 1.0/6;
+      }
+   }
+   double seconds = timer.seconds();
+   printf("  %s: %d tets, %d faces, %d edges, %d verts in %.2f s\n", reserve ? "reserved  " : "unreserved",
+      mesh.numTets(), mesh.numFaces(), mesh.numEdges(), mesh.numVerts(), seconds);
+   return seconds;
+}
+
+void bench_reserve() {
+   //119^3 cubes, about 10M tets
+   const int n = 119;
+   printf("Grid construction with registered properties:\n");
+   buildGrid(n, false);
+   buildGrid(n, true);
+}
+
+//Vertex indices of the Kuhn-split cubes of an n x n x n block, four per tet.
+std::vector<int> kuhnTets(int n) {
+   const int m = n+1;
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { m*m, m, 1 };
+   std::vector<int> tets;
+   tets.reserve(24*n*n*n);
+   for(int i = 0; i < n; ++i) for(int j = 0; j < n; ++j) for(int k = 0; k < n; ++k) {
+      int corner = (i*m + j)*m + k;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         tets.push_back(corner); tets.push_back(v1); tets.push_back(v2); tets.push_back(v3);
+      }
+   }
+   return tets;
+}
+
+void bench_bulkBuild() {
+   const int n = 80;
+   std::vector<int> tets = kuhnTets(n);
+   size_t numTets = tets.size()/4;
+   printf("Construction from a tet soup (%d tets):\n", (int)numTets);
+
+   double incrementalTime, bulkTime;
+   int incrementalCounts[3], bulkCounts[3];
+   {
+      Timer timer;
+      SimplicialComplex mesh;
+      std::vector<VertexHandle> verts((n+1)*(n+1)*(n+1));
+      for(unsigned int i = 0; i < verts.size(); ++i)
+         verts[i] = mesh.addVertex();
+      for(size_t t = 0; t < numTets; ++t)
+         mesh.addTet(verts[tets[4*t]], verts[tets[4*t+1]], verts[tets[4*t+2]], verts[tets[4*t+3]]);
+      incrementalTime = timer.seconds();
+      incrementalCounts[0] = mesh.numEdges(); incrementalCounts[1] = mesh.numFaces(); incrementalCounts[2] = mesh.numTets();
+   }
+   {
+      Timer timer;
+      SimplicialComplex mesh;
+      mesh.buildFromTets(&tets[0], numTets);
+      bulkTime = timer.seconds();
+      bulkCounts[0] = mesh.numEdges(); bulkCounts[1] = mesh.numFaces(); bulkCounts[2] = mesh.numTets();
+   }
+   bool same = std::equal(incrementalCounts, incrementalCounts+3, bulkCounts);
+   printf("  incremental: %.2f s (%.2f M tets/s)\n", incrementalTime, numTets/incrementalTime*1e-6);
+   printf("  bulk       : %.2f s (%.2f M tets/s)  %s\n", bulkTime, numTets/bulkTime*1e-6, same ? "counts match" : "COUNTS DIFFER");
+}
+
+void bench_lookupIndex() {
+   //a grid built with the vertex-based addTet (which looks up every edge and face), then a pass of getFace/getTet queries
+   const int n = 40;
+   std::vector<int> tets = kuhnTets(n);
+   size_t numTets = tets.size()/4;
+   printf("Lookups on a %d tet grid:\n", (int)numTets);
+
+   for(int indexed = 0; indexed < 2; ++indexed) {
+      SimplicialComplex mesh;
+      mesh.setLookupIndex(indexed != 0);
+
+      Timer buildTimer;
+      std::vector<VertexHandle> verts((n+1)*(n+1)*(n+1));
+      for(unsigned int i = 0; i < verts.size(); ++i)
+         verts[i] = mesh.addVertex();
+      for(size_t t = 0; t < numTets; ++t)
+         mesh.addTet(verts[tets[4*t]], verts[tets[4*t+1]], verts[tets[4*t+2]], verts[tets[4*t+3]]);
+      double buildTime = buildTimer.seconds();
+
+      Timer queryTimer;
+      int found = 0;
+      for(FaceIterator it(mesh); !it.done(); it.advance()) {
+         FaceHandle fh = it.current();
+         found += mesh.getFace(mesh.getEdge(fh, 2), mesh.getEdge(fh, 0), mesh.getEdge(fh, 1)) == fh;
+      }
+      for(TetIterator it(mesh); !it.done(); it.advance()) {
+         TetHandle th = it.current();
+         found += mesh.getTet(mesh.getFace(th, 3), mesh.getFace(th, 1), mesh.getFace(th, 2), mesh.getFace(th, 0)) == th;
+      }
+      double queryTime = queryTimer.seconds();
+
+      printf("  %-8s: build %.2f s, %d face+tet queries in %.2f s\n", indexed ? "indexed" : "scanning", buildTime, found, queryTime);
+   }
+
+   //a fan of triangles around one hub vertex, where every vertex-based addFace looks up an edge at the hub
+   const int fan = 20000;
+   printf("Lookups on a %d triangle fan:\n", fan);
+   for(int indexed = 0; indexed < 2; ++indexed) {
+      SimplicialComplex mesh;
+      mesh.setLookupIndex(indexed != 0);
+
+      Timer timer;
+      VertexHandle hub = mesh.addVertex();
+      VertexHandle prev = mesh.addVertex();
+      for(int i = 0; i < fan; ++i) {
+         VertexHandle next = mesh.addVertex();
+         mesh.addFace(hub, prev, next);
+         prev = next;
+      }
+      printf("  %-8s: build %.2f s\n", indexed ? "indexed" : "scanning", timer.seconds());
+   }
+}
+
+void bench_transposes() {
+   //compaction rebuilds all three upward matrices from the downward ones
+   const int n = 80;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   for(TetIterator it(mesh); !it.done(); it.advance(), it.advance())
+      mesh.deleteTet(it.current(), false);
+
+   Timer timer;
+   mesh.compact();
+   double seconds = timer.seconds();
+   size_t entries = 2*(size_t)mesh.numEdges() + 3*(size_t)mesh.numFaces() + 4*(size_t)mesh.numTets();
+   printf("Compaction of %d tets on %u threads: %.2f s (%.1f M incidences/s)\n", mesh.numTets(), workerCount(), seconds, entries/seconds*1e-6);
+}
+
+void bench_memoryReport() {
+   const int n = 80;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   VertexProperty<Point> pos(mesh);
+   TetProperty<double> volume(mesh);
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   for(TetIterator it(mesh); !it.done(); it.advance(), it.advance(), it.advance())
+      mesh.deleteTet(it.current(), true);
+
+   MemoryReport report;
+   const int calls = 1000;
+   Timer timer;
+   for(int i = 0; i < calls; ++i)
+      mesh.memoryReport(report);
+   double reportTime = timer.seconds() / calls;
+
+   Timer histogramTimer;
+   mesh.memoryReport(report, true);
+   double histogramTime = histogramTimer.seconds();
+
+   printf("Memory report on %d tets: %.2f us per call, %.1f ms with row histograms\n", mesh.numTets(), 1e6*reportTime, 1e3*histogramTime);
+   report.print();
+}
+
+void bench_soaUpdate() {
+   //explicit position update, x += dt*v, over every vertex
+   const int numVerts = 4000000, steps = 20;
+   const double dt = 0.01;
+   SimplicialComplex mesh;
+   mesh.reserveVertices(numVerts);
+   VertexProperty<Point> posAoS(mesh), velAoS(mesh);
+   VertexPropertySoA<double,3> posSoA(mesh), velSoA(mesh);
+   VertexHandle last;
+   for(int i = 0; i < numVerts; ++i) {
+      VertexHandle vh = last = mesh.addVertex();
+      for(int c = 0; c < 3; ++c) {
+         posAoS[vh].x[c] = posSoA(vh, c) = i;
+         velAoS[vh].x[c] = velSoA(vh, c) = c+1;
+      }
+   }
+   printf("Position update over %d vertices:\n", numVerts);
+
+   Timer aosTimer;
+   for(int s = 0; s < steps; ++s)
+      for(VertexIterator it(mesh); !it.done(); it.advance()) {
+         VertexHandle vh = it.current();
+         for(int c = 0; c < 3; ++c)
+            posAoS[vh].x[c] += dt*velAoS[vh].x[c];
+      }
+   double aosTime = aosTimer.seconds()/steps;
+
+   Timer soaTimer;
+   for(int s = 0; s < steps; ++s)
+      for(unsigned int c = 0; c < 3; ++c) {
+         double* x = posSoA.component(c);
+         const double* v = velSoA.component(c);
+         size_t n = posSoA.slots();
+         for(size_t i = 0; i < n; ++i)
+            x[i] += dt*v[i];
+      }
+   double soaTime = soaTimer.seconds()/steps;
+
+   printf("  AoS, per vertex : %.2f ms/step\n", 1e3*aosTime);
+   printf("  SoA, per array  : %.2f ms/step  (%s)\n", 1e3*soaTime, posSoA(last, 2) == posAoS[last].x[2] ? "results match" : "RESULTS DIFFER");
+}
+
+void bench_sparseProperty() {
+   //a value on each boundary face only: summed over the dense property (skipping unset faces) vs the sparse one
+   const int n = 60, passes = 20;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   FaceProperty<double> dense(mesh);
+   FacePropertySparse<double> sparse(mesh);
+   dense.assign(0);
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      int tetCount = 0;
+      for(FaceTetIterator ftit(mesh, it.current()); !ftit.done(); ftit.advance())
+         ++tetCount;
+      if(tetCount == 1)
+         dense[it.current()] = sparse[it.current()] = 1.0;
+   }
+
+   double denseSum = 0, sparseSum = 0;
+   Timer denseTimer;
+   for(int p = 0; p < passes; ++p)
+      for(FaceIterator it(mesh); !it.done(); it.advance())
+         if(dense[it.current()] != 0)
+            denseSum += dense[it.current()];
+   double denseTime = denseTimer.seconds()/passes;
+
+   Timer sparseTimer;
+   for(int p = 0; p < passes; ++p)
+      for(size_t k = 0; k < sparse.count(); ++k)
+         sparseSum += sparse.valueAt(k);
+   double sparseTime = sparseTimer.seconds()/passes;
+
+   MemoryReport report;
+   mesh.memoryReport(report);
+   printf("Boundary values on %u of %d faces:\n", (unsigned int)sparse.count(), mesh.numFaces());
+   printf("  dense : %.3f ms/pass, %.1f MB\n", 1e3*denseTime, report.properties[0].used/1048576.0);
+   printf("  sparse: %.3f ms/pass, %.1f MB  (%s)\n", 1e3*sparseTime, report.properties[1].used/1048576.0, denseSum == sparseSum ? "sums match" : "SUMS DIFFER");
+}
+
+//Per-tet sum of vertex heights, standing in for a volume or mass computation.
+double tetHeight(SimplicialComplex& mesh, const VertexProperty<double>& height, const TetHandle& th) {
+   double sum = 0;
+   for(TetVertexIterator tvit(mesh, th); !tvit.done(); tvit.advance())
+      sum += height[tvit.current()];
+   return sum;
+}
+
+void bench_dirtyTracking() {
+   //move 1% of the vertices, then bring a per-tet quantity up to date
+   const int n = 40, steps = 5;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   VertexProperty<double> height(mesh);
+   TetProperty<double> result(mesh);
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   height.assign(0);
+   std::vector<VertexHandle> verts;
+   for(VertexIterator it(mesh); !it.done(); it.advance())
+      verts.push_back(it.current());
+
+   //cost of the flag on plain writes
+   double writeTime[2];
+   for(int tracking = 0; tracking < 2; ++tracking) {
+      height.trackDirty(tracking != 0);
+      Timer timer;
+      for(int s = 0; s < 20; ++s)
+         for(unsigned int i = 0; i < verts.size(); ++i)
+            height[verts[i]] += 1.0;
+      writeTime[tracking] = timer.seconds()/20;
+   }
+   height.clearDirty();
+
+   double fullTime = 0, incrementalTime = 0;
+   const VertexProperty<double>& heights = height;
+   for(int s = 0; s < steps; ++s) {
+      for(unsigned int i = s; i < verts.size(); i += 100)
+         height[verts[i]] += 1.0;
+
+      Timer fullTimer;
+      for(TetIterator it(mesh); !it.done(); it.advance())
+         result[it.current()] = tetHeight(mesh, heights, it.current());
+      fullTime += fullTimer.seconds();
+
+      Timer incrementalTimer;
+      for(VertexHandle vh = height.firstDirty(); vh.isValid(); vh = height.nextDirty(vh))
+         for(VertexTetIterator vtit(mesh, vh); !vtit.done(); vtit.advance())
+            result[vtit.current()] = tetHeight(mesh, heights, vtit.current());
+      height.clearDirty();
+      incrementalTime += incrementalTimer.seconds();
+   }
+
+   printf("Dirty tracking on %d tets, %u of %u vertices moved per step:\n", mesh.numTets(), (unsigned int)(verts.size()+99)/100, (unsigned int)verts.size());
+   printf("  writes        : %.2f ms untracked, %.2f ms tracked\n", 1e3*writeTime[0], 1e3*writeTime[1]);
+   printf("  full update   : %.2f ms/step\n", 1e3*fullTime/steps);
+   printf("  dirty update  : %.2f ms/step\n", 1e3*incrementalTime/steps);
+}
+
+//Split every third original edge of a sheet, keeping a vertex field and a face label up to date either through
+//update policies or by a second pass over the results. Returns the seconds taken.
+double splitSheet(int n, bool policies) {
+   SimplicialComplex mesh;
+   VertexProperty<double> height(mesh);
+   FaceProperty<int> material(mesh);
+   buildManifoldSheet(mesh, n);
+   height.assign(1.0);
+   material.assign(3);
+   if(policies) {
+      height.setUpdatePolicy(MidpointUpdate<double>());
+      material.setUpdatePolicy(CopyUpdate<int>());
+   }
+   std::vector<EdgeHandle> edges;
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      edges.push_back(it.current());
+
+   Timer timer;
+   std::vector<FaceHandle> newFaces;
+   std::vector<int> parentMaterials;
+   for(unsigned int i = 0; i < edges.size(); i += 3) {
+      if(policies) {
+         mesh.splitEdge(edges[i], newFaces);
+         continue;
+      }
+      //what a remeshing loop has to do otherwise: gather before, then patch up after
+      VertexHandle from = mesh.fromVertex(edges[i]), to = mesh.toVertex(edges[i]);
+      parentMaterials.clear();
+      for(EdgeFaceIterator efit(mesh, edges[i]); !efit.done(); efit.advance())
+         parentMaterials.push_back(material[efit.current()]);
+      VertexHandle mid = mesh.splitEdge(edges[i], newFaces);
+      height[mid] = 0.5*(height[from] + height[to]);
+      for(unsigned int f = 0; f < newFaces.size(); ++f)
+         material[newFaces[f]] = parentMaterials[f/2];
+   }
+   return timer.seconds();
+}
+
+void bench_updatePolicies() {
+   const int n = 400;
+   printf("Splitting a third of the edges of a %d x %d sheet:\n", n, n);
+   printf("  second pass     : %.2f s\n", splitSheet(n, false));
+   printf("  update policies : %.2f s\n", splitSheet(n, true));
+}
+
+void bench_bufferedStep() {
+   //explicit steps x' = x + dt*v, v' = 0.99*v over every vertex, with separate current/next properties
+   //copied back each step vs double-buffered properties swapped
+   const int numVerts = 2000000, steps = 20;
+   const double dt = 0.01;
+   SimplicialComplex mesh;
+   mesh.reserveVertices(numVerts);
+   VertexProperty<double> x(mesh), v(mesh), xNext(mesh), vNext(mesh);
+   VertexPropertyBuffered<double> xb(mesh), vb(mesh);
+   for(int i = 0; i < numVerts; ++i) {
+      VertexHandle vh = mesh.addVertex();
+      x[vh] = xb.current(vh) = i;
+      v[vh] = vb.current(vh) = 1;
+   }
+   VertexHandle last = VertexIterator(mesh).current();
+
+   Timer copyTimer;
+   for(int s = 0; s < steps; ++s) {
+      for(VertexIterator it(mesh); !it.done(); it.advance()) {
+         VertexHandle vh = it.current();
+         xNext[vh] = x[vh] + dt*v[vh];
+         vNext[vh] = 0.99*v[vh];
+      }
+      for(VertexIterator it(mesh); !it.done(); it.advance()) {
+         x[it.current()] = xNext[it.current()];
+         v[it.current()] = vNext[it.current()];
+      }
+   }
+   double copyTime = copyTimer.seconds()/steps;
+
+   Timer swapTimer;
+   for(int s = 0; s < steps; ++s) {
+      for(VertexIterator it(mesh); !it.done(); it.advance()) {
+         VertexHandle vh = it.current();
+         xb.next(vh) = xb.current(vh) + dt*vb.current(vh);
+         vb.next(vh) = 0.99*vb.current(vh);
+      }
+      xb.swapBuffers();
+      vb.swapBuffers();
+   }
+   double swapTime = swapTimer.seconds()/steps;
+
+   printf("Time stepping %d vertices:\n", numVerts);
+   printf("  copy back : %.2f ms/step\n", 1e3*copyTime);
+   printf("  swap      : %.2f ms/step  (%s)\n", 1e3*swapTime, x[last] == xb.current(last) ? "results match" : "RESULTS DIFFER");
+}
+
+void bench_compressedProperties() {
+   //a scalar field and a position field per vertex, stored plain and compressed, decoded in blocks for a kernel
+   const int numVerts = 2000000, block = 4096;
+   SimplicialComplex mesh;
+   mesh.reserveVertices(numVerts);
+   VertexProperty<float> plainScalar(mesh);
+   VertexPropertySoA<float,3> plainPosition(mesh);
+   VertexPropertyCompressed<HalfCodec> halfScalar(mesh);
+   VertexPropertyCompressed<QuantizedCodec<16>, 3> quantizedPosition(mesh, QuantizedCodec<16>(-1.0f, 1.0f));
+   for(int i = 0; i < numVerts; ++i) {
+      VertexHandle vh = mesh.addVertex();
+      float s = std::sin(0.001f*i);
+      plainScalar[vh] = s;
+      halfScalar.set(vh, s);
+      for(unsigned int c = 0; c < 3; ++c) {
+         plainPosition(vh, c) = 0.5f*s + 0.1f*c;
+         quantizedPosition.set(vh, c, 0.5f*s + 0.1f*c);
+      }
+   }
+
+   Timer scalarTimer;
+   std::vector<float> span(3*block);
+   double sum = 0;
+   for(size_t first = 0; first < halfScalar.slots(); first += block) {
+      size_t count = std::min<size_t>(block, halfScalar.slots() - first);
+      halfScalar.decode(first, count, &span[0]);
+      for(size_t i = 0; i < count; ++i)
+         sum += span[i];
+   }
+   double scalarTime = scalarTimer.seconds();
+
+   Timer positionTimer;
+   for(size_t first = 0; first < quantizedPosition.slots(); first += block) {
+      size_t count = std::min<size_t>(block, quantizedPosition.slots() - first);
+      quantizedPosition.decode(first, count, &span[0]);
+      for(size_t i = 0; i < 3*count; ++i)
+         sum += span[i];
+   }
+   double positionTime = positionTimer.seconds();
+
+   MemoryReport report;
+   mesh.memoryReport(report);
+   printf("Compressed fields on %d vertices (checksum %.1f):\n", numVerts, sum);
+   printf("  scalar  : %.1f MB as float, %.1f MB as half; decode %.2f ms\n", report.properties[0].used/1048576.0, report.properties[2].used/1048576.0, 1e3*scalarTime);
+   printf("  position: %.1f MB as float, %.1f MB quantized to 16 bits; decode %.2f ms\n", report.properties[1].used/1048576.0, report.properties[3].used/1048576.0, 1e3*positionTime);
+}
+
+void bench_compositeIterators() {
+   //one pass of each composite iterator over a grid, against gathering the same simplices into a std::set
+   //through the elementary iterators (which is what the composite iterators used to do)
+   const int n = 40;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   printf("Composite iterators on %d tets:\n", mesh.numTets());
+
+   size_t setCount = 0;
+   Timer setTimer;
+   for(VertexIterator vit(mesh); !vit.done(); vit.advance()) {
+      std::set<FaceHandle> faces;
+      std::set<TetHandle> vertTets;
+      for(VertexEdgeIterator veit(mesh, vit.current()); !veit.done(); veit.advance())
+         for(EdgeFaceIterator efit(mesh, veit.current()); !efit.done(); efit.advance()) {
+            faces.insert(efit.current());
+            for(FaceTetIterator ftit(mesh, efit.current()); !ftit.done(); ftit.advance())
+               vertTets.insert(ftit.current());
+         }
+      setCount += faces.size() + vertTets.size();
+   }
+   for(EdgeIterator eit(mesh); !eit.done(); eit.advance()) {
+      std::set<TetHandle> edgeTets;
+      for(EdgeFaceIterator efit(mesh, eit.current()); !efit.done(); efit.advance())
+         for(FaceTetIterator ftit(mesh, efit.current()); !ftit.done(); ftit.advance())
+            edgeTets.insert(ftit.current());
+      setCount += edgeTets.size();
+   }
+   for(TetIterator tit(mesh); !tit.done(); tit.advance()) {
+      std::set<VertexHandle> verts;
+      std::set<EdgeHandle> edges;
+      for(TetFaceIterator tfit(mesh, tit.current()); !tfit.done(); tfit.advance())
+         for(FaceEdgeIterator feit(mesh, tfit.current()); !feit.done(); feit.advance()) {
+            edges.insert(feit.current());
+            for(EdgeVertexIterator evit(mesh, feit.current()); !evit.done(); evit.advance())
+               verts.insert(evit.current());
+         }
+      setCount += verts.size() + edges.size();
+   }
+   double setTime = setTimer.seconds();
+
+   size_t iteratorCount = 0;
+   Timer iteratorTimer;
+   for(VertexIterator vit(mesh); !vit.done(); vit.advance()) {
+      for(VertexFaceIterator vfit(mesh, vit.current()); !vfit.done(); vfit.advance())
+         ++iteratorCount;
+      for(VertexTetIterator vtit(mesh, vit.current()); !vtit.done(); vtit.advance())
+         ++iteratorCount;
+   }
+   for(EdgeIterator eit(mesh); !eit.done(); eit.advance())
+      for(EdgeTetIterator etit(mesh, eit.current()); !etit.done(); etit.advance())
+         ++iteratorCount;
+   for(TetIterator tit(mesh); !tit.done(); tit.advance()) {
+      for(TetVertexIterator tvit(mesh, tit.current()); !tvit.done(); tvit.advance())
+         ++iteratorCount;
+      for(TetEdgeIterator teit(mesh, tit.current()); !teit.done(); teit.advance())
+         ++iteratorCount;
+   }
+   double iteratorTime = iteratorTimer.seconds();
+
+   printf("  std::set gather: %.1f ms\n", 1e3*setTime);
+   printf("  iterators      : %.1f ms  (%s)\n", 1e3*iteratorTime, setCount == iteratorCount ? "counts match" : "COUNTS DIFFER");
+}
+
+void bench_ranges() {
+   //a vertex smoothing pass (neighbour averages) and a sum over tets, written with iterators and with ranges
+   const int n = 60;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   VertexProperty<double> value(mesh), smoothed(mesh);
+   TetProperty<double> weight(mesh);
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   int i = 0;
+   for(VertexIterator it(mesh); !it.done(); it.advance(), ++i)
+      value[it.current()] = std::sin(0.01*i);
+   weight.assign(0.5);
+
+   Timer iteratorTimer;
+   for(VertexIterator it(mesh); !it.done(); it.advance()) {
+      double sum = 0;
+      int count = 0;
+      for(VertexVertexIterator vvit(mesh, it.current()); !vvit.done(); vvit.advance(), ++count)
+         sum += value[vvit.current()];
+      smoothed[it.current()] = sum / count;
+   }
+   double iteratorTotal = 0;
+   for(TetIterator it(mesh); !it.done(); it.advance())
+      for(TetVertexIterator tvit(mesh, it.current()); !tvit.done(); tvit.advance())
+         iteratorTotal += weight[it.current()] * smoothed[tvit.current()];
+   double iteratorTime = iteratorTimer.seconds();
+
+   Timer rangeTimer;
+   for(auto vh : mesh.vertices()) {
+      double sum = 0;
+      AdjacencyRange<VertexVertexRows> neighbours = mesh.vertexVertices(vh);
+      for(auto nh : neighbours)
+         sum += value[nh];
+      smoothed[vh] = sum / neighbours.size();
+   }
+   double rangeTotal = 0;
+   for(auto th : mesh.tets())
+      for(auto vh : mesh.tetVertices(th))
+         rangeTotal += weight[th] * smoothed[vh];
+   double rangeTime = rangeTimer.seconds();
+
+   printf("Smoothing and tet sums on %d tets:\n", mesh.numTets());
+   printf("  iterators: %.1f ms\n", 1e3*iteratorTime);
+   printf("  ranges   : %.1f ms  (%s)\n", 1e3*rangeTime, iteratorTotal == rangeTotal ? "results match" : "RESULTS DIFFER");
+}
+
+void bench_orientedGathers() {
+   //the per-element vertex gather of an FEM assembly: iterator, fixed-size gather, and one batched call
+   const int n = 60;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   VertexProperty<double> value(mesh);
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   int i = 0;
+   for(auto vh : mesh.vertices())
+      value[vh] = std::sin(0.01*i++);
+   const VertexProperty<double>& values = value;
+
+   Timer iteratorTimer;
+   double iteratorSum = 0;
+   for(TetIterator it(mesh); !it.done(); it.advance())
+      for(TetVertexIterator tvit(mesh, it.current()); !tvit.done(); tvit.advance())
+         iteratorSum += values[tvit.current()];
+   double iteratorTime = iteratorTimer.seconds();
+
+   Timer gatherTimer;
+   double gatherSum = 0;
+   for(auto th : mesh.tets()) {
+      VertexHandle verts[4];
+      mesh.getTetVertices(th, verts);
+      for(int k = 0; k < 4; ++k)
+         gatherSum += values[verts[k]];
+   }
+   double gatherTime = gatherTimer.seconds();
+
+   Timer batchTimer;
+   std::vector<TetHandle> handles = mesh.tets().handles();
+   std::vector<int> indices(4*handles.size());
+   mesh.getTetVertices(&handles[0], handles.size(), &indices[0]);
+   double batchTime = batchTimer.seconds();
+
+   printf("Tet vertex gathers on %d tets:\n", mesh.numTets());
+   printf("  TetVertexIterator: %.1f ms\n", 1e3*iteratorTime);
+   printf("  getTetVertices   : %.1f ms  (%s, oriented)\n", 1e3*gatherTime, std::fabs(iteratorSum - gatherSum) < 1e-6*std::fabs(iteratorSum) ? "sums match" : "SUMS DIFFER");
+   printf("  batched, %u threads: %.1f ms to a flat index array\n", workerCount(), 1e3*batchTime);
+}
+
+void bench_adjacencyCaches() {
+   //repeated neighbourhood sweeps, as in smoothing or a solver: gathered each time vs read from the caches
+   const int n = 40, sweeps = 5;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   int tetCount = mesh.numTets();
+
+   Timer gatherTimer;
+   long long gathered = 0;
+   for(int s = 0; s < sweeps; ++s) {
+      for(VertexIterator vit(mesh); !vit.done(); vit.advance())
+         for(VertexTetIterator vtit(mesh, vit.current()); !vtit.done(); vtit.advance())
+            ++gathered;
+      for(TetIterator tit(mesh); !tit.done(); tit.advance())
+         for(TetFaceIterator tfit(mesh, tit.current()); !tfit.done(); tfit.advance())
+            for(FaceTetIterator ftit(mesh, tfit.current()); !ftit.done(); ftit.advance())
+               if(!(ftit.current() == tit.current()))
+                  ++gathered;
+   }
+   double gatherTime = gatherTimer.seconds();
+
+   Timer buildTimer;
+   mesh.updateAdjacencyCaches();
+   double buildTime = buildTimer.seconds();
+
+   Timer cachedTimer;
+   long long cached = 0;
+   for(int s = 0; s < sweeps; ++s) {
+      for(VertexIterator vit(mesh); !vit.done(); vit.advance())
+         for(CachedVertexTetIterator vtit(mesh, vit.current()); !vtit.done(); vtit.advance())
+            ++cached;
+      for(TetIterator tit(mesh); !tit.done(); tit.advance())
+         for(TetTetIterator ttit(mesh, tit.current()); !ttit.done(); ttit.advance())
+            ++cached;
+   }
+   double cachedTime = cachedTimer.seconds();
+
+   //a light round of edits only regathers the rows it touched
+   std::vector<TetHandle> handles = mesh.tets().handles();
+   for(size_t t = 0; t < handles.size(); t += 97)
+      mesh.deleteTet(handles[t], false);
+   Timer patchTimer;
+   long long patched = 0;
+   for(VertexIterator vit(mesh); !vit.done(); vit.advance())
+      for(CachedVertexTetIterator vtit(mesh, vit.current()); !vtit.done(); vtit.advance())
+         ++patched;
+   double patchTime = patchTimer.seconds();
+
+   printf("Vertex-tet and tet-tet sweeps (x%d) on %d tets:\n", sweeps, tetCount);
+   printf("  gathered : %.1f ms\n", 1e3*gatherTime);
+   printf("  cached   : %.1f ms  (+%.1f ms to build, %s)\n", 1e3*cachedTime, 1e3*buildTime, cached == gathered ? "same visits" : "VISITS DIFFER");
+   printf("  vertex-tet sweep after deleting every 97th tet: %.1f ms  (%s)\n", 1e3*patchTime, patched == 4*(long long)mesh.numTets() ? "ok" : "WRONG");
+}
+
+void bench_occupancy() {
+   //global sweeps over a complex after heavy coarsening (7 of every 8 tets gone, in runs), and random sampling
+   const int n = 40, sweeps = 20, samples = 1000000;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   std::vector<TetHandle> handles = mesh.tets().handles();
+   for(size_t t = 0; t < handles.size(); ++t)
+      if(t % 512 >= 64)
+         mesh.deleteTet(handles[t], false);
+
+   Timer sweepTimer;
+   long long visited = 0;
+   for(int s = 0; s < sweeps; ++s)
+      for(TetIterator it(mesh); !it.done(); it.advance())
+         ++visited;
+   double sweepTime = sweepTimer.seconds();
+
+   Timer rangeTimer;
+   long long ranged = 0;
+   for(int s = 0; s < sweeps; ++s)
+      for(auto th : mesh.tets())
+         ranged += th.isValid();
+   double rangeTime = rangeTimer.seconds();
+
+   Timer sampleTimer;
+   unsigned int seed = 12345, hits = 0;
+   for(int i = 0; i < samples; ++i) {
+      seed = seed*1664525u + 1013904223u;
+      hits += mesh.nthTet(seed % mesh.numTets()).isValid();
+   }
+   double sampleTime = sampleTimer.seconds();
+
+   printf("Global sweeps (x%d) over %d live tets in %u slots:\n", sweeps, mesh.numTets(), (unsigned int)handles.size());
+   printf("  TetIterator : %.1f ms  (%s)\n", 1e3*sweepTime, visited == (long long)sweeps*mesh.numTets() ? "ok" : "WRONG");
+   printf("  tets() range: %.1f ms  (%s)\n", 1e3*rangeTime, ranged == visited ? "ok" : "WRONG");
+   printf("  %d random nthTet samples: %.1f ms  (%s)\n", samples, 1e3*sampleTime, hits == (unsigned int)samples ? "ok" : "WRONG");
+}
+
+//Per-tet work for the parallel loops: the sum of the vertex values, written to the tet
+struct TetVertexSum {
+   const SimplicialComplex& mesh;
+   const VertexProperty<double>& values;
+   TetProperty<double>& result;
+   TetVertexSum(const SimplicialComplex& m, const VertexProperty<double>& v, TetProperty<double>& r) : mesh(m), values(v), result(r) {}
+   void operator()(const TetHandle& th) const {
+      VertexHandle verts[4];
+      mesh.getTetVertices(th, verts);
+      result[th] = std::sqrt(values[verts[0]]*values[verts[0]] + values[verts[1]]*values[verts[1]] +
+                             values[verts[2]]*values[verts[2]] + values[verts[3]]*values[verts[3]]);
+   }
+};
+
+//The same, hand split on slot index the way an OpenMP loop over slots would be
+struct SlotSplitBlock {
+   const SimplicialComplex& mesh;
+   const TetVertexSum& work;
+   size_t slots;
+   std::vector<long long>& perBlock;
+   SlotSplitBlock(const SimplicialComplex& m, const TetVertexSum& w, size_t n, std::vector<long long>& p) : mesh(m), work(w), slots(n), perBlock(p) {}
+   void operator()(size_t begin, size_t end) const {
+      long long count = 0;
+      for(SimplexRange<TetHandle>::const_iterator it(mesh, (unsigned int)begin), last(mesh, (unsigned int)end); it != last; ++it, ++count)
+         work(*it);
+      perBlock[begin * perBlock.size() / slots] = count;
+   }
+};
+
+struct Sum {
+   double operator()(double a, double b) const { return a + b; }
+};
+
+struct ResultValue {
+   const TetProperty<double>& result;
+   ResultValue(const TetProperty<double>& r) : result(r) {}
+   double operator()(const TetHandle& th) const { return result[th]; }
+};
+
+void bench_parallelForEach() {
+   //a per-tet loop after coarsening has emptied most of the back of the tet slots
+   const int n = 40, repeats = 5;
+   std::vector<int> tets = kuhnTets(n);
+   SimplicialComplex mesh;
+   VertexProperty<double> value(mesh);
+   TetProperty<double> result(mesh);
+   mesh.buildFromTets(&tets[0], tets.size()/4);
+   int i = 0;
+   for(auto vh : mesh.vertices())
+      value[vh] = std::sin(0.01*i++);
+   std::vector<TetHandle> handles = mesh.tets().handles();
+   size_t slots = handles.size();
+   for(size_t t = slots/4; t < slots; ++t)
+      if(t % 16 != 0)
+         mesh.deleteTet(handles[t], false);
+   TetVertexSum work(mesh, value, result);
+
+   unsigned int threads = workerCount();
+   std::vector<long long> perBlock(std::max<size_t>(1, std::min<size_t>(threads, slots / 4096)), 0);
+   Timer slotTimer;
+   for(int r = 0; r < repeats; ++r)
+      parallelFor(slots, SlotSplitBlock(mesh, work, slots, perBlock));
+   double slotTime = slotTimer.seconds() / repeats;
+   long long most = *std::max_element(perBlock.begin(), perBlock.end());
+
+   Timer forEachTimer;
+   for(int r = 0; r < repeats; ++r)
+      parallelForEachTet(mesh, work);
+   double forEachTime = forEachTimer.seconds() / repeats;
+
+   Timer reduceTimer;
+   double total = parallelReduceTets(mesh, ResultValue(result), Sum(), 0.0);
+   double reduceTime = reduceTimer.seconds();
+
+   printf("Per-tet loop over %d live tets, most in the first quarter of %u slots, %u threads:\n", mesh.numTets(), (unsigned int)slots, threads);
+   printf("  split on slots       : %.1f ms  (busiest block has %.2fx its share)\n", 1e3*slotTime, most * (double)perBlock.size() / mesh.numTets());
+   printf("  parallelForEachTet   : %.1f ms  (chunks of %u live tets, work stealing)\n", 1e3*forEachTime, (unsigned int)ParallelGrain);
+   printf("  parallelReduceTets   : %.1f ms  (sum %.6f, the same for any thread count)\n", 1e3*reduceTime, total);
+}
@@ -1,6 +1,13 @@
 #include "SimplicialComplex.h"
+#include "TopologyBackend.h"
+#include "IAStarBackend.h"
+#include "ParallelForEach.h"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <map>
+#include <set>
 
 using namespace SimplexMesh;
 
@@ -12,10 +19,34 @@ bool test_faceCreationValid();
 bool test_tetDuplication();
 bool test_tetCreationValid();
 bool test_vertexVertexIterator();
+bool test_incidenceMatrixRowGrowth();
+bool test_boundaryRelationsAfterCollapse();
+bool test_sortedAdjacency();
+bool test_compactComplexSnapshot();
+bool test_topologyBackendsAgree();
+bool test_compactRemapsProperties();
+bool test_reorderingsPreserveTopology();
+bool test_reserveKeepsPropertiesInStep();
+bool test_bulkBuildMatchesIncremental();
+bool test_lookupIndexMatchesScan();
+bool test_compactRebuildsUpwardRows();
+bool test_memoryReportAccountsStorage();
+bool test_soaPropertiesTrackComplex();
+bool test_sparsePropertiesDropDeleted();
+bool test_dirtyTrackingFollowsEdits();
+bool test_updatePoliciesFollowRemeshing();
+bool test_bufferedPropertiesSwap();
+bool test_compressedPropertiesRoundTrip();
+bool test_compositeIteratorsMatchSets();
+bool test_rangesMatchIterators();
+bool test_orientedGathers();
+bool test_adjacencyCachesFollowEdits();
+bool test_occupancyRankSelect();
+bool test_parallelForEachVisitsLiveOnce();
 
 typedef bool (*test_func)();
 
-const int test_count = 8;
+const int test_count = 32;
 test_func tests[] = {test_constructSimplicesFromVerts,
                      test_constructTetAndIterateSimplices,
                      test_edgeDuplication,
@@ -23,7 +54,31 @@ test_func tests[] = {test_constructSimplicesFromVerts,
                      test_faceCreationValid,
                      test_tetDuplication,
                      test_tetCreationValid,
-                     test_vertexVertexIterator};
+                     test_vertexVertexIterator,
+                     test_incidenceMatrixRowGrowth,
+                     test_boundaryRelationsAfterCollapse,
+                     test_sortedAdjacency,
+                     test_compactComplexSnapshot,
+                     test_topologyBackendsAgree,
+                     test_compactRemapsProperties,
+                     test_reorderingsPreserveTopology,
+                     test_reserveKeepsPropertiesInStep,
+                     test_bulkBuildMatchesIncremental,
+                     test_lookupIndexMatchesScan,
+                     test_compactRebuildsUpwardRows,
+                     test_memoryReportAccountsStorage,
+                     test_soaPropertiesTrackComplex,
+                     test_sparsePropertiesDropDeleted,
+                     test_dirtyTrackingFollowsEdits,
+                     test_updatePoliciesFollowRemeshing,
+                     test_bufferedPropertiesSwap,
+                     test_compressedPropertiesRoundTrip,
+                     test_compositeIteratorsMatchSets,
+                     test_rangesMatchIterators,
+                     test_orientedGathers,
+                     test_adjacencyCachesFollowEdits,
+                     test_occupancyRankSelect,
+                     test_parallelForEachVisitsLiveOnce};
 
 
 void main() {
@@ -283,4 +338,1645 @@ bool test_vertexVertexIterator() {
         return false;
     
     return true;
-}
\ No newline at end of file
+}
+
+bool test_incidenceMatrixRowGrowth() {
+   //grow many rows in an interleaved fashion, so they get relocated within the slab
+   //and compacted repeatedly, then make sure nothing was lost or scrambled.
+   //Done both without and with inline row storage.
+   for(int width = 0; width <= 4; width += 4) {
+      const int rows = 64, cols = 200;
+      IncidenceMatrix mat(rows, cols);
+      mat.setInlineWidth(width);
+
+      for(int j = 0; j < cols; ++j)
+         for(int i = 0; i < rows; ++i)
+            if((i+j) % 3 != 0 && (i < 32 || j < 6))
+               mat.set(i, j, (j % 2) ? 1 : -1);
+
+      //knock out some entries, and clear a few rows entirely
+      for(int i = 0; i < rows; ++i)
+         mat.remove(i, 10);
+      mat.zeroRow(5);
+      mat.compact();
+
+      //trim a long row back down, so it returns to inline storage
+      for(int j = 20; j < cols; ++j)
+         mat.remove(7, j);
+      mat.setInlineWidth(width + 2);
+
+      for(int i = 0; i < rows; ++i) {
+         int expected = 0;
+         for(int j = 0; j < cols; ++j) {
+            bool present = (i+j) % 3 != 0 && (i < 32 || j < 6) && j != 10 && i != 5 && (i != 7 || j < 20);
+            if(present) ++expected;
+            if(mat.exists(i, j) != present)
+               return false;
+            if(present && mat.get(i, j) != ((j % 2) ? 1 : -1))
+               return false;
+         }
+         if((int)mat.getNumEntriesInRow(i) != expected)
+            return false;
+      }
+
+      //row ordering is preserved
+      unsigned int prev = 0;
+      for(unsigned int k = 0; k < mat.getNumEntriesInRow(1); ++k) {
+         unsigned int col = mat.getColByIndex(1, k);
+         if(k > 0 && col <= prev)
+            return false;
+         prev = col;
+      }
+   }
+
+   return true;
+}
+
+bool test_boundaryRelationsAfterCollapse() {
+   //a fan of triangles around v0; collapsing a spoke edits the fixed-width boundary rows in place
+   SimplicialComplex mesh;
+
+   VertexHandle center = mesh.addVertex();
+   VertexHandle ring[5];
+   for(int i = 0; i < 5; ++i)
+      ring[i] = mesh.addVertex();
+   for(int i = 0; i < 5; ++i)
+      mesh.addFace(center, ring[i], ring[(i+1)%5]);
+
+   EdgeHandle spoke = mesh.getEdge(center, ring[0]);
+   if(mesh.getVertex(spoke, 0) != mesh.fromVertex(spoke) || mesh.getVertex(spoke, 1) != mesh.toVertex(spoke))
+      return false;
+
+   VertexHandle kept = mesh.collapseEdge(spoke, ring[0]);
+   if(kept != center || mesh.numFaces() != 3 || mesh.numEdges() != 7 || mesh.numVerts() != 5)
+      return false;
+
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) {
+      EdgeHandle eh = it.current();
+      if(!mesh.vertexExists(mesh.fromVertex(eh)) || !mesh.vertexExists(mesh.toVertex(eh)))
+         return false;
+      if(mesh.fromVertex(eh) == mesh.toVertex(eh))
+         return false;
+   }
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      FaceHandle fh = it.current();
+      for(int i = 0; i < 3; ++i)
+         if(!mesh.edgeExists(mesh.getEdge(fh, i)) || !mesh.isIncident(mesh.getEdge(fh, i), fh))
+            return false;
+   }
+
+   return true;
+}
+
+bool test_sortedAdjacency() {
+   //a high-valence hub shared by many triangles, edited with sorted upward rows
+   SimplicialComplex mesh;
+   mesh.setSafeMode(true);
+
+   const int n = 60;
+   VertexHandle hub = mesh.addVertex();
+   std::vector<VertexHandle> ring;
+   for(int i = 0; i < n; ++i)
+      ring.push_back(mesh.addVertex());
+
+   //switch on part way through, so existing rows get sorted too
+   for(int i = 0; i < n/2; ++i)
+      mesh.addFace(hub, ring[i], ring[(i+1)%n]);
+   mesh.setSortedAdjacency(true);
+   for(int i = n/2; i < n; ++i)
+      mesh.addFace(hub, ring[i], ring[(i+1)%n]);
+
+   if(mesh.vertexIncidentEdgeCount(hub) != n)
+      return false;
+
+   //duplicate detection still works
+   if(mesh.addEdge(hub, ring[7]).isValid())
+      return false;
+
+   //remove every third face and its spoke
+   for(int i = 0; i < n; i += 3) {
+      FaceHandle fh = mesh.getFace(mesh.getEdge(hub, ring[i]), mesh.getEdge(ring[i], ring[(i+1)%n]), mesh.getEdge(hub, ring[(i+1)%n]));
+      if(!fh.isValid() || !mesh.deleteFace(fh, false))
+         return false;
+   }
+   for(int i = 0; i < n; i += 3) {
+      EdgeHandle spoke = mesh.getEdge(hub, ring[i]);
+      if(mesh.edgeIncidentFaceCount(spoke) != 1)
+         return false;
+   }
+
+   int count = 0;
+   for(VertexVertexIterator vit(mesh, hub); !vit.done(); vit.advance())
+      ++count;
+   return count == n && mesh.numFaces() == n - n/3;
+}
+
+//Walk an iterator over a snapshot alongside the matching one over the complex.
+template<class Frozen, class Live>
+bool sameSimplices(Frozen fit, Live lit) {
+   for(; !lit.done(); lit.advance(), fit.advance())
+      if(fit.done() || fit.current() != lit.current())
+         return false;
+   return fit.done();
+}
+
+bool test_compactComplexSnapshot() {
+   //two tets sharing a face, plus a stray triangle that gets deleted to leave dead slots behind
+   SimplicialComplex mesh;
+
+   VertexHandle v[6];
+   for(int i = 0; i < 6; ++i)
+      v[i] = mesh.addVertex();
+   FaceHandle stray = mesh.addFace(v[0], v[4], v[5]);
+   mesh.addTet(v[0], v[1], v[2], v[3]);
+   mesh.addTet(v[1], v[2], v[3], v[4]);
+   mesh.deleteFace(stray, true);
+
+   CompactComplex frozen;
+   mesh.freeze(frozen);
+
+   if(frozen.numVerts() != mesh.numVerts() || frozen.numEdges() != mesh.numEdges() ||
+      frozen.numFaces() != mesh.numFaces() || frozen.numTets() != mesh.numTets())
+      return false;
+
+   //dense numbering maps back and forth
+   for(CompactComplex::EdgeIterator it(frozen); !it.done(); it.advance())
+      if(frozen.edgeIndex(it.current()) != it.index() || !mesh.edgeExists(it.current()))
+         return false;
+   if(frozen.vertexIndex(v[5]) != -1 || frozen.faceIndex(stray) != -1)
+      return false;
+
+   //adjacency matches the mutable structure, in the same order
+   for(VertexIterator it(mesh); !it.done(); it.advance()) {
+      CompactComplex::VertexEdgeIterator fit(frozen, it.current());
+      for(VertexEdgeIterator veit(mesh, it.current()); !veit.done(); veit.advance(), fit.advance())
+         if(fit.done() || fit.current() != veit.current())
+            return false;
+      if(!fit.done())
+         return false;
+   }
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      CompactComplex::FaceVertexIterator fit(frozen, it.current());
+      for(FaceVertexIterator fvit(mesh, it.current()); !fvit.done(); fvit.advance(), fit.advance())
+         if(fit.done() || fit.current() != fvit.current())
+            return false;
+
+      CompactComplex::FaceTetIterator ftit(frozen, it.current());
+      for(FaceTetIterator mit(mesh, it.current()); !mit.done(); mit.advance(), ftit.advance())
+         if(ftit.done() || ftit.current() != mit.current())
+            return false;
+   }
+   for(TetIterator it(mesh); !it.done(); it.advance()) {
+      CompactComplex::TetFaceIterator fit(frozen, it.current());
+      for(TetFaceIterator tfit(mesh, it.current()); !tfit.done(); tfit.advance(), fit.advance())
+         if(fit.done() || fit.current() != tfit.current() || fit.orientation() != mesh.getRelativeOrientation(it.current(), tfit.current()))
+            return false;
+   }
+
+   //...including the relations gathered across several rows
+   for(VertexIterator it(mesh); !it.done(); it.advance())
+      if(!sameSimplices(CompactComplex::VertexFaceIterator(frozen, it.current()), VertexFaceIterator(mesh, it.current())) ||
+         !sameSimplices(CompactComplex::VertexTetIterator(frozen, it.current()), VertexTetIterator(mesh, it.current())))
+         return false;
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      if(!sameSimplices(CompactComplex::EdgeTetIterator(frozen, it.current()), EdgeTetIterator(mesh, it.current())))
+         return false;
+   for(TetIterator it(mesh); !it.done(); it.advance())
+      if(!sameSimplices(CompactComplex::TetVertexIterator(frozen, it.current()), TetVertexIterator(mesh, it.current())) ||
+         !sameSimplices(CompactComplex::TetEdgeIterator(frozen, it.current()), TetEdgeIterator(mesh, it.current())))
+         return false;
+
+   //rebuilding after an edit picks up the change
+   mesh.deleteTet(TetIterator(mesh).current(), false);
+   mesh.freeze(frozen);
+   return frozen.numTets() == 1 && frozen.numFaces() == mesh.numFaces();
+}
+
+//Check every relation of every possible simplex on a set of vertices against each other.
+bool backendsMatch(const TopologyBackend& a, const TopologyBackend& b, const VertexHandle* v, int count) {
+   std::vector<Simplex> candidates;
+   for(int i = 0; i < count; ++i) {
+      candidates.push_back(Simplex(v[i]));
+      for(int j = i+1; j < count; ++j) {
+         candidates.push_back(Simplex(v[i], v[j]));
+         for(int k = j+1; k < count; ++k) {
+            candidates.push_back(Simplex(v[i], v[j], v[k]));
+            for(int l = k+1; l < count; ++l)
+               candidates.push_back(Simplex(v[i], v[j], v[k], v[l]));
+         }
+      }
+   }
+
+   for(unsigned int i = 0; i < candidates.size(); ++i) {
+      const Simplex& s = candidates[i];
+      if(a.exists(s) != b.exists(s))
+         return false;
+
+      std::vector<Simplex> ra, rb;
+      a.boundary(s, ra); b.boundary(s, rb);
+      std::sort(ra.begin(), ra.end()); std::sort(rb.begin(), rb.end());
+      if(ra != rb)
+         return false;
+
+      ra.clear(); rb.clear();
+      a.coboundary(s, ra); b.coboundary(s, rb);
+      std::sort(ra.begin(), ra.end()); std::sort(rb.begin(), rb.end());
+      if(ra != rb)
+         return false;
+   }
+   return true;
+}
+
+bool test_topologyBackendsAgree() {
+   //a mixed, non-manifold complex: two tets sharing a face, a fin triangle on one of their edges,
+   //a dangling edge, and an isolated vertex
+   IncidenceBackend reference;
+   IAStarBackend compact;
+   TopologyBackend* backends[2] = { &reference, &compact };
+
+   VertexHandle v[8];
+   for(int b = 0; b < 2; ++b) {
+      for(int i = 0; i < 8; ++i)
+         v[i] = backends[b]->addVertex();
+      if(!backends[b]->addSimplex(Simplex(v[0], v[1])) ||
+         !backends[b]->addSimplex(Simplex(v[0], v[1], v[2], v[3])) ||
+         !backends[b]->addSimplex(Simplex(v[1], v[2], v[3], v[4])) ||
+         !backends[b]->addSimplex(Simplex(v[0], v[1], v[5])) ||
+         !backends[b]->addSimplex(Simplex(v[5], v[6])))
+         return false;
+
+      //duplicates and already-implied faces are rejected
+      if(backends[b]->addSimplex(Simplex(v[3], v[2], v[1], v[0])) || backends[b]->addSimplex(Simplex(v[1], v[2], v[3])))
+         return false;
+   }
+   if(compact.numTopSimplices(3) != 2 || compact.numTopSimplices(2) != 1 || compact.numTopSimplices(1) != 1)
+      return false;
+   if(!backendsMatch(reference, compact, v, 8))
+      return false;
+
+   //deletion only succeeds for simplices with no cofaces, and leaves their faces behind
+   for(int b = 0; b < 2; ++b) {
+      if(backends[b]->deleteSimplex(Simplex(v[1], v[2], v[3])) || backends[b]->deleteSimplex(Simplex(v[5])))
+         return false;
+      if(!backends[b]->deleteSimplex(Simplex(v[1], v[2], v[3], v[4])) || !backends[b]->deleteSimplex(Simplex(v[7])))
+         return false;
+   }
+   if(!backendsMatch(reference, compact, v, 7))
+      return false;
+
+   for(int b = 0; b < 2; ++b)
+      if(!backends[b]->deleteSimplex(Simplex(v[1], v[3], v[4])) || !backends[b]->deleteSimplex(Simplex(v[1], v[2], v[4])) ||
+         !backends[b]->deleteSimplex(Simplex(v[1], v[4])) || backends[b]->deleteSimplex(Simplex(v[3], v[4])))
+         return false;
+   return backendsMatch(reference, compact, v, 7);
+}
+
+bool test_compactRemapsProperties() {
+   //a strip of tets, with every other one deleted (along with any faces, edges and vertices they alone used)
+   SimplicialComplex mesh;
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 12; ++i)
+      verts.push_back(mesh.addVertex());
+   std::vector<TetHandle> tets;
+   for(int i = 0; i + 3 < 12; ++i)
+      tets.push_back(mesh.addTet(verts[i], verts[i+1], verts[i+2], verts[i+3]));
+
+   //tag everything with its current slot, and remember the incidence structure
+   VertexProperty<int> vtag(mesh);
+   EdgeProperty<int> etag(mesh);
+   FaceProperty<int> ftag(mesh);
+   TetProperty<int> ttag(mesh);
+   int count = 0;
+   for(VertexIterator it(mesh); !it.done(); it.advance()) vtag[it.current()] = count++;
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) etag[it.current()] = count++;
+   for(FaceIterator it(mesh); !it.done(); it.advance()) ftag[it.current()] = count++;
+   for(TetIterator it(mesh); !it.done(); it.advance()) ttag[it.current()] = count++;
+
+   for(unsigned int i = 1; i < tets.size(); i += 2) {
+      TetFaceIterator tfit(mesh, tets[i]);
+      std::vector<FaceHandle> faces;
+      for(; !tfit.done(); tfit.advance()) faces.push_back(tfit.current());
+      mesh.deleteTet(tets[i], false);
+      for(unsigned int f = 0; f < faces.size(); ++f)
+         mesh.deleteFace(faces[f], false);
+   }
+   mesh.deleteVertex(mesh.addVertex());
+
+   //record each surviving tet's faces (tag and orientation), in order
+   std::vector<int> before;
+   for(TetIterator it(mesh); !it.done(); it.advance())
+      for(TetFaceIterator tfit(mesh, it.current()); !tfit.done(); tfit.advance()) {
+         before.push_back(ftag[tfit.current()]);
+         before.push_back(mesh.getRelativeOrientation(it.current(), tfit.current()));
+      }
+   int nv = mesh.numVerts(), ne = mesh.numEdges(), nf = mesh.numFaces(), nt = mesh.numTets();
+   VertexHandle survivor = verts[5];
+   int survivorTag = vtag[survivor];
+
+   SimplexRemap remap = mesh.compact();
+
+   if(mesh.numVerts() != nv || mesh.numEdges() != ne || mesh.numFaces() != nf || mesh.numTets() != nt)
+      return false;
+   if((int)remap.verts.size() != 13 || remap.tets[1] != -1 || remap(tets[1]).isValid() || vtag[remap(survivor)] != survivorTag)
+      return false;
+
+   //live slots are numbered densely, in their original order
+   for(unsigned int i = 0, next = 0; i < remap.faces.size(); ++i)
+      if(remap.faces[i] >= 0 && remap.faces[i] != (int)next++)
+         return false;
+
+   //the same tets come out of the iterators in the same order, with the same faces and orientations
+   std::vector<int> after;
+   int index = 0;
+   for(TetIterator it(mesh); !it.done(); it.advance(), ++index) {
+      for(TetFaceIterator tfit(mesh, it.current()); !tfit.done(); tfit.advance()) {
+         after.push_back(ftag[tfit.current()]);
+         after.push_back(mesh.getRelativeOrientation(it.current(), tfit.current()));
+      }
+   }
+   if(before != after || index != nt)
+      return false;
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      for(EdgeFaceIterator efit(mesh, it.current()); !efit.done(); efit.advance())
+         if(!mesh.isIncident(it.current(), efit.current()))
+            return false;
+
+   //the complex stays editable, and new simplices go at the end
+   VertexHandle extra = mesh.addVertex();
+   if(remap(extra).isValid() || !mesh.addEdge(extra, remap(survivor)).isValid())
+      return false;
+   return mesh.compact().verts.size() == (unsigned int)nv + 1;
+}
+
+struct Point {
+   double x[3];
+   double operator[](int i) const { return x[i]; }
+};
+
+//Every simplex's boundary, in order and with orientations, in terms of tags that travel with the simplices.
+std::map<int, std::vector<int> > boundaryFingerprint(SimplicialComplex& mesh, VertexProperty<int>& vtag,
+   EdgeProperty<int>& etag, FaceProperty<int>& ftag, TetProperty<int>& ttag)
+{
+   std::map<int, std::vector<int> > result;
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) {
+      std::vector<int>& row = result[etag[it.current()]];
+      row.push_back(vtag[mesh.fromVertex(it.current())]);
+      row.push_back(vtag[mesh.toVertex(it.current())]);
+   }
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      std::vector<int>& row = result[ftag[it.current()]];
+      for(FaceEdgeIterator feit(mesh, it.current()); !feit.done(); feit.advance())
+         row.push_back(etag[feit.current()] * mesh.getRelativeOrientation(it.current(), feit.current()));
+   }
+   for(TetIterator it(mesh); !it.done(); it.advance()) {
+      std::vector<int>& row = result[ttag[it.current()]];
+      for(TetFaceIterator tfit(mesh, it.current()); !tfit.done(); tfit.advance())
+         row.push_back(ftag[tfit.current()] * mesh.getRelativeOrientation(it.current(), tfit.current()));
+   }
+   return result;
+}
+
+//Largest difference in position (slot order) between the two ends of an edge.
+int vertexBandwidth(SimplicialComplex& mesh) {
+   VertexProperty<int> slot(mesh);
+   int count = 0;
+   for(VertexIterator it(mesh); !it.done(); it.advance())
+      slot[it.current()] = count++;
+   int bandwidth = 0;
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      bandwidth = std::max(bandwidth, std::abs(slot[mesh.fromVertex(it.current())] - slot[mesh.toVertex(it.current())]));
+   return bandwidth;
+}
+
+bool test_reorderingsPreserveTopology() {
+   //a 4x4x4 block of cubes, 6 tets each, created in scrambled order
+   const int n = 4, m = n+1;
+   SimplicialComplex mesh;
+   VertexProperty<Point> pos(mesh);
+   std::vector<int> shuffle(m*m*m);
+   for(int i = 0; i < m*m*m; ++i) shuffle[i] = (i*37) % (m*m*m);
+   std::vector<VertexHandle> verts(m*m*m);
+   for(int i = 0; i < m*m*m; ++i) {
+      int id = shuffle[i];
+      verts[id] = mesh.addVertex();
+      Point p = { { double(id / (m*m)), double((id / m) % m), double(id % m) } };
+      pos[verts[id]] = p;
+   }
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { m*m, m, 1 };
+   for(int c = 0; c < n*n*n; ++c) {
+      int cube = (c*29) % (n*n*n);
+      int corner = (cube / (n*n))*m*m + ((cube / n) % n)*m + cube % n;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         mesh.addTet(verts[corner], verts[v1], verts[v2], verts[v3]);
+      }
+   }
+
+   VertexProperty<int> vtag(mesh);
+   EdgeProperty<int> etag(mesh);
+   FaceProperty<int> ftag(mesh);
+   TetProperty<int> ttag(mesh);
+   int count = 1;
+   for(VertexIterator it(mesh); !it.done(); it.advance()) vtag[it.current()] = count++;
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) etag[it.current()] = count++;
+   for(FaceIterator it(mesh); !it.done(); it.advance()) ftag[it.current()] = count++;
+   for(TetIterator it(mesh); !it.done(); it.advance()) ttag[it.current()] = count++;
+
+   std::map<int, std::vector<int> > original = boundaryFingerprint(mesh, vtag, etag, ftag, ttag);
+   int nv = mesh.numVerts(), ne = mesh.numEdges(), nf = mesh.numFaces(), nt = mesh.numTets();
+   int scrambledBandwidth = vertexBandwidth(mesh);
+
+   for(int pass = 0; pass < 3; ++pass) {
+      VertexHandle probe = verts[7];
+      Point probePos = pos[probe];
+
+      SimplexRemap remap;
+      if(pass == 0) remap = mesh.reorderHilbert(pos);
+      else if(pass == 1) remap = mesh.reorderRCM();
+      else remap = mesh.reorderTetBFS();
+
+      if(mesh.numVerts() != nv || mesh.numEdges() != ne || mesh.numFaces() != nf || mesh.numTets() != nt)
+         return false;
+      if(boundaryFingerprint(mesh, vtag, etag, ftag, ttag) != original)
+         return false;
+      if(pos[remap(probe)][0] != probePos[0] || pos[remap(probe)][2] != probePos[2])
+         return false;
+      for(int i = 0; i < m*m*m; ++i)
+         verts[i] = remap(verts[i]);
+
+      if(pass == 1 && vertexBandwidth(mesh) >= scrambledBandwidth)
+         return false;
+   }
+   return true;
+}
+
+bool test_reserveKeepsPropertiesInStep() {
+   SimplicialComplex mesh;
+   VertexProperty<int> early(mesh);
+
+   //grow well past a reservation, with values written as we go
+   mesh.reserveVertices(10);
+   mesh.reserveEdges(10);
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 100; ++i) {
+      verts.push_back(mesh.addVertex());
+      early[verts.back()] = i;
+   }
+
+   //properties registered later match the current capacity, and both keep up with further growth
+   VertexProperty<int> late(mesh);
+   EdgeProperty<int> edgeTag(mesh);
+   for(int i = 0; i < 100; ++i)
+      late[verts[i]] = -i;
+   for(int i = 0; i < 1000; ++i) {
+      VertexHandle vh = mesh.addVertex();
+      early[vh] = late[vh] = 100+i;
+      EdgeHandle eh = mesh.addEdge(vh, verts[i % 100]);
+      edgeTag[eh] = i;
+   }
+   for(int i = 0; i < 100; ++i)
+      if(early[verts[i]] != i || late[verts[i]] != -i)
+         return false;
+
+   int count = 0;
+   for(EdgeIterator it(mesh); !it.done(); it.advance(), ++count)
+      if(edgeTag[it.current()] != count)
+         return false;
+   return count == 1000 && mesh.numVerts() == 1100;
+}
+
+//Same adjacent simplices, in the same order, for h in both complexes
+template<class Iter, class Handle>
+bool sameAdjacency(const SimplicialComplex& a, const SimplicialComplex& b, const Handle& h) {
+   Iter ia(a, h), ib(b, h);
+   for(; !ia.done() && !ib.done(); ia.advance(), ib.advance())
+      if(ia.current() != ib.current() || a.getRelativeOrientation(h, ia.current()) != b.getRelativeOrientation(h, ib.current()))
+         return false;
+   return ia.done() && ib.done();
+}
+
+template<class Iter, class Handle>
+bool sameCoadjacency(const SimplicialComplex& a, const SimplicialComplex& b, const Handle& h) {
+   Iter ia(a, h), ib(b, h);
+   for(; !ia.done() && !ib.done(); ia.advance(), ib.advance())
+      if(ia.current() != ib.current())
+         return false;
+   return ia.done() && ib.done();
+}
+
+bool identicalComplexes(const SimplicialComplex& a, const SimplicialComplex& b) {
+   if(a.numVerts() != b.numVerts() || a.numEdges() != b.numEdges() || a.numFaces() != b.numFaces() || a.numTets() != b.numTets())
+      return false;
+   for(VertexIterator it(a); !it.done(); it.advance())
+      if(!sameCoadjacency<VertexEdgeIterator>(a, b, it.current())) return false;
+   for(EdgeIterator it(a); !it.done(); it.advance())
+      if(!sameAdjacency<EdgeVertexIterator>(a, b, it.current()) || !sameCoadjacency<EdgeFaceIterator>(a, b, it.current())) return false;
+   for(FaceIterator it(a); !it.done(); it.advance())
+      if(!sameAdjacency<FaceEdgeIterator>(a, b, it.current()) || !sameCoadjacency<FaceTetIterator>(a, b, it.current())) return false;
+   for(TetIterator it(a); !it.done(); it.advance())
+      if(!sameAdjacency<TetFaceIterator>(a, b, it.current())) return false;
+   return true;
+}
+
+bool test_bulkBuildMatchesIncremental() {
+   //a cube split into six tets around its diagonal, listed with assorted vertex orders
+   const int tets[6*4] = { 0,1,3,7,  5,1,0,7,  0,4,5,7,  7,6,4,0,  2,0,3,7,  0,2,6,7 };
+   //dangling pieces attached to it: a repeated segment, one reversed onto a tet edge, and a triangle
+   //that is also a (reordered) tet face
+   const int tris[3*3] = { 1,8,9,  3,1,0,  9,8,10 };
+   const int segs[3*2] = { 10,11,  11,10,  7,0 };
+
+   SimplicialComplex incremental;
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 12; ++i)
+      verts.push_back(incremental.addVertex());
+   for(int i = 0; i < 3; ++i)
+      if(!incremental.getEdge(verts[segs[2*i]], verts[segs[2*i+1]]).isValid())
+         incremental.addEdge(verts[segs[2*i]], verts[segs[2*i+1]]);
+   for(int i = 0; i < 3; ++i)
+      incremental.addFace(verts[tris[3*i]], verts[tris[3*i+1]], verts[tris[3*i+2]]);
+   for(int i = 0; i < 6; ++i)
+      incremental.addTet(verts[tets[4*i]], verts[tets[4*i+1]], verts[tets[4*i+2]], verts[tets[4*i+3]]);
+
+   SimplicialComplex bulk;
+   if(!bulk.buildFromSimplices(tets, 6, tris, 3, segs, 3) || !identicalComplexes(incremental, bulk))
+      return false;
+
+   //a pure tet soup
+   SimplicialComplex incrementalTets, bulkTets;
+   for(int i = 0; i < 8; ++i)
+      incrementalTets.addVertex();
+   for(int i = 0; i < 6; ++i)
+      incrementalTets.addTet(verts[tets[4*i]], verts[tets[4*i+1]], verts[tets[4*i+2]], verts[tets[4*i+3]]);
+   if(!bulkTets.buildFromTets(tets, 6) || !identicalComplexes(incrementalTets, bulkTets))
+      return false;
+
+   //only an empty complex can be built into, and bad input is refused
+   const int repeated[4] = { 0,1,1,2 };
+   const int negative[2] = { 0,-1 };
+   SimplicialComplex empty;
+   return !bulkTets.buildFromTets(tets, 6) && !empty.buildFromTets(repeated, 1) && !empty.buildFromSegments(negative, 1);
+}
+
+//getEdge/getFace/getTet answer the same on both complexes (built by identical operations), for every existing
+//simplex and for assorted missing ones
+bool sameLookups(const SimplicialComplex& indexed, const SimplicialComplex& scanned) {
+   std::vector<VertexHandle> verts;
+   for(VertexIterator it(scanned); !it.done(); it.advance())
+      verts.push_back(it.current());
+   for(unsigned int a = 0; a < verts.size(); ++a)
+      for(unsigned int b = a+1; b < verts.size(); ++b)
+         if(indexed.getEdge(verts[a], verts[b]) != scanned.getEdge(verts[a], verts[b]) ||
+            indexed.getEdge(verts[b], verts[a]) != scanned.getEdge(verts[a], verts[b]))
+            return false;
+
+   std::vector<EdgeHandle> edges;
+   for(EdgeIterator it(scanned); !it.done(); it.advance())
+      edges.push_back(it.current());
+   for(unsigned int a = 0; a < edges.size(); ++a)
+      for(unsigned int b = a+1; b < edges.size(); ++b)
+         for(unsigned int c = b+1; c < edges.size(); ++c)
+            if(indexed.getFace(edges[c], edges[a], edges[b]) != scanned.getFace(edges[c], edges[a], edges[b]))
+               return false;
+
+   for(TetIterator it(scanned); !it.done(); it.advance()) {
+      TetHandle th = it.current();
+      FaceHandle f[4] = { scanned.getFace(th, 0), scanned.getFace(th, 1), scanned.getFace(th, 2), scanned.getFace(th, 3) };
+      if(indexed.getTet(f[2], f[0], f[3], f[1]) != th)
+         return false;
+      for(FaceIterator other(scanned); !other.done(); other.advance())
+         if(indexed.getTet(f[0], f[1], f[2], other.current()) != scanned.getTet(f[0], f[1], f[2], other.current()))
+            return false;
+   }
+   return true;
+}
+
+bool test_lookupIndexMatchesScan() {
+   //the same sequence of edits, with and without the index
+   SimplicialComplex meshes[2];
+   meshes[0].setLookupIndex(true);
+   for(int m = 0; m < 2; ++m) {
+      SimplicialComplex& mesh = meshes[m];
+      mesh.setSafeMode(true);
+
+      //a 4x4 sheet of triangles, and two tets sharing a face off to the side
+      std::vector<VertexHandle> verts;
+      for(int i = 0; i < 21; ++i)
+         verts.push_back(mesh.addVertex());
+      for(int i = 0; i < 3; ++i) for(int j = 0; j < 3; ++j) {
+         int v = 4*i + j;
+         mesh.addFace(verts[v], verts[v+1], verts[v+5]);
+         mesh.addFace(verts[v], verts[v+5], verts[v+4]);
+      }
+      TetHandle t0 = mesh.addTet(verts[16], verts[17], verts[18], verts[19]);
+      TetHandle t1 = mesh.addTet(verts[17], verts[18], verts[19], verts[20]);
+      if(!t0.isValid() || !t1.isValid())
+         return false;
+
+      //duplicates are refused in safe mode
+      FaceHandle tf[4] = { mesh.getFace(t0, 0), mesh.getFace(t0, 1), mesh.getFace(t0, 2), mesh.getFace(t0, 3) };
+      EdgeHandle fe[3] = { mesh.getEdge(tf[0], 0), mesh.getEdge(tf[0], 1), mesh.getEdge(tf[0], 2) };
+      if(mesh.addEdge(verts[1], verts[0]).isValid() || mesh.addFace(fe[1], fe[2], fe[0]).isValid() ||
+         mesh.addTet(tf[1], tf[0], tf[2], tf[3]).isValid())
+         return false;
+   }
+   if(!sameLookups(meshes[0], meshes[1]))
+      return false;
+
+   for(int m = 0; m < 2; ++m) {
+      SimplicialComplex& mesh = meshes[m];
+      std::vector<VertexHandle> verts;
+      for(VertexIterator it(mesh); !it.done(); it.advance())
+         verts.push_back(it.current());
+      std::vector<FaceHandle> newFaces;
+      mesh.splitEdge(mesh.getEdge(verts[5], verts[10]), newFaces);
+      mesh.flipEdge(mesh.getEdge(verts[6], verts[11]));
+      mesh.collapseEdge(mesh.getEdge(verts[1], verts[5]), verts[1]);
+      mesh.deleteTet(TetIterator(mesh).current(), true);
+   }
+   if(!sameLookups(meshes[0], meshes[1]))
+      return false;
+
+   meshes[0].compact();
+   meshes[1].compact();
+   return sameLookups(meshes[0], meshes[1]) && meshes[0].numTets() == 1 && meshes[0].numFaces() == meshes[1].numFaces();
+}
+
+bool test_compactRebuildsUpwardRows() {
+   //churn a block of tets so slots get reused out of order, then compact
+   SimplicialComplex mesh;
+   mesh.setSortedAdjacency(true);
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 27; ++i)
+      verts.push_back(mesh.addVertex());
+   const int perms[6][3] = { {0,1,2}, {0,2,1}, {1,0,2}, {1,2,0}, {2,0,1}, {2,1,0} };
+   const int step[3] = { 9, 3, 1 };
+   std::vector<TetHandle> tets;
+   for(int corner = 0; corner < 27; ++corner) {
+      if(corner % 3 == 2 || (corner / 3) % 3 == 2 || corner / 9 == 2) continue;
+      for(int p = 0; p < 6; ++p) {
+         int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+         tets.push_back(mesh.addTet(verts[corner], verts[v1], verts[v2], verts[v3]));
+      }
+   }
+   for(unsigned int i = 0; i < tets.size(); i += 3)
+      mesh.deleteTet(tets[i], true);
+   for(unsigned int i = 0; i < tets.size(); i += 3) {
+      int c = i / 6, corner = (c/4)*9 + ((c/2)%2)*3 + c%2, p = i % 6;
+      int v1 = corner + step[perms[p][0]], v2 = v1 + step[perms[p][1]], v3 = v2 + step[perms[p][2]];
+      mesh.addTet(verts[v3], verts[v2], verts[v1], verts[corner]);
+   }
+   mesh.compact();
+
+   //every upward row holds exactly the simplices that refer back to it, in increasing order, with matching signs
+   for(EdgeIterator it(mesh); !it.done(); it.advance()) {
+      EdgeHandle eh = it.current();
+      for(EdgeVertexIterator ev(mesh, eh); !ev.done(); ev.advance())
+         if(!mesh.isIncident(ev.current(), eh)) return false;
+   }
+   int references = 0;
+   for(VertexIterator it(mesh); !it.done(); it.advance()) {
+      EdgeHandle prev = EdgeHandle::invalid();
+      for(VertexEdgeIterator ve(mesh, it.current()); !ve.done(); ve.advance(), ++references) {
+         EdgeHandle eh = ve.current();
+         if((prev.isValid() && !(prev < eh)) || (mesh.fromVertex(eh) != it.current() && mesh.toVertex(eh) != it.current()))
+            return false;
+         prev = eh;
+      }
+   }
+   if(references != 2*mesh.numEdges())
+      return false;
+   references = 0;
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      TetHandle prev = TetHandle::invalid();
+      for(FaceTetIterator ft(mesh, it.current()); !ft.done(); ft.advance(), ++references) {
+         if((prev.isValid() && !(prev < ft.current())) || !mesh.isIncident(it.current(), ft.current()))
+            return false;
+         prev = ft.current();
+      }
+      if(mesh.faceIncidentTetCount(it.current()) == 2 && mesh.frontTet(it.current()) == mesh.backTet(it.current()))
+         return false;
+   }
+   return references == 4*mesh.numTets() && mesh.numTets() == (int)tets.size();
+}
+
+bool test_memoryReportAccountsStorage() {
+   SimplicialComplex mesh;
+   VertexProperty<double> weight(mesh);
+   TetProperty<int> label(mesh);
+
+   //a fan of tets around a hub edge, with a couple deleted
+   VertexHandle a = mesh.addVertex(), b = mesh.addVertex();
+   std::vector<VertexHandle> ring;
+   for(int i = 0; i < 10; ++i)
+      ring.push_back(mesh.addVertex());
+   std::vector<TetHandle> tets;
+   for(int i = 0; i < 10; ++i)
+      tets.push_back(mesh.addTet(a, b, ring[i], ring[(i+1)%10]));
+   mesh.deleteTet(tets[3], false);
+   mesh.deleteTet(tets[7], false);
+
+   MemoryReport report;
+   mesh.memoryReport(report);
+   if(report.matrices.size() != 7 || report.properties.size() != 2 || report.deadPools.size() != 4 || !report.indices.empty())
+      return false;
+   if(report.liveSlots[3] != 8 || report.deadSlots[3] != 2 || report.liveSlots[0] != 12 || report.deadSlots[0] != 0)
+      return false;
+   if(report.properties[0].used != 12*sizeof(double) || report.properties[1].used != 10*sizeof(int))
+      return false;
+   if(report.deadPools[3].used != 2*sizeof(unsigned int) || !report.rowLengths[0].empty())
+      return false;
+   for(unsigned int i = 0; i < report.matrices.size(); ++i)
+      if(report.matrices[i].used > report.matrices[i].reserved || report.matrices[i].used == 0)
+         return false;
+
+   //histograms cover every row, and see the hub edge in all 10 faces around it
+   mesh.setLookupIndex(true);
+   mesh.memoryReport(report, true);
+   if(report.indices.size() != 3 || report.rowLengths[1].size() != 11 || report.rowLengths[1][10] != 1)
+      return false;
+   unsigned int rows[3] = { 0, 0, 0 };
+   for(int d = 0; d < 3; ++d)
+      for(unsigned int k = 0; k < report.rowLengths[d].size(); ++k)
+         rows[d] += report.rowLengths[d][k];
+   return rows[0] == 12 && rows[1] == report.liveSlots[1] + report.deadSlots[1] && rows[2] == report.liveSlots[2] + report.deadSlots[2] &&
+      report.totalUsed() <= report.totalReserved();
+}
+
+bool test_soaPropertiesTrackComplex() {
+   SimplicialComplex mesh;
+   VertexPropertySoA<float,3> position(mesh);
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 100; ++i) {
+      verts.push_back(mesh.addVertex());
+      for(unsigned int c = 0; c < 3; ++c)
+         position(verts.back(), c) = float(10*i + c);
+   }
+   TetPropertySoA<double,2> tetData(mesh);
+   TetHandle th = mesh.addTet(verts[0], verts[1], verts[2], verts[3]);
+   tetData(th, 1) = 0.5;
+
+   //components stay aligned and in step with the complex as it grows
+   for(unsigned int c = 0; c < 3; ++c)
+      if(reinterpret_cast<size_t>(position.component(c)) % 64 != 0 || position.slots() != 100)
+         return false;
+   for(int i = 0; i < 100; ++i)
+      if(position.component(1)[i] != float(10*i + 1))
+         return false;
+
+   //a kernel over whole component arrays
+   VertexPropertySoA<float,3> velocity(mesh);
+   velocity.assign(2.0f);
+   for(unsigned int c = 0; c < 3; ++c) {
+      float* x = position.component(c);
+      const float* v = velocity.component(c);
+      for(size_t i = 0; i < position.slots(); ++i)
+         x[i] += 0.5f*v[i];
+   }
+   if(position(verts[7], 2) != 73.0f)
+      return false;
+
+   //renumbering carries the components along
+   mesh.deleteVertex(verts[50]);
+   SimplexRemap remap = mesh.compact();
+   if(position.slots() != 99 || position(remap(verts[51]), 0) != 511.0f || tetData(remap(th), 1) != 0.5)
+      return false;
+
+   MemoryReport report;
+   mesh.memoryReport(report);
+   return report.properties.size() == 3 && report.properties[0].used == 3*99*sizeof(float);
+}
+
+bool test_sparsePropertiesDropDeleted() {
+   SimplicialComplex mesh;
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 1000; ++i)
+      verts.push_back(mesh.addVertex());
+
+   //enough entries to grow and shuffle the table
+   VertexPropertySparse<int> tag(mesh);
+   for(int i = 0; i < 1000; ++i)
+      tag[verts[i]] = i;
+   for(int i = 0; i < 1000; i += 2)
+      if(!tag.erase(verts[i]))
+         return false;
+   if(tag.count() != 500 || tag.erase(verts[0]))
+      return false;
+   for(int i = 0; i < 1000; ++i) {
+      const int* value = tag.find(verts[i]);
+      if((i % 2 == 0) != (value == 0) || (value && *value != i))
+         return false;
+   }
+   long sum = 0;
+   for(size_t k = 0; k < tag.count(); ++k)
+      sum += tag.valueAt(k) - (tag.handleAt(k) == verts[tag.valueAt(k)] ? 0 : 1000000);
+   if(sum != 250000)
+      return false;
+
+   //two tets sharing a face, with a flag on every face of the first
+   TetHandle t0 = mesh.addTet(verts[1], verts[3], verts[5], verts[7]);
+   TetHandle t1 = mesh.addTet(verts[1], verts[3], verts[5], verts[9]);
+   FacePropertySparse<bool> marked(mesh);
+   TetPropertySparse<double> weight(mesh);
+   std::vector<FaceHandle> faces;
+   for(TetFaceIterator tfit(mesh, t0); !tfit.done(); tfit.advance()) {
+      faces.push_back(tfit.current());
+      marked[tfit.current()] = true;
+   }
+   weight[t0] = 1.5;
+   weight[t1] = 2.5;
+
+   //deleting drops the entries of every simplex that goes (including verts[7], orphaned by the recursion), and only those
+   mesh.deleteTet(t0, true);
+   int survivors = 0;
+   for(unsigned int i = 0; i < faces.size(); ++i)
+      if(mesh.faceExists(faces[i]) != marked.contains(faces[i]))
+         return false;
+      else if(mesh.faceExists(faces[i]))
+         ++survivors;
+   if(survivors != 1 || marked.count() != 1 || weight.count() != 1 || weight.contains(t0) || tag.contains(verts[7]) || !mesh.vertexExists(verts[1]))
+      return false;
+
+   //a new simplex in a recycled slot starts without an entry
+   TetHandle t2 = mesh.addTet(verts[3], verts[5], verts[9], verts[11]);
+   if(weight.contains(t2) || weight.count() != 1)
+      return false;
+
+   //renumbering carries entries along
+   SimplexRemap remap = mesh.compact();
+   const double* w = weight.find(remap(t1));
+   if(!w || *w != 2.5 || !tag.contains(remap(verts[999])) || tag.count() != 499)
+      return false;
+   FacePropertySparse<bool> copy(marked);
+   return copy.count() == 1 && copy.contains(marked.handleAt(0));
+}
+
+bool test_dirtyTrackingFollowsEdits() {
+   //a fan of triangles around center
+   SimplicialComplex mesh;
+   VertexProperty<double> height(mesh);
+   FaceProperty<double> area(mesh);
+   height.trackDirty(true);
+   area.trackDirty(true);
+
+   VertexHandle center = mesh.addVertex();
+   VertexHandle ring[6];
+   for(int i = 0; i < 6; ++i)
+      ring[i] = mesh.addVertex();
+   for(int i = 0; i < 6; ++i)
+      mesh.addFace(center, ring[i], ring[(i+1)%6]);
+   if(height.numDirty() != 7 || area.numDirty() != 6)
+      return false;
+   height.clearDirty();
+   area.clearDirty();
+
+   //writes flag their slot, reads through a const reference don't
+   height[ring[3]] = 1.0;
+   const VertexProperty<double>& constHeight = height;
+   double sum = constHeight[ring[1]] + constHeight[ring[2]];
+   if(sum != 0 || height.firstDirty() != ring[3] || height.nextDirty(ring[3]).isValid() || height.isDirty(ring[1]))
+      return false;
+   height.touch(center);
+   if(height.numDirty() != 2 || height.firstDirty() != center)
+      return false;
+   height.clearDirty();
+
+   //splitting flags the new vertex and every face created or deleted
+   std::vector<FaceHandle> newFaces;
+   EdgeHandle spoke = mesh.getEdge(center, ring[0]);
+   std::vector<FaceHandle> oldFaces;
+   for(EdgeFaceIterator efit(mesh, spoke); !efit.done(); efit.advance())
+      oldFaces.push_back(efit.current());
+   VertexHandle mid = mesh.splitEdge(spoke, newFaces);
+   if(height.numDirty() != 1 || !height.isDirty(mid) || area.numDirty() != 6)
+      return false;
+   for(unsigned int i = 0; i < newFaces.size(); ++i)
+      if(!area.isDirty(newFaces[i]))
+         return false;
+   for(unsigned int i = 0; i < oldFaces.size(); ++i)
+      if(!area.isDirty(oldFaces[i]) || mesh.faceExists(oldFaces[i]))
+         return false;
+   height.clearDirty();
+   area.clearDirty();
+
+   //collapsing flags the kept vertex and the faces reconnected to it
+   VertexHandle kept = mesh.collapseEdge(mesh.getEdge(center, ring[3]), ring[3]);
+   if(kept != center || !height.isDirty(center) || !height.isDirty(ring[3]))
+      return false;
+   int reconnected = 0;
+   for(FaceIterator it(mesh); !it.done(); it.advance()) {
+      bool usesRemoved = false;
+      for(FaceVertexIterator fvit(mesh, it.current()); !fvit.done(); fvit.advance())
+         usesRemoved |= fvit.current() == center;
+      if(usesRemoved && area.isDirty(it.current()))
+         ++reconnected;
+   }
+   if(reconnected < 2)
+      return false;
+
+   //flags survive renumbering, and go away with tracking
+   area.clearDirty();
+   area.touch(newFaces[0]);
+   SimplexRemap remap = mesh.compact();
+   if(area.numDirty() != 1 || area.firstDirty() != remap(newFaces[0]))
+      return false;
+   FaceProperty<double> areaCopy(area);
+   if(!areaCopy.tracksDirty() || areaCopy.numDirty() != 1 || areaCopy.firstDirty() != remap(newFaces[0]))
+      return false;
+   area.trackDirty(false);
+   area[remap(newFaces[0])] = 2.0;
+   return area.numDirty() == 0 && !area.firstDirty().isValid();
+}
+
+FaceHandle faceOf(const SimplicialComplex& mesh, const VertexHandle& a, const VertexHandle& b, const VertexHandle& c) {
+   return mesh.getFace(mesh.getEdge(a, b), mesh.getEdge(b, c), mesh.getEdge(c, a));
+}
+
+//A custom policy: pieces keep their parent's tally, merges add up, and in-between simplices take the larger one.
+class TallyUpdate : public PropertyUpdate<int> {
+public:
+   PropertyUpdate<int>* clone() const { return new TallyUpdate(*this); }
+   void derive(int& child, const int& parent) const { child = parent; }
+   void interpolate(int& target, const int& a, const int& b) const { target = std::max(a, b); }
+   void merge(int& target, const int& other) const { target += other; }
+};
+
+bool test_updatePoliciesFollowRemeshing() {
+   //a fan of triangles around center, with a field, a weight and labels
+   SimplicialComplex mesh;
+   VertexProperty<double> height(mesh);
+   VertexProperty<int> weight(mesh);
+   EdgeProperty<int> crease(mesh);
+   FaceProperty<int> material(mesh);
+   FaceProperty<int> region(mesh);
+   height.setUpdatePolicy(MidpointUpdate<double>());
+   weight.setUpdatePolicy(SumUpdate<int>());
+   crease.setUpdatePolicy(TallyUpdate());
+   material.setUpdatePolicy(CopyUpdate<int>());
+
+   VertexHandle center = mesh.addVertex();
+   height[center] = 0;
+   weight[center] = 1;
+   VertexHandle ring[6];
+   for(int i = 0; i < 6; ++i) {
+      ring[i] = mesh.addVertex();
+      height[ring[i]] = i+1;
+      weight[ring[i]] = 1;
+   }
+   for(int i = 0; i < 6; ++i) {
+      FaceHandle fh = mesh.addFace(center, ring[i], ring[(i+1)%6]);
+      material[fh] = 10+i;
+      region[fh] = -1;
+   }
+   for(EdgeIterator it(mesh); !it.done(); it.advance())
+      crease[it.current()] = 0;
+   EdgeHandle spoke = mesh.getEdge(center, ring[3]);
+   crease[spoke] = 7;
+   crease[mesh.getEdge(ring[2], ring[3])] = 4;
+
+   //split: midpoint field, halves and sub-faces inherit from their parents
+   std::vector<FaceHandle> newFaces;
+   VertexHandle mid = mesh.splitEdge(spoke, newFaces);
+   if(height[mid] != 2.0 || weight[mid] != 1)
+      return false;
+   if(crease[mesh.getEdge(center, mid)] != 7 || crease[mesh.getEdge(mid, ring[3])] != 7)
+      return false;
+   if(crease[mesh.getEdge(mid, ring[2])] != 4 || crease[mesh.getEdge(mid, ring[4])] != 0)
+      return false;
+   for(unsigned int i = 0; i < newFaces.size(); ++i) {
+      bool inFirst = faceOf(mesh, center, mid, ring[2]) == newFaces[i] || faceOf(mesh, mid, ring[2], ring[3]) == newFaces[i];
+      if(material[newFaces[i]] != (inFirst ? 12 : 13))
+         return false;
+   }
+
+   //flip: the new diagonal comes from the old one, both new faces from the two old ones (CopyUpdate takes the first)
+   crease[mesh.getEdge(center, ring[1])] = 3;
+   EdgeHandle flipped = mesh.flipEdge(mesh.getEdge(center, ring[1]));
+   if(!flipped.isValid() || crease[flipped] != 3)
+      return false;
+   std::vector<int> flippedMaterials;
+   for(EdgeFaceIterator efit(mesh, flipped); !efit.done(); efit.advance())
+      flippedMaterials.push_back(material[efit.current()]);
+   if(flippedMaterials.size() != 2 || flippedMaterials[0] != flippedMaterials[1] || (flippedMaterials[0] != 10 && flippedMaterials[0] != 11))
+      return false;
+
+   //collapse: weights add up, the field averages, the custom policy merges the coinciding edges
+   crease[mesh.getEdge(center, ring[2])] = 2;
+   crease[mesh.getEdge(mid, ring[2])] = 5;
+   VertexHandle kept = mesh.collapseEdge(mesh.getEdge(center, mid), mid);
+   EdgeHandle merged = mesh.getEdge(center, ring[2]);
+   if(kept != center || weight[center] != 2 || height[center] != 1.0 || !merged.isValid() || crease[merged] != 7)
+      return false;
+   if(crease[mesh.getEdge(center, ring[3])] != 7)
+      return false;
+
+   //a property with no policy is left alone
+   for(FaceIterator it(mesh); !it.done(); it.advance())
+      if(region[it.current()] != -1 && region[it.current()] != 0)
+         return false;
+   return region.updatePolicy() == 0;
+}
+
+bool test_bufferedPropertiesSwap() {
+   SimplicialComplex mesh;
+   VertexPropertyBuffered<double> x(mesh);
+   VertexPropertyBuffered<int,3> level(mesh);
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 10; ++i) {
+      verts.push_back(mesh.addVertex());
+      x.current(verts.back()) = i;
+      level.current(verts.back()) = i;
+   }
+
+   //a few steps: next from current, then swap without copying
+   for(int step = 0; step < 3; ++step) {
+      const double* nextBuffer = x.buffer(1);
+      for(int i = 0; i < 10; ++i) {
+         x.next(verts[i]) = x.current(verts[i]) + 1;
+         level.next(verts[i]) = level.current(verts[i]) + 10;
+      }
+      x.swapBuffers();
+      level.swapBuffers();
+      if(x.buffer(0) != nextBuffer)
+         return false;
+   }
+   if(x.current(verts[4]) != 7 || x.next(verts[4]) != 6 || x.previous(verts[4]) != 6)
+      return false;
+   if(level.current(verts[4]) != 34 || level.previous(verts[4]) != 24 || level.next(verts[4]) != 14)
+      return false;
+
+   //all buffers grow and renumber together
+   TetPropertyBuffered<int> tetState(mesh);
+   VertexHandle extra = mesh.addVertex();
+   x.current(extra) = 100;
+   x.next(extra) = 200;
+   level.previous(extra) = 300;
+   if(x.slots() != 11 || tetState.slots() != 0)
+      return false;
+   mesh.deleteVertex(verts[0]);
+   SimplexRemap remap = mesh.compact();
+   if(x.slots() != 10 || x.current(remap(extra)) != 100 || x.next(remap(extra)) != 200 || level.previous(remap(extra)) != 300 ||
+      x.current(remap(verts[9])) != 12)
+      return false;
+
+   //partial updates start from a copy
+   x.copyCurrentToNext();
+   x.next(remap(extra)) = -1;
+   x.swapBuffers();
+   return x.current(remap(verts[5])) == 8 && x.current(remap(extra)) == -1;
+}
+
+enum Material { Air, Water, Steel, Glass, Wood };
+
+bool test_compressedPropertiesRoundTrip() {
+   SimplicialComplex mesh;
+   VertexPropertyCompressed<HalfCodec> pressure(mesh);
+   VertexPropertyCompressed<QuantizedCodec<12>, 3> position(mesh, QuantizedCodec<12>(-2.0f, 2.0f));
+   VertexPropertyCompressed<BitCodec<bool,1> > pinned(mesh);
+   VertexPropertyCompressed<BitCodec<Material,3> > material(mesh);
+   std::vector<VertexHandle> verts;
+   for(int i = 0; i < 200; ++i) {
+      VertexHandle vh = mesh.addVertex();
+      verts.push_back(vh);
+      pressure.set(vh, 0.37f*i - 20.0f);
+      for(unsigned int c = 0; c < 3; ++c)
+         position.set(vh, c, std::sin(0.1f*i + c));
+      pinned.set(vh, i % 3 == 0);
+      material.set(vh, Material(i % 5));
+   }
+
+   //values come back within the codecs' precision, and neighbouring codes don't disturb each other
+   float step = 4.0f / 4095;
+   for(int i = 0; i < 200; ++i) {
+      float p = 0.37f*i - 20.0f;
+      if(std::fabs(pressure.get(verts[i]) - p) > std::fabs(p)/1024 || pinned.get(verts[i]) != (i % 3 == 0) || material.get(verts[i]) != Material(i % 5))
+         return false;
+      for(unsigned int c = 0; c < 3; ++c)
+         if(std::fabs(position.get(verts[i], c) - std::sin(0.1f*i + c)) > 0.5f*step*1.001f)
+            return false;
+   }
+   HalfCodec half;
+   if(half.decode(half.encode(65504.0f)) != 65504.0f || half.decode(half.encode(1e6f)) <= 65504.0f || half.decode(half.encode(1e-7f)) == 0 ||
+      half.decode(half.encode(-0.5f)) != -0.5f || half.encode(1.0f + 1.0f/2048) != half.encode(1.0f))
+      return false;
+   QuantizedCodec<12> q(-2.0f, 2.0f);
+   if(q.decode(q.encode(5.0f)) != 2.0f || q.decode(q.encode(-5.0f)) != -2.0f)
+      return false;
+
+   //bulk spans match single reads, and write back
+   std::vector<float> span(3*position.slots());
+   position.decode(0, position.slots(), &span[0]);
+   if(span[3*57 + 2] != position.get(verts[57], 2))
+      return false;
+   for(size_t i = 0; i < span.size(); ++i)
+      span[i] *= -1;
+   position.encode(0, position.slots(), &span[0]);
+   if(std::fabs(position.get(verts[57], 2) + std::sin(0.1f*57 + 2)) > step)
+      return false;
+
+   //resized and renumbered like any property, at the compressed size
+   mesh.deleteVertex(verts[0]);
+   SimplexRemap remap = mesh.compact();
+   if(pinned.get(remap(verts[3])) != true || material.get(remap(verts[199])) != Material(199 % 5) || pinned.slots() != 199)
+      return false;
+   VertexHandle extra = mesh.addVertex();
+   if(pinned.get(extra) || material.get(extra) != Air)
+      return false;
+
+   MemoryReport report;
+   mesh.memoryReport(report);
+   return report.properties.size() == 4 && report.properties[0].used == 200*2 && report.properties[1].used == (200*3*12 + 7)/8 &&
+          report.properties[2].used == (200 + 7)/8;
+}
+
+//The iterator visits exactly the expected simplices, in increasing order
+template <class Iterator, class Handle>
+bool visitsInOrder(Iterator& it, const std::set<Handle>& expected) {
+   typename std::set<Handle>::const_iterator e = expected.begin();
+   for(; !it.done(); it.advance(), ++e)
+      if(e == expected.end() || !(it.current() == *e))
+         return false;
+   return e == expected.end() && !it.current().isValid();
+}
+
+bool test_compositeIteratorsMatchSets() {
+   //a double cone: a hub vertex with more incident faces and tets than the iterators keep inline
+   const int n = 40;
+   SimplicialComplex mesh;
+   VertexHandle hub = mesh.addVertex(), top = mesh.addVertex(), bottom = mesh.addVertex();
+   std::vector<VertexHandle> ring;
+   std::vector<TetHandle> upper;
+   for(int i = 0; i < n; ++i)
+      ring.push_back(mesh.addVertex());
+   for(int i = 0; i < n; ++i) {
+      upper.push_back(mesh.addTet(hub, top, ring[i], ring[(i+1)%n]));
+      mesh.addTet(bottom, ring[(i+1)%n], hub, ring[i]);
+   }
+   //...with some holes, so slots aren't contiguous
+   for(int i = 0; i < n; i += 7)
+      mesh.deleteTet(upper[i], false);
+
+   //compare against gathering the simplices through the elementary iterators
+   for(VertexIterator vit(mesh); !vit.done(); vit.advance()) {
+      std::set<FaceHandle> faces;
+      std::set<TetHandle> tets;
+      for(VertexEdgeIterator veit(mesh, vit.current()); !veit.done(); veit.advance())
+         for(EdgeFaceIterator efit(mesh, veit.current()); !efit.done(); efit.advance()) {
+            faces.insert(efit.current());
+            for(FaceTetIterator ftit(mesh, efit.current()); !ftit.done(); ftit.advance())
+               tets.insert(ftit.current());
+         }
+      VertexFaceIterator vfit(mesh, vit.current());
+      VertexTetIterator vtit(mesh, vit.current());
+      if(!visitsInOrder(vfit, faces) || !visitsInOrder(vtit, tets))
+         return false;
+   }
+   for(EdgeIterator eit(mesh); !eit.done(); eit.advance()) {
+      std::set<TetHandle> tets;
+      for(EdgeFaceIterator efit(mesh, eit.current()); !efit.done(); efit.advance())
+         for(FaceTetIterator ftit(mesh, efit.current()); !ftit.done(); ftit.advance())
+            tets.insert(ftit.current());
+      EdgeTetIterator etit(mesh, eit.current());
+      if(!visitsInOrder(etit, tets))
+         return false;
+   }
+   for(TetIterator tit(mesh); !tit.done(); tit.advance()) {
+      std::set<VertexHandle> verts;
+      std::set<EdgeHandle> edges;
+      for(TetFaceIterator tfit(mesh, tit.current()); !tfit.done(); tfit.advance())
+         for(FaceEdgeIterator feit(mesh, tfit.current()); !feit.done(); feit.advance()) {
+            edges.insert(feit.current());
+            for(EdgeVertexIterator evit(mesh, feit.current()); !evit.done(); evit.advance())
+               verts.insert(evit.current());
+         }
+      TetVertexIterator tvit(mesh, tit.current());
+      TetEdgeIterator teit(mesh, tit.current());
+      if(verts.size() != 4 || edges.size() != 6 || !visitsInOrder(tvit, verts) || !visitsInOrder(teit, edges))
+         return false;
+   }
+
+   int hubTets = 0;
+   for(VertexTetIterator vtit(mesh, hub); !vtit.done(); vtit.advance())
+      ++hubTets;
+   return hubTets == 2*n - (n+6)/7;
+}
+
+//The range visits the same simplices as the iterator, in the same order, and indexes them consistently
+template <class Range, class Iterator>
+bool rangeMatches(const Range& range, Iterator& it) {
+   typename Range::const_iterator r = range.begin();
+   for(; !it.done(); it.advance(), ++r)
+      if(r == range.end() || !(*r == it.current()))
+         return false;
+   return r == range.end();
+}
+
+template <class Range>
+bool indexesConsistently(const Range& range) {
+   if((unsigned int)(range.end() - range.begin()) != range.size())
+      return false;
+   for(unsigned int k = 0; k < range.size(); ++k)
+      if(!(range.begin()[k] == range[k]) || !(*(range.end() - (range.size() - k)) == range[k]))
+         return false;
+   return true;
+}
+
+struct IsolatedVertex {
+   const SimplicialComplex& mesh;
+   explicit IsolatedVertex(const SimplicialComplex& m) : mesh(m) {}
+   bool operator()(const VertexHandle& vh) const { return mesh.vertexIncidentEdgeCount(vh) == 0; }
+};
+
+bool test_rangesMatchIterators() {
+   //a cube split into six tets, plus a dangling triangle and an isolated vertex, with a tet deleted
+   const int tets[6*4] = { 0,1,3,7,  5,1,0,7,  0,4,5,7,  7,6,4,0,  2,0,3,7,  0,2,6,7 };
+   const int tris[1*3] = { 1,8,9 };
+   const int segs[1*2] = { 9,10 };
+   SimplicialComplex mesh;
+   mesh.buildFromSimplices(tets, 6, tris, 1, segs, 1);
+   mesh.addVertex();
+   mesh.deleteTet(*++mesh.tets().begin(), false);
+
+   VertexIterator vit(mesh);
+   EdgeIterator eit(mesh);
+   FaceIterator fit(mesh);
+   TetIterator tit(mesh);
+   if(!rangeMatches(mesh.vertices(), vit) || !rangeMatches(mesh.edges(), eit) || !rangeMatches(mesh.faces(), fit) || !rangeMatches(mesh.tets(), tit))
+      return false;
+
+   for(auto vh : mesh.vertices()) {
+      VertexEdgeIterator veit(mesh, vh);
+      VertexVertexIterator vvit(mesh, vh);
+      VertexFaceIterator vfit(mesh, vh);
+      VertexTetIterator vtit(mesh, vh);
+      if(!rangeMatches(mesh.vertexEdges(vh), veit) || !rangeMatches(mesh.vertexVertices(vh), vvit) ||
+         !rangeMatches(mesh.vertexFaces(vh), vfit) || !rangeMatches(mesh.vertexTets(vh), vtit) ||
+         !indexesConsistently(mesh.vertexEdges(vh)) || !indexesConsistently(mesh.vertexTets(vh)))
+         return false;
+   }
+   for(auto eh : mesh.edges()) {
+      EdgeVertexIterator evit(mesh, eh);
+      EdgeFaceIterator efit(mesh, eh);
+      EdgeTetIterator etit(mesh, eh);
+      if(!rangeMatches(mesh.edgeVertices(eh), evit) || !rangeMatches(mesh.edgeFaces(eh), efit) || !rangeMatches(mesh.edgeTets(eh), etit))
+         return false;
+   }
+   for(auto fh : mesh.faces()) {
+      FaceEdgeIterator feit(mesh, fh);
+      FaceTetIterator ftit(mesh, fh);
+      FaceVertexIterator fvit(mesh, fh), orderedFvit(mesh, fh, true);
+      if(!rangeMatches(mesh.faceEdges(fh), feit) || !rangeMatches(mesh.faceTets(fh), ftit) ||
+         !rangeMatches(mesh.faceVertices(fh), fvit) || !rangeMatches(mesh.faceVertices(fh, true), orderedFvit))
+         return false;
+   }
+   for(auto th : mesh.tets()) {
+      TetFaceIterator tfit(mesh, th);
+      TetVertexIterator tvit(mesh, th);
+      TetEdgeIterator teit(mesh, th);
+      if(!rangeMatches(mesh.tetFaces(th), tfit) || !rangeMatches(mesh.tetVertices(th), tvit) || !rangeMatches(mesh.tetEdges(th), teit) ||
+         !indexesConsistently(mesh.tetFaces(th)) || !indexesConsistently(mesh.tetEdges(th)))
+         return false;
+   }
+
+   //the standard algorithms work on them, random access ones included
+   AdjacencyRange<VertexEdgeRows> spokes = mesh.vertexEdges(mesh.vertices().handles()[7]);
+   std::vector<EdgeHandle> sorted(spokes.begin(), spokes.end());
+   std::sort(sorted.begin(), sorted.end());
+   std::vector<TetHandle> live = mesh.tets().handles();
+   return (int)std::distance(mesh.faces().begin(), mesh.faces().end()) == mesh.numFaces() && (int)live.size() == mesh.numTets() &&
+          std::binary_search(sorted.begin(), sorted.end(), spokes[spokes.size()-1]) &&
+          std::count_if(mesh.vertices().begin(), mesh.vertices().end(), IsolatedVertex(mesh)) == 1;
+}
+
+//A block of nx*ny*nz unit cubes, six tets each, as vertex indices for buildFromTets.
+std::vector<int> cubeTets(int nx, int ny, int nz) {
+   const int cube[6*4] = { 0,1,3,7,  5,1,0,7,  0,4,5,7,  7,6,4,0,  2,0,3,7,  0,2,6,7 };
+   std::vector<int> tets;
+   for(int i = 0; i < nx; ++i) for(int j = 0; j < ny; ++j) for(int k = 0; k < nz; ++k) {
+      for(int c = 0; c < 6*4; ++c) {
+         int corner = cube[c];
+         tets.push_back(((i + ((corner>>2)&1))*(ny+1) + (j + ((corner>>1)&1)))*(nz+1) + k + (corner&1));
+      }
+   }
+   return tets;
+}
+
+//b is an even permutation of a (both listing the same four vertices)
+bool evenPermutation(const VertexHandle a[4], const VertexHandle b[4]) {
+   int pos[4];
+   for(int i = 0; i < 4; ++i)
+      pos[i] = (int)(std::find(a, a+4, b[i]) - a);
+   int inversions = 0;
+   for(int i = 0; i < 4; ++i)
+      for(int j = i+1; j < 4; ++j)
+         if(pos[i] > pos[j]) ++inversions;
+   return inversions % 2 == 0;
+}
+
+bool test_orientedGathers() {
+   //separate tets and triangles, created with every ordering of their vertices, keep that orientation
+   int order[4] = { 0,1,2,3 };
+   do {
+      SimplicialComplex single;
+      VertexHandle v[4], given[4], tetVerts[4];
+      for(int i = 0; i < 4; ++i)
+         v[i] = single.addVertex();
+      for(int i = 0; i < 4; ++i)
+         given[i] = v[order[i]];
+      single.getTetVertices(single.addTet(given[0], given[1], given[2], given[3]), tetVerts);
+      if(!evenPermutation(given, tetVerts) || !(tetVerts[0] == v[0]) || !(tetVerts[1] < tetVerts[2] && tetVerts[1] < tetVerts[3]))
+         return false;
+   } while(std::next_permutation(order, order+4));
+   do {
+      SimplicialComplex triangle;
+      VertexHandle v[3], triVerts[3];
+      for(int i = 0; i < 3; ++i)
+         v[i] = triangle.addVertex();
+      triangle.getFaceVertices(triangle.addFace(v[order[0]], v[order[1]], v[order[2]]), triVerts);
+      int start = (int)(std::find(order, order+3, 0) - order);
+      for(int i = 0; i < 3; ++i)
+         if(!(triVerts[i] == v[order[(start+i)%3]]))
+            return false;
+   } while(std::next_permutation(order, order+3));
+
+   //on a grid, the gathers survive renumbering up to an even permutation, and the edges join the right vertices
+   std::vector<int> grid = cubeTets(3, 3, 1);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&grid[0], grid.size()/4);
+   std::vector<TetHandle> tets = mesh.tets().handles();
+   std::vector< std::vector<VertexHandle> > before;
+   for(size_t t = 0; t < tets.size(); ++t) {
+      VertexHandle verts[4];
+      EdgeHandle edges[6];
+      mesh.getTetVertices(tets[t], verts);
+      mesh.getTetEdges(tets[t], edges);
+      const int pairs[6][2] = { {0,1}, {0,2}, {0,3}, {1,2}, {1,3}, {2,3} };
+      for(int e = 0; e < 6; ++e)
+         if(!(mesh.getEdge(verts[pairs[e][0]], verts[pairs[e][1]]) == edges[e]))
+            return false;
+      before.push_back(std::vector<VertexHandle>(verts, verts+4));
+   }
+   SimplexRemap remap = mesh.reorderRCM();
+   for(size_t t = 0; t < tets.size(); ++t) {
+      VertexHandle moved[4], verts[4];
+      for(int i = 0; i < 4; ++i)
+         moved[i] = remap(before[t][i]);
+      mesh.getTetVertices(remap(tets[t]), verts);
+      if(!evenPermutation(moved, verts))
+         return false;
+   }
+
+   //batched gathers match the single ones
+   tets = mesh.tets().handles();
+   std::vector<FaceHandle> faces = mesh.faces().handles();
+   std::vector<int> tetVerts(4*tets.size()), tetEdges(6*tets.size()), faceVerts(3*faces.size());
+   mesh.getTetVertices(&tets[0], tets.size(), &tetVerts[0]);
+   mesh.getTetEdges(&tets[0], tets.size(), &tetEdges[0]);
+   mesh.getFaceVertices(&faces[0], faces.size(), &faceVerts[0]);
+   std::vector<VertexHandle> allVerts = mesh.vertices().handles();
+   std::vector<EdgeHandle> allEdges = mesh.edges().handles();
+   for(size_t t = 0; t < tets.size(); ++t) {
+      VertexHandle verts[4];
+      EdgeHandle edges[6];
+      mesh.getTetVertices(tets[t], verts);
+      mesh.getTetEdges(tets[t], edges);
+      for(int i = 0; i < 4; ++i)
+         if(!(allVerts[tetVerts[4*t+i]] == verts[i]))
+            return false;
+      for(int i = 0; i < 6; ++i)
+         if(!(allEdges[tetEdges[6*t+i]] == edges[i]))
+            return false;
+   }
+   for(size_t f = 0; f < faces.size(); ++f) {
+      VertexHandle verts[3];
+      mesh.getFaceVertices(faces[f], verts);
+      for(int i = 0; i < 3; ++i)
+         if(!(allVerts[faceVerts[3*f+i]] == verts[i]))
+            return false;
+   }
+   return true;
+}
+
+//Every cached row matches the relation gathered through the uncached iterators
+bool adjacencyCachesMatch(const SimplicialComplex& mesh) {
+   for(VertexIterator vit(mesh); !vit.done(); vit.advance()) {
+      std::set<TetHandle> tets;
+      std::set<VertexHandle> verts;
+      for(VertexTetIterator vtit(mesh, vit.current()); !vtit.done(); vtit.advance())
+         tets.insert(vtit.current());
+      for(VertexVertexIterator vvit(mesh, vit.current()); !vvit.done(); vvit.advance())
+         verts.insert(vvit.current());
+      CachedVertexTetIterator cvtit(mesh, vit.current());
+      CachedVertexVertexIterator cvvit(mesh, vit.current());
+      if(!visitsInOrder(cvtit, tets) || !visitsInOrder(cvvit, verts))
+         return false;
+   }
+   for(EdgeIterator eit(mesh); !eit.done(); eit.advance()) {
+      std::set<TetHandle> tets;
+      for(EdgeTetIterator etit(mesh, eit.current()); !etit.done(); etit.advance())
+         tets.insert(etit.current());
+      CachedEdgeTetIterator cetit(mesh, eit.current());
+      if(!visitsInOrder(cetit, tets))
+         return false;
+   }
+   for(TetIterator tit(mesh); !tit.done(); tit.advance()) {
+      std::set<TetHandle> tets;
+      for(TetFaceIterator tfit(mesh, tit.current()); !tfit.done(); tfit.advance())
+         for(FaceTetIterator ftit(mesh, tfit.current()); !ftit.done(); ftit.advance())
+            if(!(ftit.current() == tit.current()))
+               tets.insert(ftit.current());
+      TetTetIterator ttit(mesh, tit.current());
+      if(!visitsInOrder(ttit, tets))
+         return false;
+   }
+   return true;
+}
+
+bool test_adjacencyCachesFollowEdits() {
+   //a 4x4x4 block of cubes, 6 tets each
+   std::vector<int> grid = cubeTets(4, 4, 4);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&grid[0], grid.size()/4);
+   if(!adjacencyCachesMatch(mesh))
+      return false;
+
+   //a few edits are patched row by row: delete a tet, and hang a new one (with a new vertex) off the boundary
+   std::vector<TetHandle> tets = mesh.tets().handles();
+   mesh.deleteTet(tets[100], false);
+   VertexHandle corner[3] = { VertexHandle(), VertexHandle(), VertexHandle() };
+   FaceHandle boundary;
+   for(FaceIterator fit(mesh); !fit.done() && !boundary.isValid(); fit.advance()) {
+      int count = 0;
+      for(FaceTetIterator ftit(mesh, fit.current()); !ftit.done(); ftit.advance())
+         ++count;
+      if(count == 1)
+         boundary = fit.current();
+   }
+   mesh.getFaceVertices(boundary, corner);
+   TetHandle hung = mesh.addTet(corner[0], corner[1], corner[2], mesh.addVertex());
+   if(!adjacencyCachesMatch(mesh))
+      return false;
+
+   //many edits go past the point where the caches are rebuilt
+   for(size_t t = 0; t < tets.size(); t += 3)
+      mesh.deleteTet(tets[t], true);
+   if(!mesh.deleteTet(hung, false) || !adjacencyCachesMatch(mesh))
+      return false;
+
+   //renumbering starts over, and building ahead of time gives the same answers
+   mesh.compact();
+   if(!adjacencyCachesMatch(mesh))
+      return false;
+   mesh.updateAdjacencyCaches();
+   mesh.deleteTet(mesh.tets().handles()[0], false);
+   if(!adjacencyCachesMatch(mesh))
+      return false;
+
+   //edge collapses relabel a vertex's edges in place (the fan is wide enough that the rows are patched)
+   SimplicialComplex fan;
+   const int spokes = 64;
+   VertexHandle center = fan.addVertex();
+   VertexHandle ring[spokes];
+   for(int i = 0; i < spokes; ++i)
+      ring[i] = fan.addVertex();
+   for(int i = 0; i < spokes; ++i)
+      fan.addFace(center, ring[i], ring[(i+1)%spokes]);
+   VertexHandle dangling = fan.addVertex();
+   fan.addEdge(ring[0], dangling);
+   if(!adjacencyCachesMatch(fan))
+      return false;
+   fan.collapseEdge(fan.getEdge(center, ring[0]), ring[0]);
+   return adjacencyCachesMatch(fan);
+}
+
+//nth and rankOf agree with the live handles in slot order
+template<class Handle, class Range>
+bool ranksMatch(const SimplicialComplex& mesh, const Range& range, Handle (SimplicialComplex::*nth)(unsigned int) const) {
+   std::vector<Handle> handles = range.handles();
+   for(unsigned int k = 0; k < handles.size(); ++k)
+      if(!((mesh.*nth)(k) == handles[k]) || mesh.rankOf(handles[k]) != k)
+         return false;
+   return !(mesh.*nth)((unsigned int)handles.size()).isValid();
+}
+
+bool test_occupancyRankSelect() {
+   //a long strip of tets, so the bitmaps span many words and select samples
+   const int n = 1500;
+   SimplicialComplex mesh;
+   std::vector<VertexHandle> verts;
+   std::vector<TetHandle> tets;
+   for(int i = 0; i < n+3; ++i)
+      verts.push_back(mesh.addVertex());
+   for(int i = 0; i < n; ++i)
+      tets.push_back(mesh.addTet(verts[i], verts[i+1], verts[i+2], verts[i+3]));
+
+   //carve out dead runs longer than a word, scattered singles, and everything past a point
+   for(int i = 100; i < 400; ++i)
+      mesh.deleteTet(tets[i], false);
+   for(int i = 500; i < n; i += 3)
+      mesh.deleteTet(tets[i], false);
+   for(int i = 1400; i < n; ++i)
+      mesh.deleteTet(tets[i], false);
+   mesh.deleteVertex(verts[0]);
+
+   //the global iterators skip exactly the dead slots
+   int live = 0;
+   TetIterator tit(mesh);
+   for(int i = 0; i < n; ++i) {
+      if(!mesh.tetExists(tets[i]))
+         continue;
+      if(tit.done() || !(tit.current() == tets[i]))
+         return false;
+      tit.advance();
+      ++live;
+   }
+   if(!tit.done() || live != mesh.numTets())
+      return false;
+
+   if(!ranksMatch(mesh, mesh.vertices(), &SimplicialComplex::nthVertex) || !ranksMatch(mesh, mesh.edges(), &SimplicialComplex::nthEdge) ||
+      !ranksMatch(mesh, mesh.faces(), &SimplicialComplex::nthFace) || !ranksMatch(mesh, mesh.tets(), &SimplicialComplex::nthTet))
+      return false;
+
+   //edits after a query are seen by the next one (the new tet reuses the last slot freed, past all the live ones)
+   TetHandle refill = mesh.addTet(verts[200], verts[201], verts[202], verts[203]);
+   unsigned int last = mesh.numTets() - 1;
+   if(mesh.rankOf(refill) != last || !(mesh.nthTet(last) == refill) || !ranksMatch(mesh, mesh.tets(), &SimplicialComplex::nthTet))
+      return false;
+   mesh.deleteTet(tets[50], false);
+   if(!ranksMatch(mesh, mesh.tets(), &SimplicialComplex::nthTet))
+      return false;
+
+   //and after renumbering
+   mesh.compact();
+   return ranksMatch(mesh, mesh.tets(), &SimplicialComplex::nthTet) && ranksMatch(mesh, mesh.edges(), &SimplicialComplex::nthEdge);
+}
+
+//Loop bodies for the parallel loops
+struct CountVisit {
+   TetProperty<int>& visits;
+   CountVisit(TetProperty<int>& v) : visits(v) {}
+   void operator()(const TetHandle& th) const { ++visits[th]; }
+};
+
+struct CountInto {
+   template<class Handle>
+   void operator()(const Handle&, int& count) const { ++count; }
+};
+
+struct TetValue {
+   const TetProperty<double>& values;
+   TetValue(const TetProperty<double>& v) : values(v) {}
+   double operator()(const TetHandle& th) const { return values[th]; }
+};
+
+struct Add {
+   template<class T>
+   T operator()(const T& a, const T& b) const { return a + b; }
+};
+
+bool test_parallelForEachVisitsLiveOnce() {
+   //a block of tets with its dead slots in clusters, as after local coarsening
+   std::vector<int> grid = cubeTets(6, 6, 6);
+   SimplicialComplex mesh;
+   mesh.buildFromTets(&grid[0], grid.size()/4);
+   std::vector<TetHandle> tets = mesh.tets().handles();
+   for(size_t t = 0; t < tets.size(); ++t)
+      if(t % 200 < 150)
+         mesh.deleteTet(tets[t], false);
+
+   TetProperty<double> value(mesh);
+   double serial = 0;
+   int i = 0;
+   for(auto th : mesh.tets())
+      serial += (value[th] = 1.0 / ++i);
+
+   //every live tet exactly once, with small chunks so that workers run dry and steal
+   const unsigned int threads[4] = { 1, 2, 3, 8 };
+   double reduced[4];
+   for(int c = 0; c < 4; ++c) {
+      TetProperty<int> visits(mesh);
+      parallelForEach<TetHandle>(mesh, CountVisit(visits), threads[c], 4);
+      for(size_t t = 0; t < tets.size(); ++t)
+         if(visits[tets[t]] != (mesh.tetExists(tets[t]) ? 1 : 0))
+            return false;
+
+      PerThread<int> edges(threads[c]), verts(threads[c]);
+      parallelForEachEdge(mesh, CountInto(), edges);
+      parallelForEachVertex(mesh, CountInto(), verts);
+      if(edges.combine(0, Add()) != mesh.numEdges() || verts.combine(0, Add()) != mesh.numVerts())
+         return false;
+
+      reduced[c] = parallelReduce<TetHandle>(mesh, TetValue(value), Add(), 0.0, threads[c], 16);
+
+      //init is added once, not once per chunk
+      if(std::fabs(parallelReduce<TetHandle>(mesh, TetValue(value), Add(), 5.0, threads[c], 16) - (5.0 + reduced[c])) > 1e-12)
+         return false;
+   }
+
+   //the reduction is the same to the bit for every thread count, and agrees with the serial sum
+   for(int c = 1; c < 4; ++c)
+      if(reduced[c] != reduced[0])
+         return false;
+   return std::fabs(reduced[0] - serial) < 1e-12 * serial;
+}